@@ -0,0 +1,137 @@
+/**
+* @file Aabb.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda las cajas envolventes alineadas con los ejes y los rayos con los que se consultan las BVH
+**/
+
+#ifndef AABB_HEADER
+#define AABB_HEADER
+
+    #include <limits>
+    #include <utility>
+    #include "math.hpp"
+
+    namespace Engine
+    {
+
+        ///Rayo origin + t * direction. La dirección no se normaliza, de forma que al pasar el rayo a otro espacio con
+        ///una matriz afín el parámetro t de un punto sigue siendo el mismo y se pueden comparar distancias entre modelos.
+        struct Ray
+        {
+            Vector3f origin;
+            Vector3f direction;
+
+            Ray transformed (const Matrix44 & matrix) const
+            {
+                return { Vector3f(matrix * Vector4f(origin, 1.f)), Vector3f(matrix * Vector4f(direction, 0.f)) };
+            }
+        };
+
+        struct Aabb
+        {
+            Vector3f min_corner;
+            Vector3f max_corner;
+
+            ///Caja vacía: al añadirle cualquier punto pasa a contener solo ese punto
+            Aabb()
+            :
+                min_corner( std::numeric_limits< float >::max ()),
+                max_corner(-std::numeric_limits< float >::max ())
+            {
+            }
+
+            Aabb(const Vector3f & min_corner, const Vector3f & max_corner) : min_corner(min_corner), max_corner(max_corner)
+            {
+            }
+
+            bool empty () const
+            {
+                return min_corner.x > max_corner.x;
+            }
+
+            void grow (const Vector3f & point)
+            {
+                min_corner = glm::min (min_corner, point);
+                max_corner = glm::max (max_corner, point);
+            }
+
+            void grow (const Aabb & other)
+            {
+                min_corner = glm::min (min_corner, other.min_corner);
+                max_corner = glm::max (max_corner, other.max_corner);
+            }
+
+            Vector3f center () const
+            {
+                return (min_corner + max_corner) * 0.5f;
+            }
+
+            float surface_area () const
+            {
+                if (empty ()) return 0.f;
+
+                Vector3f size = max_corner - min_corner;
+
+                return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+            }
+
+            bool operator == (const Aabb & other) const
+            {
+                return min_corner == other.min_corner && max_corner == other.max_corner;
+            }
+
+            ///Caja que envuelve a esta después de transformarla (Arvo: se suma cada columna por el lado que la hace mayor)
+            Aabb transformed (const Matrix44 & matrix) const
+            {
+                if (empty ()) return *this;
+
+                Vector3f translation = Vector3f(matrix[3]);
+                Aabb     result(translation, translation);
+
+                for (int column = 0; column < 3; ++column)
+                {
+                    Vector3f axis = Vector3f(matrix[column]);
+                    Vector3f a    = axis * min_corner[column];
+                    Vector3f b    = axis * max_corner[column];
+
+                    result.min_corner += glm::min (a, b);
+                    result.max_corner += glm::max (a, b);
+                }
+
+                return result;
+            }
+
+            ///Devuelve true si el rayo entra en la caja antes de max_distance, y en distance el punto de entrada
+            bool intersects_ray (const Ray & ray, const Vector3f & inverse_direction, float max_distance, float & distance) const
+            {
+                float t_min = 0.f;
+                float t_max = max_distance;
+
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    float t0 = (min_corner[axis] - ray.origin[axis]) * inverse_direction[axis];
+                    float t1 = (max_corner[axis] - ray.origin[axis]) * inverse_direction[axis];
+
+                    if (t0 > t1) std::swap (t0, t1);
+
+                    //Si el rayo es paralelo al eje y sale 0 * infinito (NaN), las comparaciones no recortan el intervalo
+                    t_min = t0 > t_min ? t0 : t_min;
+                    t_max = t1 < t_max ? t1 : t_max;
+
+                    if (t_min > t_max) return false;
+                }
+
+                distance = t_min;
+
+                return true;
+            }
+        };
+
+    }
+
+#endif
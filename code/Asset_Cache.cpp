@@ -0,0 +1,136 @@
+/**
+* @file Asset_Cache.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda los modelos ya cargados para que varias escenas (y varios hilos) los usen sin volver a importarlos
+**/
+
+#include "Asset_Cache.hpp"
+#include "View.hpp"
+#include "Memory_Tracker.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace Engine
+{
+    Asset_Cache::Asset_Cache()
+    {
+    }
+
+    Asset_Cache::~Asset_Cache()
+    {
+    }
+
+    ///Crea un modelo de la escena dada. Devuelve nullptr si el archivo no se puede cargar.
+    Model * Asset_Cache::instantiate (const Model_Description & description, View * view)
+    {
+        std::shared_ptr< Entry > entry;
+
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            std::shared_ptr< Entry > & slot = entries[description.path];
+
+            if (!slot)
+            {
+                slot = std::make_shared< Entry > ();
+                slot->path = description.path;
+            }
+
+            entry = slot;
+        }
+
+        entry->last_use = ++uses;
+
+        char * path = const_cast< char * >(entry->path.c_str ());
+
+        // Solo se bloquea la entrada, por lo que varios modelos distintos se pueden importar a la vez:
+
+        std::lock_guard< std::mutex > lock(entry->mutex);
+
+        if (entry->prototype || entry->streamed)
+        {
+            hits++;
+        }
+        else
+        {
+            misses++;
+
+            std::unique_ptr< Model > prototype(new Model(path, nullptr, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 0.f, true));
+
+            //Si no se ha podido leer nada no se guarda, y se volverá a intentar la próxima vez
+            if (prototype->meshlets.empty ()) return nullptr;
+
+            //De los modelos que se leen por partes no se guarda nada más que eso: el .mesh ya queda generado y abrirlo
+            //solo lee la tabla de meshlets
+            if (prototype->stream)
+                entry->streamed = true;
+            else
+                entry->prototype = std::move (prototype);
+        }
+
+        Model * model = entry->streamed
+            ? new Model(path,              view, description.red, description.green, description.blue, description.scale, description.x, description.y, description.z, description.rotation_x, description.rotation_y, description.active)
+            : new Model(*entry->prototype, view, description.red, description.green, description.blue, description.scale, description.x, description.y, description.z, description.rotation_x, description.rotation_y, description.active);
+
+        model->light_channels = description.light_channels;
+
+        if (Memory_Tracker::instance ().over_budget (Memory_Tracker::GEOMETRY))
+        {
+            evict (entry.get ());
+        }
+
+        return model;
+    }
+
+    ///Olvida prototipos, empezando por los que hace más tiempo que no se usan, hasta que la geometría vuelve a caber en su límite
+    void Asset_Cache::evict (const Entry * keep)
+    {
+        //Se ordena por una copia de last_use, que otros hilos pueden cambiar mientras tanto
+        std::vector< std::pair< uint64_t, std::shared_ptr< Entry > > > candidates;
+
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            for (auto & pair : entries)
+            {
+                if (pair.second.get () != keep) candidates.emplace_back (pair.second->last_use.load (), pair.second);
+            }
+        }
+
+        std::sort
+        (
+            candidates.begin (), candidates.end (),
+            [] (const auto & a, const auto & b) { return a.first < b.first; }
+        );
+
+        Memory_Tracker & tracker = Memory_Tracker::instance ();
+
+        for (auto & pair : candidates)
+        {
+            Entry * candidate = pair.second.get ();
+
+            if (!tracker.over_budget (Memory_Tracker::GEOMETRY)) break;
+
+            //La entrada que otro hilo está importando o copiando se salta, en lugar de esperarla con keep bloqueada
+            std::unique_lock< std::mutex > lock(candidate->mutex, std::try_to_lock);
+
+            if (!lock.owns_lock () || !candidate->prototype) continue;
+
+            candidate->prototype.reset ();
+
+            evictions++;
+        }
+    }
+
+    size_t Asset_Cache::size ()
+    {
+        std::lock_guard< std::mutex > lock(mutex);
+
+        return entries.size ();
+    }
+}
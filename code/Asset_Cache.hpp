@@ -0,0 +1,78 @@
+/**
+* @file Asset_Cache.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda los modelos ya cargados para que varias escenas (y varios hilos) los usen sin volver a importarlos
+**/
+
+#ifndef ASSET_CACHE_HEADER
+#define ASSET_CACHE_HEADER
+
+    #include <atomic>
+    #include <cstdint>
+    #include <map>
+    #include <memory>
+    #include <mutex>
+    #include <string>
+    #include "Scene_Description.hpp"
+
+    namespace Engine
+    {
+
+        class Model;
+        class View;
+
+        ///Cada ruta se importa una sola vez, aunque la pidan varios hilos a la vez, y se guarda como prototipo. Las
+        ///escenas crean sus modelos copiando la geometría del prototipo. Los modelos que se leen por partes no se
+        ///pueden compartir, así que de ellos solo se aprovecha que el .mesh ya está generado.
+        ///Si la geometría pasa del límite del Memory_Tracker se olvidan los prototipos que hace más tiempo que no se
+        ///usan. Los modelos ya creados tienen su propia copia, así que solo se pierde no tener que volver a importarlos.
+        class Asset_Cache
+        {
+            struct Entry
+            {
+                std::mutex               mutex;
+                std::string              path;                  ///< Model solo guarda el puntero a su ruta
+                std::unique_ptr< Model > prototype;
+                bool                     streamed = false;      ///< Se lee por partes y no tiene prototipo
+                std::atomic< uint64_t >  last_use { 0 };        ///< Valor de uses la última vez que se pidió
+            };
+
+            std::mutex                                        mutex;
+            std::map< std::string, std::shared_ptr< Entry > > entries;
+
+            std::atomic< uint64_t > hits     { 0 };
+            std::atomic< uint64_t > misses   { 0 };
+            std::atomic< uint64_t > evictions{ 0 };
+            std::atomic< uint64_t > uses     { 0 };
+
+        public:
+
+            Asset_Cache();
+           ~Asset_Cache();
+
+            Asset_Cache(const Asset_Cache &) = delete;
+            Asset_Cache & operator = (const Asset_Cache &) = delete;
+
+            ///Crea un modelo de la escena dada. Devuelve nullptr si el archivo no se puede cargar.
+            Model * instantiate (const Model_Description &, View *);
+
+            uint64_t get_hits      () const { return hits;      }
+            uint64_t get_misses    () const { return misses;    }
+            uint64_t get_evictions () const { return evictions; }
+            size_t   size          ();
+
+        private:
+
+            ///Olvida prototipos, empezando por los que hace más tiempo que no se usan, hasta que la geometría vuelve
+            ///a caber en su límite. No toca el de keep ni los que otro hilo está usando.
+            void evict (const Entry * keep);
+        };
+
+    }
+
+#endif
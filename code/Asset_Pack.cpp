@@ -0,0 +1,381 @@
+/**
+* @file Asset_Pack.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda los paquetes de assets: muchas mallas ya preparadas para el motor en un solo archivo, cada una
+* comprimida por separado con LZ4 en bloques que se descomprimen en paralelo directamente en los buffers del modelo
+**/
+
+#include "Asset_Pack.hpp"
+#include "Lz4.hpp"
+#include "Parallel.hpp"
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+
+namespace Engine
+{
+    namespace fs = std::filesystem;
+
+    namespace
+    {
+        const char     pack_magic[4] = { 'M', 'L', 'P', '1' };
+        const uint32_t pack_version  = 1;
+
+        static_assert (std::is_trivially_copyable< Meshlet >::value, "Los meshlets se guardan en el paquete tal y como están en memoria");
+
+        ///Paquetes montados, en el orden en el que se montaron
+        std::vector< std::unique_ptr< Asset_Pack > > & mounted_packs ()
+        {
+            static std::vector< std::unique_ptr< Asset_Pack > > packs;
+
+            return packs;
+        }
+
+        ///Ruta absoluta y normalizada, para comparar las de los modelos con la carpeta del paquete
+        fs::path absolute_path (const std::string & path)
+        {
+            std::error_code error;
+
+            fs::path absolute = fs::absolute (path, error);
+
+            return (error ? fs::path(path) : absolute).lexically_normal ();
+        }
+    }
+
+    uint64_t Compressed_Asset::raw_bytes () const
+    {
+        uint64_t total = 0;
+
+        for (const Asset_Pack_Section & section : entry.sections) total += section.raw_size;
+
+        return total;
+    }
+
+    uint64_t Compressed_Asset::compressed_bytes () const
+    {
+        uint64_t total = 0;
+
+        for (const std::vector< uint8_t > & block : blocks) total += block.size ();
+
+        return total;
+    }
+
+    ///Comprime las secciones de una malla. Se puede llamar a la vez desde varios hilos.
+    Compressed_Asset compress_asset (const Packed_Mesh & mesh)
+    {
+        Compressed_Asset asset;
+        Asset_Pack_Entry & entry = asset.entry;
+
+        std::memset (&entry, 0, sizeof(entry));
+
+        entry.meshlet_count = uint32_t(mesh.meshlets.size ());
+        entry.vertex_count  = mesh.vertices.size ();
+        entry.index_count   = mesh.indices .size ();
+        entry.index_size    = mesh.indices.is_narrow () ? sizeof(uint16_t) : sizeof(uint32_t);
+
+        std::memcpy (entry.bounding_sphere, &mesh.bounding_sphere.x, sizeof(entry.bounding_sphere));
+        std::memcpy (entry.min_corner,      &mesh.min_corner.x,      sizeof(entry.min_corner     ));
+        std::memcpy (entry.max_corner,      &mesh.max_corner.x,      sizeof(entry.max_corner     ));
+
+        const void * index_data = nullptr;
+
+        mesh.indices.visit ([&] (const auto * data) { index_data = data; });
+
+        const void * data [Asset_Pack_Entry::SECTION_COUNT] = { mesh.vertices.data (), mesh.normals.data (), index_data, mesh.meshlets.data () };
+        uint64_t     sizes[Asset_Pack_Entry::SECTION_COUNT] =
+        {
+            mesh.vertices.size () * sizeof(Point4f),
+            mesh.normals .size () * sizeof(Point4f),
+            mesh.indices .data_bytes (),
+            mesh.meshlets.size () * sizeof(Meshlet)
+        };
+
+        // Cada sección se parte en bloques que se comprimen por separado. Los que no se reducen se guardan sin comprimir:
+
+        for (int section = 0; section < Asset_Pack_Entry::SECTION_COUNT; ++section)
+        {
+            const uint8_t * bytes = static_cast< const uint8_t * >(data[section]);
+
+            entry.sections[section].raw_size    = sizes[section];
+            entry.sections[section].first_block = uint32_t(asset.blocks.size ());
+
+            for (uint64_t offset = 0; offset < sizes[section]; offset += Asset_Pack::block_size)
+            {
+                uint32_t raw_size = uint32_t(std::min< uint64_t > (Asset_Pack::block_size, sizes[section] - offset));
+
+                std::vector< uint8_t > block(lz4_compress_bound (raw_size));
+
+                size_t compressed_size = lz4_compress (bytes + offset, raw_size, block.data ());
+
+                if (compressed_size < raw_size)
+                    block.resize (compressed_size);
+                else
+                    block.assign (bytes + offset, bytes + offset + raw_size);
+
+                asset.blocks   .push_back (std::move (block));
+                asset.raw_sizes.push_back (raw_size);
+            }
+
+            entry.sections[section].block_count = uint32_t(asset.blocks.size ()) - entry.sections[section].first_block;
+        }
+
+        return asset;
+    }
+
+    Asset_Pack_Writer::Asset_Pack_Writer() : file(nullptr)
+    {
+    }
+
+    Asset_Pack_Writer::~Asset_Pack_Writer()
+    {
+        if (file) std::fclose (file);
+    }
+
+    bool Asset_Pack_Writer::open (const std::string & path)
+    {
+        file = std::fopen (path.c_str (), "wb");
+
+        if (!file) return false;
+
+        std::memset (&header, 0, sizeof(header));
+        std::memcpy (header.magic, pack_magic, sizeof(pack_magic));
+        header.version    = pack_version;
+        header.block_size = Asset_Pack::block_size;
+
+        entries.clear ();
+        blocks .clear ();
+        names  .clear ();
+
+        // La cabecera definitiva se escribe al cerrar. Mientras tanto se reserva su espacio, y las posiciones del
+        // archivo se cuentan aquí para no depender de ftell con archivos de más de 2 GB:
+
+        header.table_offset = sizeof(header);
+
+        return std::fwrite (&header, sizeof(header), 1, file) == 1;
+    }
+
+    ///Añade un asset con el nombre por el que se buscará
+    bool Asset_Pack_Writer::add (const std::string & name, const Compressed_Asset & asset)
+    {
+        if (!file) return false;
+
+        Asset_Pack_Entry entry = asset.entry;
+
+        entry.name_offset = names.size ();
+        entry.name_length = uint32_t(name.size ());
+
+        uint32_t first_block = uint32_t(blocks.size ());
+
+        for (Asset_Pack_Section & section : entry.sections) section.first_block += first_block;
+
+        for (size_t index = 0; index < asset.blocks.size (); ++index)
+        {
+            const std::vector< uint8_t > & block = asset.blocks[index];
+
+            if (!block.empty () && std::fwrite (block.data (), block.size (), 1, file) != 1) return false;
+
+            blocks.push_back ({ header.table_offset, uint32_t(block.size ()), asset.raw_sizes[index] });
+
+            header.table_offset += block.size ();
+        }
+
+        names  .append    (name);
+        entries.push_back (entry);
+
+        return true;
+    }
+
+    ///Escribe las tablas y la cabecera definitiva
+    bool Asset_Pack_Writer::close ()
+    {
+        if (!file) return false;
+
+        // Las tablas empiezan alineadas a 8 bytes:
+
+        uint64_t padding = (8 - header.table_offset % 8) % 8;
+        uint64_t zero    = 0;
+
+        bool ok = padding == 0 || std::fwrite (&zero, size_t(padding), 1, file) == 1;
+
+        header.table_offset += padding;
+        header.asset_count   = uint32_t(entries.size ());
+        header.block_count   = blocks.size ();
+        header.names_size    = names .size ();
+
+        ok = ok && (entries.empty () || std::fwrite (entries.data (), sizeof(Asset_Pack_Entry), entries.size (), file) == entries.size ());
+        ok = ok && (blocks .empty () || std::fwrite (blocks .data (), sizeof(Asset_Pack_Block), blocks .size (), file) == blocks .size ());
+        ok = ok && (names  .empty () || std::fwrite (names  .data (), names.size (), 1, file) == 1);
+
+        ok = ok && std::fseek (file, 0, SEEK_SET) == 0 && std::fwrite (&header, sizeof(header), 1, file) == 1;
+        ok = std::fclose (file) == 0 && ok;
+
+        file = nullptr;
+
+        return ok;
+    }
+
+    ///Abre el paquete como si fuera la carpeta root. Solo se leen la cabecera y las tablas, que se comprueban
+    ///enteras para que read no tenga que desconfiar de ellas.
+    bool Asset_Pack::open (const std::string & path, const std::string & given_root)
+    {
+        entries.clear ();
+        blocks .clear ();
+        names  .clear ();
+
+        if (!file.open (path) || file.size () < sizeof(Asset_Pack_Header)) return false;
+
+        Asset_Pack_Header header;
+
+        std::memcpy (&header, file.data (), sizeof(header));
+
+        if (std::memcmp (header.magic, pack_magic, sizeof(pack_magic)) != 0 || header.version != pack_version || header.block_size != block_size) return false;
+
+        // Los tamaños de la cabecera pueden venir de un archivo dañado: cada término se limita por lo que queda del
+        // archivo antes de multiplicarlo o sumarlo, para que la suma no pueda desbordarse y pasar la comprobación:
+
+        if (header.table_offset > file.size ()) return false;
+
+        uint64_t available = file.size () - header.table_offset;
+
+        if (header.asset_count > available / sizeof(Asset_Pack_Entry)) return false;
+
+        available -= uint64_t(header.asset_count) * sizeof(Asset_Pack_Entry);
+
+        if (header.block_count > available / sizeof(Asset_Pack_Block)) return false;
+
+        available -= header.block_count * sizeof(Asset_Pack_Block);
+
+        if (header.names_size > available) return false;
+
+        const char * tables = file.data () + header.table_offset;
+
+        entries.resize (header.asset_count);
+        blocks .resize (size_t(header.block_count));
+
+        if (!entries.empty ()) std::memcpy (entries.data (), tables, entries.size () * sizeof(Asset_Pack_Entry));
+
+        tables += entries.size () * sizeof(Asset_Pack_Entry);
+
+        if (!blocks.empty ()) std::memcpy (blocks.data (), tables, blocks.size () * sizeof(Asset_Pack_Block));
+
+        tables += blocks.size () * sizeof(Asset_Pack_Block);
+
+        for (const Asset_Pack_Block & block : blocks)
+        {
+            if (block.offset > header.table_offset || block.compressed_size > header.table_offset - block.offset) return false;
+            if (block.raw_size > block_size) return false;
+        }
+
+        for (size_t index = 0; index < entries.size (); ++index)
+        {
+            const Asset_Pack_Entry & entry = entries[index];
+
+            if (entry.name_offset > header.names_size || entry.name_length > header.names_size - entry.name_offset) return false;
+
+            // Todos los bloques de una sección menos el último están llenos, así que cada uno va a block_size * i:
+
+            for (const Asset_Pack_Section & section : entry.sections)
+            {
+                if (uint64_t(section.first_block) + section.block_count > blocks.size ()) return false;
+                if (section.block_count != (section.raw_size + block_size - 1) / block_size) return false;
+
+                for (uint32_t block = 0; block < section.block_count; ++block)
+                {
+                    uint64_t expected = std::min< uint64_t > (block_size, section.raw_size - uint64_t(block) * block_size);
+
+                    if (blocks[section.first_block + block].raw_size != expected) return false;
+                }
+            }
+
+            names[std::string(tables + entry.name_offset, entry.name_length)] = index;
+        }
+
+        root = absolute_path (given_root).string ();
+
+        std::error_code error;
+
+        written = fs::last_write_time (path, error);
+
+        return !error;
+    }
+
+    ///Busca el asset que corresponde a la ruta de un modelo, o devuelve nullptr si no está
+    const Asset_Pack_Entry * Asset_Pack::find (const std::string & path) const
+    {
+        fs::path relative = absolute_path (path).lexically_relative (root);
+
+        if (relative.empty ()) return nullptr;
+
+        auto found = names.find (relative.generic_string ());
+
+        if (found == names.end ()) return nullptr;
+
+        //Un archivo editado después de crear el paquete se lee del disco, sobre todo al recargarlo en caliente
+        std::error_code error;
+
+        fs::file_time_type source_time = fs::last_write_time (path, error);
+
+        if (!error && source_time > written) return nullptr;
+
+        return &entries[found->second];
+    }
+
+    ///Descomprime una sección del asset en destination
+    bool Asset_Pack::read (const Asset_Pack_Entry & entry, Asset_Pack_Entry::Section section, void * destination) const
+    {
+        const Asset_Pack_Section & range = entry.sections[section];
+
+        uint8_t * output = static_cast< uint8_t * >(destination);
+
+        std::atomic< bool > ok(true);
+
+        parallel_for (range.block_count, [&] (size_t index)
+        {
+            const Asset_Pack_Block & block = blocks[range.first_block + index];
+
+            const uint8_t * input  = reinterpret_cast< const uint8_t * >(file.data () + block.offset);
+            uint8_t       * target = output + index * block_size;
+
+            if (block.compressed_size == block.raw_size)
+                std::memcpy (target, input, block.raw_size);
+            else
+            if (!lz4_decompress (input, block.compressed_size, target, block.raw_size))
+                ok = false;
+        });
+
+        return ok;
+    }
+
+    ///Monta un paquete para todos los modelos que se carguen después. Equivale a la carpeta en la que está.
+    bool Asset_Pack::mount (const std::string & path)
+    {
+        std::unique_ptr< Asset_Pack > pack(new Asset_Pack);
+
+        if (!pack->open (path, absolute_path (path).parent_path ().string ())) return false;
+
+        mounted_packs ().push_back (std::move (pack));
+
+        return true;
+    }
+
+    ///Busca la ruta en los paquetes montados, en el orden en el que se montaron
+    const Asset_Pack * Asset_Pack::find_mounted (const std::string & path, const Asset_Pack_Entry * & entry)
+    {
+        for (const std::unique_ptr< Asset_Pack > & pack : mounted_packs ())
+        {
+            entry = pack->find (path);
+
+            if (entry) return pack.get ();
+        }
+
+        entry = nullptr;
+
+        return nullptr;
+    }
+}
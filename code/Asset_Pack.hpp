@@ -0,0 +1,177 @@
+/**
+* @file Asset_Pack.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda los paquetes de assets: muchas mallas ya preparadas para el motor en un solo archivo, cada una
+* comprimida por separado con LZ4 en bloques que se descomprimen en paralelo directamente en los buffers del modelo
+**/
+
+#ifndef ASSET_PACK_HEADER
+#define ASSET_PACK_HEADER
+
+    #include <cstdint>
+    #include <cstdio>
+    #include <filesystem>
+    #include <memory>
+    #include <string>
+    #include <unordered_map>
+    #include <vector>
+    #include "math.hpp"
+    #include "Meshlet.hpp"
+    #include "Index_Buffer.hpp"
+    #include "Mapped_File.hpp"
+
+    namespace Engine
+    {
+
+        ///Estructura del archivo: cabecera, bloques comprimidos, tabla de assets, tabla de bloques y nombres. Las
+        ///tablas van al final porque se escriben al cerrar. Cada asset guarda sus vértices, normales, índices y
+        ///meshlets como cuatro secciones con el mismo formato que tienen en memoria, y cada sección se parte en
+        ///bloques de block_size bytes que se comprimen por separado.
+        struct Asset_Pack_Header
+        {
+            char     magic[4];                          ///< "MLP1"
+            uint32_t version;
+            uint32_t asset_count;
+            uint32_t block_size;
+            uint64_t table_offset;
+            uint64_t block_count;
+            uint64_t names_size;
+        };
+
+        struct Asset_Pack_Section
+        {
+            uint64_t raw_size;
+            uint32_t first_block;
+            uint32_t block_count;
+        };
+
+        struct Asset_Pack_Entry
+        {
+            enum Section { VERTICES, NORMALS, INDICES, MESHLETS, SECTION_COUNT };
+
+            uint64_t           name_offset;
+            uint32_t           name_length;
+            uint32_t           meshlet_count;
+            uint64_t           vertex_count;
+            uint64_t           index_count;
+            uint32_t           index_size;          ///< 2 o 4, el ancho que eligió Index_Buffer al preparar la malla
+            uint32_t           reserved;
+            float              bounding_sphere[4];
+            float              min_corner[3];
+            float              max_corner[3];
+            Asset_Pack_Section sections[SECTION_COUNT];
+        };
+
+        ///Si compressed_size es igual a raw_size el bloque no se comprimía y se guarda tal cual
+        struct Asset_Pack_Block
+        {
+            uint64_t offset;
+            uint32_t compressed_size;
+            uint32_t raw_size;
+        };
+
+        ///Malla ya preparada: sin triángulos degenerados, con normales y dividida en meshlets
+        struct Packed_Mesh
+        {
+            std::vector< Point4f > vertices;
+            std::vector< Point4f > normals;
+            Index_Buffer           indices;
+            std::vector< Meshlet > meshlets;
+            Vector4f               bounding_sphere;
+            Vector3f               min_corner;
+            Vector3f               max_corner;
+        };
+
+        ///Asset comprimido en memoria, listo para añadirlo a un paquete. Los bloques de sus secciones se numeran desde 0.
+        struct Compressed_Asset
+        {
+            Asset_Pack_Entry                      entry;
+            std::vector< std::vector< uint8_t > > blocks;
+            std::vector< uint32_t >               raw_sizes;
+
+            uint64_t raw_bytes        () const;
+            uint64_t compressed_bytes () const;
+        };
+
+        ///Comprime las secciones de una malla. Se puede llamar a la vez desde varios hilos.
+        Compressed_Asset compress_asset (const Packed_Mesh & mesh);
+
+        ///Escribe un paquete asset a asset, en el orden en el que se añaden
+        class Asset_Pack_Writer
+        {
+            FILE *                          file;
+            Asset_Pack_Header               header;
+            std::vector< Asset_Pack_Entry > entries;
+            std::vector< Asset_Pack_Block > blocks;
+            std::string                     names;
+
+        public:
+
+            Asset_Pack_Writer();
+           ~Asset_Pack_Writer();
+
+            Asset_Pack_Writer(const Asset_Pack_Writer &) = delete;
+            Asset_Pack_Writer & operator = (const Asset_Pack_Writer &) = delete;
+
+            bool open  (const std::string & path);
+
+            ///Añade un asset con el nombre por el que se buscará, relativo a la carpeta que representa el paquete
+            bool add   (const std::string & name, const Compressed_Asset & asset);
+
+            ///Escribe las tablas y la cabecera definitiva
+            bool close ();
+        };
+
+        ///Paquete abierto para leer. El archivo se proyecta en memoria, de modo que leer un asset solo trae del disco
+        ///(o de la red) sus propios bloques, y solo se copian las tablas.
+        class Asset_Pack
+        {
+        public:
+
+            ///Tamaño sin comprimir de los bloques: lo bastante pequeño para repartir un asset grande entre todos los
+            ///hilos y lo bastante grande para que LZ4 comprima bien
+            static constexpr uint32_t block_size = 1u << 18;
+
+        private:
+
+            Mapped_File                     file;
+            std::string                     root;           ///< Carpeta, absoluta, a la que equivale el paquete
+            std::filesystem::file_time_type written;        ///< Fecha del paquete, para no servir assets cuyo archivo ha cambiado después
+            std::vector< Asset_Pack_Entry > entries;
+            std::vector< Asset_Pack_Block > blocks;
+
+            std::unordered_map< std::string, size_t > names;
+
+        public:
+
+            ///Abre el paquete como si fuera la carpeta root
+            bool open (const std::string & path, const std::string & root);
+
+            ///Busca el asset que corresponde a la ruta de un modelo, o devuelve nullptr si no está o si el archivo del
+            ///modelo es más nuevo que el paquete (por ejemplo, porque se ha editado y se está recargando)
+            const Asset_Pack_Entry * find (const std::string & path) const;
+
+            ///Descomprime una sección del asset en destination, que debe tener sections[section].raw_size bytes.
+            ///Los bloques se reparten entre los hilos del sistema de trabajos.
+            bool read (const Asset_Pack_Entry & entry, Asset_Pack_Entry::Section section, void * destination) const;
+
+            size_t size () const { return entries.size (); }
+
+        public:
+
+            ///Monta un paquete para todos los modelos que se carguen después. Equivale a la carpeta en la que está.
+            ///No se puede llamar mientras se cargan modelos.
+            static bool mount (const std::string & path);
+
+            ///Busca la ruta en los paquetes montados, en el orden en el que se montaron
+            static const Asset_Pack * find_mounted (const std::string & path, const Asset_Pack_Entry * & entry);
+        };
+
+    }
+
+#endif
@@ -0,0 +1,219 @@
+/**
+* @file Asset_Watcher.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que vigila los archivos de los modelos de una escena y avisa de los que cambian en disco (inotify en Linux,
+* y comparando las fechas de modificación cada poco tiempo en el resto de sistemas)
+**/
+
+#include "Asset_Watcher.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#ifdef __linux__
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+namespace Engine
+{
+    namespace
+    {
+        ///Fecha de modificación y tamaño de un archivo. Si no existe (mientras se renombra, por ejemplo) se devuelven ceros.
+        void stamp_of (const std::string & path, int64_t & write_time, uint64_t & size)
+        {
+            std::error_code error;
+
+            auto time = std::filesystem::last_write_time (path, error);
+
+            write_time = error ? 0 : int64_t(time.time_since_epoch ().count ());
+
+            auto bytes = std::filesystem::file_size (path, error);
+
+            size = error ? 0 : uint64_t(bytes);
+        }
+    }
+
+    Asset_Watcher::Asset_Watcher()
+    {
+    #ifdef __linux__
+        inotify = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+    #endif
+    }
+
+    Asset_Watcher::~Asset_Watcher()
+    {
+    #ifdef __linux__
+        if (inotify >= 0) close (inotify);
+    #endif
+    }
+
+    void Asset_Watcher::watch (const std::string & path)
+    {
+        for (const File & file : files)
+        {
+            if (file.path == path) return;
+        }
+
+        std::filesystem::path location(path);
+
+        File file;
+
+        file.path = path;
+        file.name = location.filename ().string ();
+
+        stamp_of (path, file.write_time, file.size);
+
+    #ifdef __linux__
+        if (inotify >= 0)
+        {
+            std::string directory = location.parent_path ().string ();
+
+            //inotify devuelve el mismo descriptor para la misma carpeta aunque se escriba de otra forma
+            file.descriptor = inotify_add_watch (inotify, directory.empty () ? "." : directory.c_str (), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+            //Si no se puede vigilar una carpeta (por el límite de vigilancias del sistema, por ejemplo) se pasa a comprobar las fechas
+            if (file.descriptor < 0)
+            {
+                close (inotify);
+                inotify = -1;
+            }
+        }
+    #endif
+
+        files.push_back (file);
+    }
+
+    std::vector< std::string > Asset_Watcher::wait_for_changes (int timeout_milliseconds)
+    {
+        std::vector< bool > changed(files.size (), false);
+
+        bool any = false;
+
+        if (!uses_polling ())
+        {
+            any = read_events (timeout_milliseconds, changed);
+        }
+        else
+        {
+            auto deadline = std::chrono::steady_clock::now () + std::chrono::milliseconds(timeout_milliseconds);
+
+            while (!(any = poll_files (changed)) && std::chrono::steady_clock::now () < deadline)
+            {
+                std::this_thread::sleep_for (std::chrono::milliseconds(poll_interval_milliseconds));
+            }
+        }
+
+        if (!any) return {};
+
+        // Se sigue esperando mientras lleguen cambios, hasta que pasa settle_milliseconds sin ninguno:
+
+        if (!uses_polling ())
+        {
+            while (read_events (settle_milliseconds, changed)) { }
+        }
+        else
+        {
+            do std::this_thread::sleep_for (std::chrono::milliseconds(settle_milliseconds));
+            while (poll_files (changed));
+        }
+
+        std::vector< std::string > paths;
+
+        for (size_t index = 0; index < files.size (); ++index)
+        {
+            if (changed[index]) paths.push_back (files[index].path);
+        }
+
+        return paths;
+    }
+
+    bool Asset_Watcher::read_events (int timeout_milliseconds, std::vector< bool > & changed)
+    {
+    #ifdef __linux__
+
+        pollfd descriptor = { inotify, POLLIN, 0 };
+
+        if (poll (&descriptor, 1, timeout_milliseconds) <= 0) return false;
+
+        alignas(inotify_event) char buffer[16 * 1024];
+
+        bool any = false;
+
+        for (;;)
+        {
+            ssize_t length = read (inotify, buffer, sizeof(buffer));
+
+            if (length <= 0) break;
+
+            for (char * pointer = buffer; pointer < buffer + length; )
+            {
+                const inotify_event * event = reinterpret_cast< const inotify_event * >(pointer);
+
+                pointer += sizeof(inotify_event) + event->len;
+
+                //Si se han perdido eventos no se sabe qué ha cambiado, así que se da todo por cambiado
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    std::fill (changed.begin (), changed.end (), true);
+                    any = true;
+                    continue;
+                }
+
+                if (event->len == 0) continue;
+
+                for (size_t index = 0; index < files.size (); ++index)
+                {
+                    if (files[index].descriptor == event->wd && files[index].name == event->name)
+                    {
+                        changed[index] = true;
+                        any = true;
+                    }
+                }
+            }
+        }
+
+        return any;
+
+    #else
+
+        (void)timeout_milliseconds;
+        (void)changed;
+
+        return false;
+
+    #endif
+    }
+
+    bool Asset_Watcher::poll_files (std::vector< bool > & changed)
+    {
+        bool any = false;
+
+        for (size_t index = 0; index < files.size (); ++index)
+        {
+            File & file = files[index];
+
+            int64_t  write_time;
+            uint64_t size;
+
+            stamp_of (file.path, write_time, size);
+
+            if (write_time != file.write_time || size != file.size)
+            {
+                file.write_time = write_time;
+                file.size       = size;
+                changed[index]  = true;
+                any             = true;
+            }
+        }
+
+        return any;
+    }
+}
@@ -0,0 +1,78 @@
+/**
+* @file Asset_Watcher.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que vigila los archivos de los modelos de una escena y avisa de los que cambian en disco (inotify en Linux,
+* y comparando las fechas de modificación cada poco tiempo en el resto de sistemas)
+**/
+
+#ifndef ASSET_WATCHER_HEADER
+#define ASSET_WATCHER_HEADER
+
+    #include <cstdint>
+    #include <string>
+    #include <vector>
+
+    namespace Engine
+    {
+
+        ///En Linux se vigilan las carpetas, no los archivos, porque muchos editores y exportadores guardan escribiendo
+        ///un archivo temporal y renombrándolo encima del original, lo que deja sin vigilar al archivo antiguo. Si no
+        ///hay inotify, o no se puede crear, se comprueban la fecha y el tamaño de cada archivo cada poll_interval.
+        class Asset_Watcher
+        {
+        public:
+
+            ///Tiempo entre comprobaciones cuando no hay inotify, y tiempo sin cambios que se espera antes de avisar,
+            ///para no leer un archivo que todavía se está escribiendo
+            static constexpr int poll_interval_milliseconds = 250;
+            static constexpr int settle_milliseconds        = 100;
+
+        private:
+
+            struct File
+            {
+                std::string path;
+                std::string name;
+                int         descriptor = -1;                ///< Descriptor de inotify de su carpeta
+                int64_t     write_time = 0;
+                uint64_t    size       = 0;
+            };
+
+            std::vector< File > files;
+
+            int inotify = -1;
+
+        public:
+
+            Asset_Watcher();
+           ~Asset_Watcher();
+
+            Asset_Watcher(const Asset_Watcher &) = delete;
+            Asset_Watcher & operator = (const Asset_Watcher &) = delete;
+
+            ///Empieza a vigilar un archivo. Las rutas repetidas se ignoran.
+            void watch (const std::string & path);
+
+            ///Espera como mucho timeout_milliseconds a que cambie algún archivo y devuelve, sin repetir, las rutas
+            ///(tal y como se pasaron a watch) de los que han cambiado. Devuelve una lista vacía si no ha cambiado ninguno.
+            std::vector< std::string > wait_for_changes (int timeout_milliseconds);
+
+            bool uses_polling () const { return inotify < 0; }
+
+        private:
+
+            ///Lee los eventos pendientes de inotify durante como mucho timeout_milliseconds y apunta los archivos vigilados que tocan
+            bool read_events (int timeout_milliseconds, std::vector< bool > & changed);
+
+            ///Compara la fecha y el tamaño de cada archivo con los de la última vez
+            bool poll_files (std::vector< bool > & changed);
+        };
+
+    }
+
+#endif
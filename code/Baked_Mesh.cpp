@@ -0,0 +1,310 @@
+/**
+* @file Baked_Mesh.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda el formato de malla preprocesada del motor (.mesh): los meshlets ya construidos, cada uno en un
+* bloque independiente del archivo, para poder escribirlos mientras se importa y leerlos de uno en uno bajo demanda
+**/
+
+#include "Baked_Mesh.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace Engine
+{
+    namespace
+    {
+        const char     baked_magic[4] = { 'M', 'L', 'B', '1' };
+        const uint32_t baked_version  = 1;
+
+        ///Tamaño de un bloque de meshlet en el archivo
+        size_t block_size (uint32_t vertex_count, uint32_t index_count)
+        {
+            return size_t(vertex_count) * 6 * sizeof(float) + index_count;
+        }
+
+        //Los archivos pueden pasar de 2 GB, así que se usan las versiones de 64 bits de seek y tell
+        int seek (FILE * file, uint64_t offset)
+        {
+        #ifdef _WIN32
+            return _fseeki64 (file, int64_t(offset), SEEK_SET);
+        #else
+            return fseeko    (file, off_t  (offset), SEEK_SET);
+        #endif
+        }
+
+        uint64_t tell (FILE * file)
+        {
+        #ifdef _WIN32
+            return uint64_t(_ftelli64 (file));
+        #else
+            return uint64_t(ftello    (file));
+        #endif
+        }
+    }
+
+    ///Devuelve true si el archivo tiene la extensión dada (sin distinguir mayúsculas)
+    bool has_extension (const std::string & path, const char * extension)
+    {
+        size_t length = std::strlen (extension);
+
+        if (path.size () < length) return false;
+
+        return std::equal
+        (
+            path.end () - length, path.end (), extension,
+            [] (char a, char b) { return std::tolower (a) == std::tolower (b); }
+        );
+    }
+
+    Baked_Mesh_Writer::Baked_Mesh_Writer() : file(nullptr)
+    {
+    }
+
+    Baked_Mesh_Writer::~Baked_Mesh_Writer()
+    {
+        if (file) std::fclose (file);
+    }
+
+    bool Baked_Mesh_Writer::open (const std::string & path)
+    {
+        file = std::fopen (path.c_str (), "wb");
+
+        if (!file) return false;
+
+        std::memset (&header, 0, sizeof(header));
+        std::memcpy (header.magic, baked_magic, sizeof(baked_magic));
+        header.version = baked_version;
+
+        table  .clear ();
+        spheres.clear ();
+
+        // La cabecera definitiva se escribe al cerrar. Mientras tanto se reserva su espacio:
+
+        return std::fwrite (&header, sizeof(header), 1, file) == 1;
+    }
+
+    ///Añade un meshlet. Los índices son locales a sus vértices (menos de 256)
+    bool Baked_Mesh_Writer::write (const Point4f * vertices, const Point4f * normals, int vertex_count, const int * local_indices, int index_count)
+    {
+        Meshlet meshlet;
+
+        meshlet.compute_bounds (vertices, vertex_count, local_indices, index_count);
+
+        Baked_Meshlet entry;
+
+        std::memcpy (entry.bounding_sphere, &meshlet.bounding_sphere.x, sizeof(entry.bounding_sphere));
+        std::memcpy (entry.cone_axis,       &meshlet.cone_axis.x,       sizeof(entry.cone_axis      ));
+
+        entry.cone_cos     = meshlet.cone_cos;
+        entry.cone_sin     = meshlet.cone_sin;
+        entry.vertex_count = uint32_t(vertex_count);
+        entry.index_count  = uint32_t(index_count );
+        entry.reserved     = 0;
+        entry.data_offset  = tell (file);
+
+        // Se empaqueta el bloque para escribirlo con una sola llamada:
+
+        block.resize (block_size (entry.vertex_count, entry.index_count));
+
+        float * floats = reinterpret_cast< float * >(block.data ());
+
+        for (int index = 0; index < vertex_count; ++index)
+        {
+            *floats++ = vertices[index].x; *floats++ = vertices[index].y; *floats++ = vertices[index].z;
+        }
+
+        for (int index = 0; index < vertex_count; ++index)
+        {
+            *floats++ = normals[index].x; *floats++ = normals[index].y; *floats++ = normals[index].z;
+        }
+
+        uint8_t * bytes = reinterpret_cast< uint8_t * >(floats);
+
+        for (int index = 0; index < index_count; ++index)
+        {
+            *bytes++ = uint8_t(local_indices[index]);
+        }
+
+        if (std::fwrite (block.data (), block.size (), 1, file) != 1) return false;
+
+        // Se acumulan los datos de la cabecera:
+
+        Vector3f center = Vector3f(meshlet.bounding_sphere);
+        Vector3f extent = Vector3f(meshlet.bounding_sphere.w, meshlet.bounding_sphere.w, meshlet.bounding_sphere.w);
+
+        min_corner = table.empty () ? center - extent : glm::min (min_corner, center - extent);
+        max_corner = table.empty () ? center + extent : glm::max (max_corner, center + extent);
+
+        spheres.push_back (meshlet.bounding_sphere);
+        table  .push_back (entry);
+
+        header.vertex_count += uint64_t(vertex_count);
+        header.index_count  += uint64_t(index_count );
+
+        return true;
+    }
+
+    ///Escribe la tabla de meshlets y la cabecera definitiva
+    bool Baked_Mesh_Writer::close ()
+    {
+        if (!file) return false;
+
+        // La esfera del modelo se calcula a partir de las esferas de los meshlets:
+
+        Vector3f center = (min_corner + max_corner) * 0.5f;
+        float    radius = 0.f;
+
+        for (const Vector4f & sphere : spheres)
+        {
+            radius = std::max (radius, glm::distance (center, Vector3f(sphere)) + sphere.w);
+        }
+
+        header.meshlet_count      = uint32_t(table.size ());
+        header.table_offset       = tell (file);
+        header.bounding_sphere[0] = center.x;
+        header.bounding_sphere[1] = center.y;
+        header.bounding_sphere[2] = center.z;
+        header.bounding_sphere[3] = radius;
+
+        bool ok = table.empty () || std::fwrite (table.data (), sizeof(Baked_Meshlet), table.size (), file) == table.size ();
+
+        ok = ok && seek (file, 0) == 0 && std::fwrite (&header, sizeof(header), 1, file) == 1;
+        ok = std::fclose (file) == 0 && ok;
+
+        file = nullptr;
+
+        return ok;
+    }
+
+    Baked_Mesh_Reader::Baked_Mesh_Reader() : file(nullptr)
+    {
+    }
+
+    Baked_Mesh_Reader::~Baked_Mesh_Reader()
+    {
+        if (file) std::fclose (file);
+    }
+
+    bool Baked_Mesh_Reader::open (const std::string & path)
+    {
+        file = std::fopen (path.c_str (), "rb");
+
+        if (!file) return false;
+
+        if (std::fread (&header, sizeof(header), 1, file) != 1) return false;
+
+        if (std::memcmp (header.magic, baked_magic, sizeof(baked_magic)) != 0 || header.version != baked_version) return false;
+
+        // Solo se carga la tabla. Los datos de los meshlets se leen cuando se piden:
+
+        if (std::fseek (file, 0, SEEK_END) != 0) return false;
+
+        uint64_t file_size = tell (file);
+
+        if (header.table_offset < sizeof(header) || header.table_offset > file_size) return false;
+        if (header.meshlet_count > (file_size - header.table_offset) / sizeof(Baked_Meshlet)) return false;
+
+        table.resize (header.meshlet_count);
+
+        if (seek (file, header.table_offset) != 0) return false;
+
+        if (!table.empty () && std::fread (table.data (), sizeof(Baked_Meshlet), table.size (), file) != table.size ()) return false;
+
+        // Los meshlets se copian en huecos de tamaño fijo, así que un archivo dañado no puede traer meshlets más
+        // grandes ni bloques fuera de la zona de datos. Los índices locales se comprueban al leer cada bloque:
+
+        uint64_t vertex_count = 0;
+        uint64_t index_count  = 0;
+
+        for (const Baked_Meshlet & entry : table)
+        {
+            bool fits_slot  = entry.vertex_count <= uint32_t(Meshlet::max_vertices)
+                           && entry.index_count  <= uint32_t(Meshlet::max_triangles * 3)
+                           && entry.index_count  %  3 == 0;
+
+            bool fits_file  = entry.data_offset >= sizeof(header)
+                           && entry.data_offset <= header.table_offset
+                           && block_size (entry.vertex_count, entry.index_count) <= header.table_offset - entry.data_offset;
+
+            if (!fits_slot || !fits_file) return false;
+
+            vertex_count += entry.vertex_count;
+            index_count  += entry.index_count;
+        }
+
+        //Un bake interrumpido deja la cabecera sin meshlets
+        return !table.empty () && vertex_count == header.vertex_count && index_count == header.index_count;
+    }
+
+    ///Devuelve el meshlet de la tabla con los rangos a 0
+    Meshlet Baked_Mesh_Reader::meshlet_info (int index) const
+    {
+        const Baked_Meshlet & entry = table[index];
+
+        Meshlet meshlet;
+
+        meshlet.vertex_offset   = 0;
+        meshlet.vertex_count    = entry.vertex_count;
+        meshlet.index_offset    = 0;
+        meshlet.index_count     = entry.index_count;
+        meshlet.bounding_sphere = Vector4f(entry.bounding_sphere[0], entry.bounding_sphere[1], entry.bounding_sphere[2], entry.bounding_sphere[3]);
+        meshlet.cone_axis       = Vector3f(entry.cone_axis[0], entry.cone_axis[1], entry.cone_axis[2]);
+        meshlet.cone_cos        = entry.cone_cos;
+        meshlet.cone_sin        = entry.cone_sin;
+
+        return meshlet;
+    }
+
+    ///Lee los vértices, normales e índices de un meshlet. Los índices se escriben desde index_offset sumando vertex_base
+    bool Baked_Mesh_Reader::read_meshlet (int index, Point4f * vertices, Point4f * normals, Index_Buffer & indices, size_t index_offset, int vertex_base)
+    {
+        const Baked_Meshlet & entry = table[index];
+
+        block.resize (block_size (entry.vertex_count, entry.index_count));
+
+        if (seek (file, entry.data_offset) != 0 || std::fread (block.data (), block.size (), 1, file) != 1) return false;
+
+        //Un índice local fuera del meshlet apuntaría fuera de su hueco
+        const uint8_t * local_indices = block.data () + size_t(entry.vertex_count) * 6 * sizeof(float);
+
+        for (uint32_t i = 0; i < entry.index_count; ++i)
+        {
+            if (local_indices[i] >= entry.vertex_count) return false;
+        }
+
+        const float * floats = reinterpret_cast< const float * >(block.data ());
+
+        for (uint32_t vertex = 0; vertex < entry.vertex_count; ++vertex, floats += 3)
+        {
+            vertices[vertex] = Point4f(floats[0], floats[1], floats[2], 1.f);
+        }
+
+        for (uint32_t vertex = 0; vertex < entry.vertex_count; ++vertex, floats += 3)
+        {
+            normals[vertex] = Point4f(floats[0], floats[1], floats[2], 0.f);
+        }
+
+        const uint8_t * bytes = reinterpret_cast< const uint8_t * >(floats);
+
+        indices.visit
+        (
+            [&] (auto * data)
+            {
+                typedef typename std::remove_pointer< decltype(data) >::type Index;
+
+                for (uint32_t i = 0; i < entry.index_count; ++i)
+                {
+                    data[index_offset + i] = Index(vertex_base + int(bytes[i]));
+                }
+            }
+        );
+
+        return true;
+    }
+}
@@ -0,0 +1,113 @@
+/**
+* @file Baked_Mesh.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda el formato de malla preprocesada del motor (.mesh): los meshlets ya construidos, cada uno en un
+* bloque independiente del archivo, para poder escribirlos mientras se importa y leerlos de uno en uno bajo demanda
+**/
+
+#ifndef BAKED_MESH_HEADER
+#define BAKED_MESH_HEADER
+
+    #include <cstdint>
+    #include <cstdio>
+    #include <string>
+    #include <vector>
+    #include "math.hpp"
+    #include "Meshlet.hpp"
+    #include "Index_Buffer.hpp"
+
+    namespace Engine
+    {
+
+        ///Estructura del archivo: cabecera, bloques de datos de los meshlets y tabla de meshlets al final
+        ///(la tabla se escribe al cerrar porque al importar por partes no se sabe cuántos habrá).
+        ///Cada bloque guarda las posiciones (3 floats), las normales (3 floats) y los índices locales (1 byte cada uno).
+        struct Baked_Mesh_Header
+        {
+            char     magic[4];                          ///< "MLB1"
+            uint32_t version;
+            uint32_t meshlet_count;
+            uint32_t reserved;
+            uint64_t vertex_count;
+            uint64_t index_count;
+            float    bounding_sphere[4];
+            uint64_t table_offset;
+        };
+
+        struct Baked_Meshlet
+        {
+            float    bounding_sphere[4];
+            float    cone_axis[3];
+            float    cone_cos;
+            float    cone_sin;
+            uint32_t vertex_count;
+            uint32_t index_count;
+            uint32_t reserved;
+            uint64_t data_offset;
+        };
+
+        ///Escribe un archivo .mesh meshlet a meshlet, sin necesitar la malla completa en memoria
+        class Baked_Mesh_Writer
+        {
+            FILE *                       file;
+            Baked_Mesh_Header            header;
+            std::vector< Baked_Meshlet > table;
+            std::vector< uint8_t >       block;
+
+            Vector3f                     min_corner;
+            Vector3f                     max_corner;
+            std::vector< Vector4f >      spheres;
+
+        public:
+
+            Baked_Mesh_Writer();
+           ~Baked_Mesh_Writer();
+
+            bool open  (const std::string & path);
+
+            ///Añade un meshlet. Los índices son locales a sus vértices (menos de 256)
+            bool write (const Point4f * vertices, const Point4f * normals, int vertex_count, const int * local_indices, int index_count);
+
+            ///Escribe la tabla de meshlets y la cabecera definitiva
+            bool close ();
+        };
+
+        ///Lee la cabecera y la tabla de un archivo .mesh y después cada meshlet por separado
+        class Baked_Mesh_Reader
+        {
+            FILE *                       file;
+            Baked_Mesh_Header            header;
+            std::vector< Baked_Meshlet > table;
+            std::vector< uint8_t >       block;
+
+        public:
+
+            Baked_Mesh_Reader();
+           ~Baked_Mesh_Reader();
+
+            Baked_Mesh_Reader(const Baked_Mesh_Reader &) = delete;
+            Baked_Mesh_Reader & operator = (const Baked_Mesh_Reader &) = delete;
+
+            bool open (const std::string & path);
+
+            const Baked_Mesh_Header            & get_header () const { return header; }
+            const std::vector< Baked_Meshlet > & get_table  () const { return table;  }
+
+            ///Devuelve el meshlet de la tabla con los rangos a 0
+            Meshlet meshlet_info (int index) const;
+
+            ///Lee los vértices, normales e índices de un meshlet. Los índices se escriben desde index_offset sumando vertex_base
+            bool read_meshlet (int index, Point4f * vertices, Point4f * normals, Index_Buffer & indices, size_t index_offset, int vertex_base);
+        };
+
+        ///Devuelve true si el archivo tiene la extensión dada (sin distinguir mayúsculas)
+        bool has_extension (const std::string & path, const char * extension);
+
+    }
+
+#endif
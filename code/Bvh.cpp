@@ -0,0 +1,344 @@
+/**
+* @file Bvh.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda la jerarquía de volúmenes envolventes (BVH) que usan la escena, sobre las cajas de sus modelos,
+* y cada modelo, sobre las cajas de sus triángulos, para las consultas de visibilidad y de rayos
+**/
+
+#include "Bvh.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <deque>
+#include <numeric>
+
+namespace Engine
+{
+    using std::vector;
+
+    namespace
+    {
+        ///Los nodos con más primitivas que estas se siguen dividiendo en el hilo principal antes de repartir el trabajo
+        const int parallel_threshold = 4096;
+
+        ///Tamaño máximo de una hoja aunque la SAH diga que no compensa dividirla
+        const int max_sah_leaf_size = 16;
+    }
+
+    ///Construye la jerarquía sobre las cajas dadas. La primitiva i es la caja i
+    void Bvh::build (const vector< Aabb > & bounds, int leaf_size)
+    {
+        int number_of_primitives = int(bounds.size ());
+
+        max_leaf_size    = std::max (1, leaf_size);
+        primitive_bounds = bounds;
+
+        nodes.clear ();
+        order.resize (number_of_primitives);
+        primitive_leaf.assign (number_of_primitives, -1);
+
+        std::iota (order.begin (), order.end (), 0);
+
+        if (number_of_primitives == 0) return;
+
+        vector< Vector3f > centers(number_of_primitives);
+
+        for (int index = 0; index < number_of_primitives; ++index)
+        {
+            centers[index] = bounds[index].center ();
+        }
+
+        // Los primeros niveles se dividen aquí, en anchura, hasta tener suficientes subárboles para todos los hilos:
+
+        nodes.push_back ({ Aabb(), 0, 0, -1 });
+
+        std::deque< Build_Task > tasks{ { 0, 0, number_of_primitives } };
+        vector< Build_Task >     deferred;
+
+        size_t target = size_t(worker_count ()) * 4;
+
+        while (!tasks.empty ())
+        {
+            Build_Task task = tasks.front ();
+
+            tasks.pop_front ();
+
+            if (task.end - task.begin <= parallel_threshold || tasks.size () + deferred.size () + 1 >= target)
+            {
+                deferred.push_back (task);
+                continue;
+            }
+
+            int middle = split (nodes[task.node], task.begin, task.end, centers);
+
+            if (middle < 0)
+            {
+                nodes[task.node].first = task.begin;
+                nodes[task.node].count = task.end - task.begin;
+                continue;
+            }
+
+            int left = int(nodes.size ());
+
+            nodes[task.node].first = left;
+            nodes[task.node].count = 0;
+
+            nodes.push_back ({ Aabb(), 0, 0, task.node });
+            nodes.push_back ({ Aabb(), 0, 0, task.node });
+
+            tasks.push_back ({ left,     task.begin, middle   });
+            tasks.push_back ({ left + 1, middle,     task.end });
+        }
+
+        // Cada subárbol pendiente se construye en su propio array, ya que sus primitivas son un rango disjunto de order:
+
+        vector< vector< Node > > subtrees(deferred.size ());
+
+        parallel_for (deferred.size (), [&] (size_t index)
+        {
+            build_subtree (deferred[index], subtrees[index], centers);
+        });
+
+        // Y se copian al array de nodos. La raíz de cada subárbol ocupa el nodo que ya tenía reservado:
+
+        for (size_t index = 0; index < deferred.size (); ++index)
+        {
+            const Build_Task     & task    = deferred[index];
+            const vector< Node > & subtree = subtrees[index];
+
+            int base = int(nodes.size ());
+
+            auto global = [&] (int local) { return local == 0 ? task.node : base + local - 1; };
+
+            for (size_t local = 1; local < subtree.size (); ++local)
+            {
+                Node node = subtree[local];
+
+                if (node.count == 0) node.first = global (node.first);
+
+                node.parent = global (node.parent);
+
+                nodes.push_back (node);
+            }
+
+            Node root = subtree[0];
+
+            if (root.count == 0) root.first = global (root.first);
+
+            root.parent = nodes[task.node].parent;
+
+            nodes[task.node] = root;
+        }
+
+        for (int index = 0, number_of_nodes = int(nodes.size ()); index < number_of_nodes; ++index)
+        {
+            const Node & node = nodes[index];
+
+            for (int primitive = node.first; node.count > 0 && primitive < node.first + node.count; ++primitive)
+            {
+                primitive_leaf[order[primitive]] = index;
+            }
+        }
+    }
+
+    ///Construye entero el subárbol de una tarea en un array de nodos propio cuya raíz es el nodo 0
+    void Bvh::build_subtree (const Build_Task & task, vector< Node > & subtree, const vector< Vector3f > & centers)
+    {
+        subtree.clear ();
+        subtree.push_back ({ Aabb(), 0, 0, -1 });
+
+        vector< Build_Task > stack{ { 0, task.begin, task.end } };
+
+        while (!stack.empty ())
+        {
+            Build_Task current = stack.back ();
+
+            stack.pop_back ();
+
+            int middle = split (subtree[current.node], current.begin, current.end, centers);
+
+            if (middle < 0)
+            {
+                subtree[current.node].first = current.begin;
+                subtree[current.node].count = current.end - current.begin;
+                continue;
+            }
+
+            int left = int(subtree.size ());
+
+            subtree[current.node].first = left;
+            subtree[current.node].count = 0;
+
+            subtree.push_back ({ Aabb(), 0, 0, current.node });
+            subtree.push_back ({ Aabb(), 0, 0, current.node });
+
+            stack.push_back ({ left,     current.begin, middle      });
+            stack.push_back ({ left + 1, middle,        current.end });
+        }
+    }
+
+    ///Calcula la caja del nodo y, si conviene dividirlo, reparte sus primitivas y devuelve dónde se parten
+    int Bvh::split (Node & node, int begin, int end, const vector< Vector3f > & centers)
+    {
+        Aabb bounds;
+        Aabb center_bounds;
+
+        for (int index = begin; index < end; ++index)
+        {
+            bounds       .grow (primitive_bounds[order[index]]);
+            center_bounds.grow (centers         [order[index]]);
+        }
+
+        node.bounds = bounds;
+
+        int count = end - begin;
+
+        if (count <= max_leaf_size) return -1;
+
+        // Se divide por el eje en el que más se separan los centros:
+
+        Vector3f extent = center_bounds.max_corner - center_bounds.min_corner;
+        int      axis   = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+
+        //Si todos los centros coinciden no hay ningún plano que los separe y se parten por la mitad
+        if (extent[axis] <= 0.f) return begin + count / 2;
+
+        // Se reparten las primitivas en bins por su centro y se evalúa la SAH en cada separación entre bins:
+
+        struct Bin
+        {
+            Aabb bounds;
+            int  count = 0;
+        };
+
+        Bin   bins[number_of_bins];
+        float minimum = center_bounds.min_corner[axis];
+        float scale   = float(number_of_bins) / extent[axis];
+
+        auto bin_of = [&] (int primitive)
+        {
+            int bin = int((centers[primitive][axis] - minimum) * scale);
+
+            return bin < number_of_bins ? bin : number_of_bins - 1;
+        };
+
+        for (int index = begin; index < end; ++index)
+        {
+            Bin & bin = bins[bin_of (order[index])];
+
+            bin.count++;
+            bin.bounds.grow (primitive_bounds[order[index]]);
+        }
+
+        float right_area [number_of_bins];
+        int   right_count[number_of_bins];
+
+        Aabb accumulated;
+        int  accumulated_count = 0;
+
+        for (int bin = number_of_bins - 1; bin > 0; --bin)
+        {
+            accumulated.grow (bins[bin].bounds);
+            accumulated_count += bins[bin].count;
+
+            right_area [bin] = accumulated.surface_area ();
+            right_count[bin] = accumulated_count;
+        }
+
+        float best_cost  = std::numeric_limits< float >::max ();
+        int   best_split = -1;
+
+        accumulated       = Aabb();
+        accumulated_count = 0;
+
+        for (int bin = 0; bin < number_of_bins - 1; ++bin)
+        {
+            accumulated.grow (bins[bin].bounds);
+            accumulated_count += bins[bin].count;
+
+            if (accumulated_count == 0 || right_count[bin + 1] == 0) continue;
+
+            float cost = accumulated.surface_area () * accumulated_count + right_area[bin + 1] * right_count[bin + 1];
+
+            if (cost < best_cost)
+            {
+                best_cost  = cost;
+                best_split = bin;
+            }
+        }
+
+        // Coste de recorrer el nodo (1) más el de los hijos, frente a probar todas las primitivas en una hoja:
+
+        float area = bounds.surface_area ();
+
+        if (best_split >= 0 && area > 0.f && 1.f + best_cost / area >= float(count) && count <= max_sah_leaf_size) return -1;
+
+        if (best_split < 0) return begin + count / 2;
+
+        int * middle = std::partition (order.data () + begin, order.data () + end, [&] (int primitive) { return bin_of (primitive) <= best_split; });
+
+        return int(middle - order.data ());
+    }
+
+    ///Cambia la caja de una primitiva y ajusta los nodos que la contienen hasta la raíz, sin cambiar la estructura
+    void Bvh::refit (int primitive, const Aabb & bounds)
+    {
+        primitive_bounds[primitive] = bounds;
+
+        int   index = primitive_leaf[primitive];
+        Node & leaf = nodes[index];
+
+        leaf.bounds = Aabb();
+
+        for (int member = leaf.first; member < leaf.first + leaf.count; ++member)
+        {
+            leaf.bounds.grow (primitive_bounds[order[member]]);
+        }
+
+        for (index = leaf.parent; index >= 0; index = nodes[index].parent)
+        {
+            Node & node = nodes[index];
+
+            node.bounds = nodes[node.first].bounds;
+            node.bounds.grow (nodes[node.first + 1].bounds);
+        }
+    }
+
+    ///Añade a result las primitivas cuya caja toca el volumen de visión
+    void Bvh::query_frustum (const Frustum & frustum, vector< int > & result) const
+    {
+        if (nodes.empty ()) return;
+
+        vector< int > stack{ 0 };
+
+        while (!stack.empty ())
+        {
+            const Node & node = nodes[stack.back ()];
+
+            stack.pop_back ();
+
+            if (!frustum.intersects_box (node.bounds.min_corner, node.bounds.max_corner)) continue;
+
+            if (node.count == 0)
+            {
+                stack.push_back (node.first    );
+                stack.push_back (node.first + 1);
+                continue;
+            }
+
+            for (int index = node.first, end = node.first + node.count; index < end; ++index)
+            {
+                const Aabb & bounds = primitive_bounds[order[index]];
+
+                if (node.count == 1 || frustum.intersects_box (bounds.min_corner, bounds.max_corner))
+                {
+                    result.push_back (order[index]);
+                }
+            }
+        }
+    }
+}
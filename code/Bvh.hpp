@@ -0,0 +1,178 @@
+/**
+* @file Bvh.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda la jerarquía de volúmenes envolventes (BVH) que usan la escena, sobre las cajas de sus modelos,
+* y cada modelo, sobre las cajas de sus triángulos, para las consultas de visibilidad y de rayos
+**/
+
+#ifndef BVH_HEADER
+#define BVH_HEADER
+
+    #include <vector>
+    #include "Aabb.hpp"
+    #include "Frustum.hpp"
+
+    namespace Engine
+    {
+
+        ///BVH binaria sobre primitivas cualesquiera de las que solo se conoce su caja. Se construye con SAH por
+        ///bins, repartiendo los subárboles grandes entre los núcleos, y se puede reajustar cuando se mueve una primitiva.
+        class Bvh
+        {
+        public:
+
+            struct Node
+            {
+                Aabb bounds;
+                int  first;                                 ///< Hijo izquierdo (el derecho es first + 1) o primera primitiva de la hoja
+                int  count;                                 ///< Número de primitivas de la hoja, o 0 si es un nodo interno
+                int  parent;
+            };
+
+            static constexpr int number_of_bins = 12;
+
+        private:
+
+            std::vector< Node > nodes;
+            std::vector< int  > order;                      ///< Primitivas en el orden de las hojas
+            std::vector< Aabb > primitive_bounds;
+            std::vector< int  > primitive_leaf;
+            int                 max_leaf_size = 4;
+
+        public:
+
+            ///Construye la jerarquía sobre las cajas dadas. La primitiva i es la caja i
+            void build (const std::vector< Aabb > & bounds, int leaf_size = 4);
+
+            ///Cambia la caja de una primitiva y ajusta los nodos que la contienen hasta la raíz, sin cambiar la estructura
+            void refit (int primitive, const Aabb & bounds);
+
+            ///Añade a result las primitivas cuya caja toca el volumen de visión (que debe estar en el mismo espacio que las cajas)
+            void query_frustum (const Frustum & frustum, std::vector< int > & result) const;
+
+            ///Recorre los nodos que atraviesa el rayo, los más cercanos primero, y llama a test(primitiva, max_distance)
+            ///con cada primitiva candidata. El test debe reducir max_distance si encuentra un impacto más cercano.
+            template< class TEST >
+            void ray_cast (const Ray & ray, float max_distance, TEST && test) const;
+
+            bool empty () const { return nodes.empty (); }
+
+            ///Memoria que ocupan los nodos y las tablas de primitivas
+            size_t bytes () const
+            {
+                return nodes.capacity () * sizeof(Node) + order.capacity () * sizeof(int) + primitive_bounds.capacity () * sizeof(Aabb) + primitive_leaf.capacity () * sizeof(int);
+            }
+
+            const std::vector< Node > & get_nodes () const { return nodes; }
+
+            const Aabb & get_primitive_bounds (int primitive) const { return primitive_bounds[primitive]; }
+
+        private:
+
+            struct Build_Task
+            {
+                int node;
+                int begin;
+                int end;
+            };
+
+            ///Calcula la caja del nodo y, si conviene dividirlo, reparte sus primitivas y devuelve dónde se parten.
+            ///Devuelve -1 si el nodo debe quedar como hoja.
+            int split (Node & node, int begin, int end, const std::vector< Vector3f > & centers);
+
+            ///Construye entero el subárbol de una tarea en un array de nodos propio cuya raíz es el nodo 0
+            void build_subtree (const Build_Task & task, std::vector< Node > & subtree, const std::vector< Vector3f > & centers);
+        };
+
+        template< class TEST >
+        void Bvh::ray_cast (const Ray & ray, float max_distance, TEST && test) const
+        {
+            if (nodes.empty ()) return;
+
+            Vector3f inverse_direction(1.f / ray.direction.x, 1.f / ray.direction.y, 1.f / ray.direction.z);
+
+            float distance;
+
+            if (!nodes[0].bounds.intersects_ray (ray, inverse_direction, max_distance, distance)) return;
+
+            std::vector< int > stack;
+
+            stack.reserve (64);
+            stack.push_back (0);
+
+            while (!stack.empty ())
+            {
+                const Node & node = nodes[stack.back ()];
+
+                stack.pop_back ();
+
+                if (node.count > 0)
+                {
+                    for (int index = node.first, end = node.first + node.count; index < end; ++index)
+                    {
+                        test (order[index], max_distance);
+                    }
+
+                    continue;
+                }
+
+                // Se apila primero el hijo más lejano para visitar antes el cercano, que puede acortar max_distance:
+
+                float left_distance, right_distance;
+
+                bool left  = nodes[node.first    ].bounds.intersects_ray (ray, inverse_direction, max_distance, left_distance );
+                bool right = nodes[node.first + 1].bounds.intersects_ray (ray, inverse_direction, max_distance, right_distance);
+
+                if (left && right)
+                {
+                    bool left_first = left_distance <= right_distance;
+
+                    stack.push_back (left_first ? node.first + 1 : node.first    );
+                    stack.push_back (left_first ? node.first     : node.first + 1);
+                }
+                else
+                if (left ) stack.push_back (node.first    );
+                else
+                if (right) stack.push_back (node.first + 1);
+            }
+        }
+
+        ///Intersección rayo-triángulo (Möller-Trumbore). Devuelve true si el rayo corta el triángulo (por cualquiera de
+        ///sus caras) entre 0 y max_distance, y en distance el parámetro del punto de corte
+        inline bool intersect_triangle (const Ray & ray, const Vector3f & v0, const Vector3f & v1, const Vector3f & v2, float max_distance, float & distance)
+        {
+            Vector3f edge1 = v1 - v0;
+            Vector3f edge2 = v2 - v0;
+            Vector3f p     = glm::cross (ray.direction, edge2);
+            float    det   = glm::dot (edge1, p);
+
+            if (det == 0.f) return false;
+
+            float    inverse_det = 1.f / det;
+            Vector3f s           = ray.origin - v0;
+            float    u           = glm::dot (s, p) * inverse_det;
+
+            if (u < 0.f || u > 1.f) return false;
+
+            Vector3f q = glm::cross (s, edge1);
+            float    v = glm::dot (ray.direction, q) * inverse_det;
+
+            if (v < 0.f || u + v > 1.f) return false;
+
+            float t = glm::dot (edge2, q) * inverse_det;
+
+            if (t < 0.f || t >= max_distance) return false;
+
+            distance = t;
+
+            return true;
+        }
+
+    }
+
+#endif
@@ -0,0 +1,107 @@
+/**
+* @file Compact_Vertex.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda el formato comprimido de los vértices: posición cuantizada a 16 bits dentro de la caja del modelo
+* y normal codificada en octaedro con 8 bits por componente
+**/
+
+#ifndef COMPACT_VERTEX_HEADER
+#define COMPACT_VERTEX_HEADER
+
+    #include <cmath>
+    #include <cstdint>
+    #include "math.hpp"
+
+    namespace Engine
+    {
+
+        ///Vértice de 8 bytes frente a los 32 de una posición y una normal en Point4f
+        struct Compact_Vertex
+        {
+            uint16_t position[3];
+            uint8_t  normal  [2];
+        };
+
+        ///Codifica una normal proyectándola sobre un octaedro y desplegando la mitad inferior sobre la superior
+        inline void encode_octahedral (const Vector3f & normal, uint8_t encoded[2])
+        {
+            float length = std::fabs (normal.x) + std::fabs (normal.y) + std::fabs (normal.z);
+
+            float x = length > 0.f ? normal.x / length : 0.f;
+            float y = length > 0.f ? normal.y / length : 0.f;
+
+            if (length > 0.f && normal.z < 0.f)
+            {
+                float folded_x = (1.f - std::fabs (y)) * (x < 0.f ? -1.f : 1.f);
+                float folded_y = (1.f - std::fabs (x)) * (y < 0.f ? -1.f : 1.f);
+
+                x = folded_x;
+                y = folded_y;
+            }
+
+            encoded[0] = uint8_t(std::lround ((x * 0.5f + 0.5f) * 255.f));
+            encoded[1] = uint8_t(std::lround ((y * 0.5f + 0.5f) * 255.f));
+        }
+
+        ///Decodifica una normal del octaedro. No sale normalizada, ya que se normaliza después de transformarla
+        inline Vector3f decode_octahedral (const uint8_t encoded[2])
+        {
+            float x = float(encoded[0]) * (2.f / 255.f) - 1.f;
+            float y = float(encoded[1]) * (2.f / 255.f) - 1.f;
+            float z = 1.f - std::fabs (x) - std::fabs (y);
+
+            float fold = z < 0.f ? -z : 0.f;
+
+            x += x >= 0.f ? -fold : fold;
+            y += y >= 0.f ? -fold : fold;
+
+            return Vector3f(x, y, z);
+        }
+
+        ///Caja en la que se cuantizan las posiciones de un modelo
+        struct Vertex_Quantization
+        {
+            Vector3f minimum;
+            Vector3f step;                                  ///< Tamaño de cada paso de 16 bits en cada eje
+
+            Vertex_Quantization() : minimum(0.f, 0.f, 0.f), step(0.f, 0.f, 0.f)
+            {
+            }
+
+            Vertex_Quantization(const Vector3f & min_corner, const Vector3f & max_corner)
+            :
+                minimum(min_corner),
+                step   ((max_corner - min_corner) * (1.f / 65535.f))
+            {
+            }
+
+            ///Matriz que pasa de las coordenadas cuantizadas a espacio local. Al multiplicarla por la
+            ///transformación del modelo la decodificación no añade trabajo por vértice
+            Matrix44 dequantization () const
+            {
+                return scale (translate (Matrix44(1), minimum), step.x, step.y, step.z);
+            }
+
+            void encode (const Point4f & position, const Point4f & normal, Compact_Vertex & vertex) const
+            {
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    float steps = step[axis] > 0.f ? (position[axis] - minimum[axis]) / step[axis] : 0.f;
+
+                    steps = steps < 0.f ? 0.f : steps > 65535.f ? 65535.f : steps;
+
+                    vertex.position[axis] = uint16_t(std::lround (steps));
+                }
+
+                encode_octahedral (Vector3f(normal), vertex.normal);
+            }
+        };
+
+    }
+
+#endif
@@ -1,56 +1,713 @@
+/**
+* @file Convert_Function.cpp
+* Copyright (c) David Martn
+* @author David Martn Almazn
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que convierte por lotes los modelos de una carpeta o de un manifiesto al formato preprocesado del motor (.mesh),
+* en paralelo y saltndose los que no han cambiado desde la ltima conversin
+**/
+
 #include "Convert_Function.hpp"
-#include <Color_Buffer.hpp>
+#include "Baked_Mesh.hpp"
+#include "Mapped_File.hpp"
+#include "Memory_Tracker.hpp"
+#include "Obj_Loader.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <unordered_map>
 
 namespace Engine
 {
+    namespace fs = std::filesystem;
+
+    namespace
+    {
+        ///Cambia si cambia el resultado de la conversin, para que se vuelvan a convertir todos los modelos
+        const uint64_t converter_version = 1;
+
+        ///Archivo de la carpeta de salida donde se guarda el hash de cada modelo convertido
+        const char * const cache_name = "conversion_cache.txt";
+
+        ///Cuentas y bytes totales de un informe
+        struct Report_Totals
+        {
+            size_t   counts[3]    = { 0, 0, 0 };
+            uint64_t source_total = 0;
+            uint64_t target_total = 0;
+        };
+
+        ///Guarda el formato de nmeros de un stream y lo deja como estaba al destruirse, para que el informe no cambie
+        ///el de quien lo recibe (normalmente std::cout)
+        class Saved_Format
+        {
+            std::ostream          & stream;
+            std::ios_base::fmtflags flags;
+            std::streamsize         precision;
+
+        public:
+
+            Saved_Format(std::ostream & stream) : stream(stream), flags(stream.flags()), precision(stream.precision())
+            {
+            }
+
+           ~Saved_Format()
+            {
+                stream.flags    (flags);
+                stream.precision(precision);
+            }
+        };
+
+        ///Escribe una lnea por modelo con su estado, su tiempo y sus tamaos, y devuelve los totales
+        Report_Totals write_report(const vector< Conversion_Stats > & stats, const vector< std::string > & names, const char * const status_names[3], std::ostream & output)
+        {
+            Report_Totals totals;
+
+            output << std::fixed << std::setprecision(1);
+
+            for (size_t index = 0, number_of_sources = stats.size(); index < number_of_sources; ++index)
+            {
+                const Conversion_Stats & asset = stats[index];
+
+                totals.counts[asset.status]++;
+                totals.source_total += asset.source_bytes;
+                totals.target_total += asset.target_bytes;
+
+                output << status_names[asset.status]
+                       << std::setw(10) << asset.seconds * 1000.0 << " ms"
+                       << std::setw(12) << asset.source_bytes / 1024 << " KB ->"
+                       << std::setw(10) << asset.target_bytes / 1024 << " KB";
+
+                if (asset.status == Conversion_Stats::CONVERTED)
+                {
+                    output << std::setw(10) << asset.vertices << " v" << std::setw(10) << asset.triangles << " t" << std::setw(8) << asset.meshlets << " m";
+                }
+
+                output << "  " << names[index] << '\n';
+            }
+
+            return totals;
+        }
+
+        ///Nombre de cada modelo relativo a la carpeta base, que es con el que se guarda en la cach o en el paquete
+        vector< std::string > relative_names(const vector< std::string > & sources, const std::string & base)
+        {
+            vector< std::string > names(sources.size());
+
+            for (size_t index = 0; index < sources.size(); ++index)
+            {
+                fs::path relative = fs::path(sources[index]).lexically_relative(base.empty() ? fs::path(".") : fs::path(base));
+
+                if (relative.empty()) relative = fs::path(sources[index]).filename();
+
+                names[index] = relative.generic_string();
+            }
+
+            return names;
+        }
+    }
+
+    ///Aade a los buffers la malla id de la escena (solo sus tringulos)
 	void Convert_Function::Convert(const aiScene * scene, int id)
 	{
         auto mesh = scene->mMeshes[id];
 
+        if ((mesh->mPrimitiveTypes & aiPrimitiveType_TRIANGLE) == 0) return;
+
         size_t number_of_vertices = mesh->mNumVertices;
+        size_t first_vertex       = original_vertices.size();
 
-        // Se copian los datos de coordenadas de vrtices:
+        // Se copian los datos de coordenadas de vrtices y de normales:
 
-        original_vertices.resize(number_of_vertices);
+        original_vertices.resize(first_vertex + number_of_vertices);
+        original_normals .resize(first_vertex + number_of_vertices, Vertex(0.f, 0.f, 0.f, 0.f));
 
         for (size_t index = 0; index < number_of_vertices; index++)
         {
             auto& vertex = mesh->mVertices[index];
 
-            original_vertices[index] = Vertex(vertex.x, -vertex.y, vertex.z, 1.f);
+            original_vertices[first_vertex + index] = Vertex(vertex.x, -vertex.y, vertex.z, 1.f);
+
+            if (mesh->HasNormals())
+            {
+                auto& n = mesh->mNormals[index];
+                original_normals[first_vertex + index] = Vertex(n.x, n.y, n.z, 0.f);
+            }
         }
 
-        transformed_vertices.resize(number_of_vertices);
-        display_vertices.resize(number_of_vertices);
+        // Se generan los ndices de los tringulos. Con aiProcess_SortByPType las mallas de tringulos pueden
+        // seguir teniendo alguna cara degenerada de menos ndices, que se descarta:
 
-        // Se inicializan los datos de color de los vrtices con colores aleatorios:
+        size_t number_of_triangles = mesh->mNumFaces;
 
-        original_colors.resize(number_of_vertices);
+        original_indices.reserve(original_indices.size() + number_of_triangles * 3);
 
-        for (size_t index = 0; index < number_of_vertices; index++)
+        for (size_t index = 0; index < number_of_triangles; index++)
         {
-            original_colors[index].set(rand_clamp(), rand_clamp(), rand_clamp());
+            auto& face = mesh->mFaces[index];
+
+            if (face.mNumIndices != 3) continue;
+
+            original_indices.push_back(uint32_t(first_vertex + face.mIndices[0]));
+            original_indices.push_back(uint32_t(first_vertex + face.mIndices[1]));
+            original_indices.push_back(uint32_t(first_vertex + face.mIndices[2]));
         }
+	}
 
-        // Se generan los ndices de los tringulos:
+    ///Importa el archivo con el lector propio de OBJ o con Assimp
+    bool Convert_Function::Load(const std::string & path)
+    {
+        original_vertices.clear();
+        original_normals .clear();
+        original_indices .clear();
+        skinned = false;
 
-        size_t number_of_triangles = mesh->mNumFaces;
+        //Lo que ocupa el importador se cuenta desde antes de importar, estimado con el tamao del archivo hasta tener la escena
+        std::error_code error;
 
-        original_indices.resize(number_of_triangles * 3);
+        uintmax_t file_size = fs::file_size(path, error);
 
-        Index_Buffer::iterator indices_iterator = original_indices.begin();
+        Memory_Tracker::Scope importer_memory(Memory_Tracker::IMPORTERS, error ? 0 : size_t(file_size));
 
-        for (size_t index = 0; index < number_of_triangles; index++)
+        if (has_extension(path, ".obj") && load_obj(path, original_vertices, original_normals, original_indices))
         {
-            auto& face = mesh->mFaces[index];
+            return true;
+        }
+
+        Assimp::Importer importer;
+
+        const aiScene * scene = importer.ReadFile
+        (
+            path,
+            aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType | aiProcess_ImproveCacheLocality
+        );
+
+        if (!scene) return false;
+
+        //La escena de Assimp se cuenta como memoria del importador mientras se copia a los buffers
+        importer_memory.resize(assimp_scene_bytes(scene));
+
+        for (unsigned index = 0; index < scene->mNumMeshes; ++index)
+        {
+            Convert(scene, int(index));
+
+            skinned = skinned || scene->mMeshes[index]->HasBones();
+        }
+
+        //Al juntar las mallas los ndices tienen que seguir cabiendo en 32 bits, como en Index_Buffer
+        if (original_vertices.size() > Engine::Index_Buffer::max_count || original_indices.size() > Engine::Index_Buffer::max_count) return false;
 
-            assert(face.mNumIndices == 3);              // Una face puede llegar a tener de 1 a 4 ndices,
-                                                        // pero nos interesa que solo haya tringulos
-            auto indices = face.mIndices;
+        return !original_indices.empty();
+    }
 
-            *indices_iterator++ = int(indices[0]);
-            *indices_iterator++ = int(indices[1]);
-            *indices_iterator++ = int(indices[2]);
+    ///Devuelve la memoria que ocupan los buffers del archivo que se est convirtiendo
+    size_t Convert_Function::Buffer_Bytes() const
+    {
+        return bytes_of(original_vertices) + bytes_of(original_normals) + bytes_of(original_indices) + bytes_of(meshlets);
+    }
+
+    ///Quita los tringulos degenerados y genera normales suavizadas si el modelo no trae
+    void Convert_Function::Optimize()
+    {
+        // Se quitan los tringulos con vrtices repetidos o sin rea, que nunca llegan a pintarse:
+
+        size_t kept = 0;
+
+        for (size_t index = 0, number_of_indices = original_indices.size(); index < number_of_indices; index += 3)
+        {
+            uint32_t i0 = original_indices[index], i1 = original_indices[index + 1], i2 = original_indices[index + 2];
+
+            if (i0 == i1 || i1 == i2 || i0 == i2) continue;
+
+            Vector3f v0 = Vector3f(original_vertices[i0]);
+            Vector3f e1 = Vector3f(original_vertices[i1]) - v0;
+            Vector3f e2 = Vector3f(original_vertices[i2]) - v0;
+
+            Vector3f area = glm::cross(e1, e2);
+
+            if (area.x == 0.f && area.y == 0.f && area.z == 0.f) continue;
+
+            original_indices[kept++] = i0;
+            original_indices[kept++] = i1;
+            original_indices[kept++] = i2;
         }
-	}
-}
\ No newline at end of file
+
+        original_indices.resize(kept);
+
+        // Si no hay ninguna normal se generan sumando la normal de cada cara (ponderada por su rea) en sus vrtices.
+        // Se calculan con la Y del archivo, que es como se guardan las normales importadas:
+
+        bool has_normals = std::any_of(original_normals.begin(), original_normals.end(), [] (const Vertex & n) { return n.x != 0.f || n.y != 0.f || n.z != 0.f; });
+
+        if (has_normals) return;
+
+        original_normals.assign(original_vertices.size(), Vertex(0.f, 0.f, 0.f, 0.f));
+
+        auto file_position = [this] (uint32_t index)
+        {
+            const Vertex & vertex = original_vertices[index];
+
+            return Vector3f(vertex.x, -vertex.y, vertex.z);
+        };
+
+        for (size_t index = 0, number_of_indices = original_indices.size(); index < number_of_indices; index += 3)
+        {
+            const uint32_t * triangle = &original_indices[index];
+
+            Vector3f v0 = file_position(triangle[0]);
+            Vector3f face_normal = glm::cross(file_position(triangle[1]) - v0, file_position(triangle[2]) - v0);
+
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                original_normals[triangle[corner]] += Vertex(face_normal, 0.f);
+            }
+        }
+
+        for (Vertex & n : original_normals)
+        {
+            float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+            if (length > 0.f) n *= 1.f / length;
+        }
+    }
+
+    ///Divide el modelo en meshlets y lo escribe en formato .mesh
+    bool Convert_Function::Write(const std::string & target)
+    {
+        build_meshlets(original_vertices, original_normals, original_indices, meshlets);
+
+        // Se escribe en un archivo temporal y se renombra al terminar, para que una conversin interrumpida
+        // no deje un .mesh a medias que la siguiente dara por bueno:
+
+        std::string temporary = target + ".tmp";
+
+        Baked_Mesh_Writer writer;
+
+        if (!writer.open(temporary)) return false;
+
+        int local_indices[Meshlet::max_triangles * 3];
+
+        for (const Meshlet & meshlet : meshlets)
+        {
+            for (uint32_t index = 0; index < meshlet.index_count; ++index)
+            {
+                local_indices[index] = int(original_indices[meshlet.index_offset + index] - meshlet.vertex_offset);
+            }
+
+            if (!writer.write(&original_vertices[meshlet.vertex_offset], &original_normals[meshlet.vertex_offset], int(meshlet.vertex_count), local_indices, int(meshlet.index_count)))
+            {
+                writer.close();
+                std::remove(temporary.c_str());
+                return false;
+            }
+        }
+
+        if (!writer.close()) return false;
+
+        std::error_code error;
+
+        fs::rename(temporary, target, error);
+
+        return !error;
+    }
+
+    ///Importa, optimiza y divide en meshlets un archivo para guardarlo en un paquete de assets
+    bool Convert_Function::Prepare(const std::string & source, Packed_Mesh & mesh)
+    {
+        if (!Load(source)) return false;
+
+        Optimize();
+
+        if (original_indices.empty()) return false;
+
+        //Los buffers del conversor son memoria del importador hasta que pasan al paquete
+        Memory_Tracker::Scope buffer_memory(Memory_Tracker::IMPORTERS, Buffer_Bytes());
+
+        // La caja y la esfera se calculan como en Model::Load, antes de que los meshlets dupliquen vrtices:
+
+        Vector3f min_corner = Vector3f(original_vertices[0]);
+        Vector3f max_corner = min_corner;
+
+        for (const Vertex & vertex : original_vertices)
+        {
+            min_corner = glm::min(min_corner, Vector3f(vertex));
+            max_corner = glm::max(max_corner, Vector3f(vertex));
+        }
+
+        Vector3f center = (min_corner + max_corner) * 0.5f;
+        float    radius = 0.f;
+
+        for (const Vertex & vertex : original_vertices)
+        {
+            radius = glm::max(radius, glm::distance(center, Vector3f(vertex)));
+        }
+
+        build_meshlets(original_vertices, original_normals, original_indices, meshlets);
+
+        mesh.indices.assign(original_indices, original_vertices.size());
+        mesh.vertices.swap(original_vertices);
+        mesh.normals .swap(original_normals );
+        mesh.meshlets        = meshlets;
+        mesh.bounding_sphere = Vector4f(center, radius);
+        mesh.min_corner      = min_corner;
+        mesh.max_corner      = max_corner;
+
+        return true;
+    }
+
+    ///Hace todo el proceso de un archivo y rellena sus estadsticas
+    bool Convert_Function::Convert_File(const std::string & source, const std::string & target, Conversion_Stats & stats)
+    {
+        if (!Load(source)) return false;
+
+        Optimize();
+
+        Memory_Tracker::Scope buffer_memory(Memory_Tracker::IMPORTERS, Buffer_Bytes());
+
+        if (original_indices.empty() || !Write(target)) return false;
+
+        std::error_code error;
+
+        stats.target_bytes = fs::file_size(target, error);
+        stats.vertices     = original_vertices.size();
+        stats.triangles    = original_indices.size() / 3;
+        stats.meshlets     = meshlets.size();
+
+        return true;
+    }
+
+    ///Devuelve los modelos que hay que convertir: los de la carpeta (recursivamente) o los que lista el manifiesto
+    vector< std::string > collect_conversion_sources(const std::string & input, std::string & base)
+    {
+        vector< std::string > sources;
+
+        std::error_code error;
+
+        if (fs::is_directory(input, error))
+        {
+            base = input;
+
+            Assimp::Importer importer;
+
+            for (fs::recursive_directory_iterator iterator(input, error), end; !error && iterator != end; iterator.increment(error))
+            {
+                if (!iterator->is_regular_file(error)) continue;
+
+                std::string extension = iterator->path().extension().string();
+
+                if (extension.empty() || has_extension(extension, ".mesh") || !importer.IsExtensionSupported(extension)) continue;
+
+                sources.push_back(iterator->path().string());
+            }
+
+            // Se ordenan para que el informe salga siempre igual:
+
+            std::sort(sources.begin(), sources.end());
+        }
+        else
+        {
+            base = fs::path(input).parent_path().string();
+
+            std::ifstream manifest(input);
+            std::string   line;
+
+            while (std::getline(manifest, line))
+            {
+                line.erase(0, line.find_first_not_of(" \t"));
+                line.erase(line.find_last_not_of(" \t\r") + 1);
+
+                if (line.empty() || line[0] == '#') continue;
+
+                sources.push_back((fs::path(base) / line).string());
+            }
+        }
+
+        return sources;
+    }
+
+    ///Hash FNV-1a de 64 bits del contenido de un archivo. Devuelve false si no se puede leer
+    bool hash_file_contents(const std::string & path, uint64_t & hash)
+    {
+        Mapped_File file;
+
+        if (!file.open(path)) return false;
+
+        hash = 14695981039346656037ull;
+
+        const unsigned char * data = reinterpret_cast< const unsigned char * >(file.data());
+
+        for (size_t index = 0, size = file.size(); index < size; ++index)
+        {
+            hash = (hash ^ data[index]) * 1099511628211ull;
+        }
+
+        hash = (hash ^ converter_version) * 1099511628211ull;
+
+        return true;
+    }
+
+    ///Memoria aproximada que ocupa una escena de Assimp (vrtices, normales y caras), para contarla mientras se importa
+    size_t assimp_scene_bytes(const aiScene * scene)
+    {
+        size_t bytes = 0;
+
+        for (unsigned index = 0; scene && index < scene->mNumMeshes; ++index)
+        {
+            bytes += size_t(scene->mMeshes[index]->mNumVertices) * sizeof(aiVector3D) * (scene->mMeshes[index]->HasNormals() ? 2 : 1);
+            bytes += size_t(scene->mMeshes[index]->mNumFaces) * (sizeof(aiFace) + 3 * sizeof(unsigned));
+        }
+
+        return bytes;
+    }
+
+    ///Convierte en paralelo los modelos de input en output_directory y escribe el informe en output
+    int run_batch_conversion(const std::string & input, const std::string & output_directory, std::ostream & output)
+    {
+        using clock = std::chrono::steady_clock;
+
+        clock::time_point start = clock::now();
+
+        std::string           base;
+        vector< std::string > sources = collect_conversion_sources(input, base);
+
+        // Se lee el hash que tena cada modelo en la ltima conversin:
+
+        std::unordered_map< std::string, uint64_t > cache;
+
+        fs::path cache_path = fs::path(output_directory) / cache_name;
+
+        {
+            std::ifstream cache_file(cache_path);
+            std::string   hash, name;
+
+            while (cache_file >> hash && std::getline(cache_file >> std::ws, name))
+            {
+                cache[name] = std::strtoull(hash.c_str(), nullptr, 16);
+            }
+        }
+
+        // Cada modelo se convierte en un hilo. Los que tienen el mismo hash y siguen teniendo su .mesh se saltan:
+
+        size_t number_of_sources = sources.size();
+
+        vector< Conversion_Stats > stats(number_of_sources);
+        vector< std::string      > names = relative_names(sources, base);
+        vector< uint64_t         > hashes(number_of_sources, 0);
+
+        for (size_t index = 0; index < number_of_sources; ++index)
+        {
+            stats[index].source = sources[index];
+            stats[index].target = (fs::path(output_directory) / names[index]).replace_extension(".mesh").string();
+        }
+
+        // Dos modelos que solo se diferencian en la extensin (a.obj y a.fbx) iran al mismo .mesh, y cul quedase
+        // dependera del orden de los hilos. No se convierte ninguno de los dos:
+
+        vector< bool > collides(number_of_sources, false);
+
+        {
+            std::unordered_map< std::string, size_t > first_source;
+
+            for (size_t index = 0; index < number_of_sources; ++index)
+            {
+                auto inserted = first_source.emplace(stats[index].target, index);
+
+                if (!inserted.second)
+                {
+                    size_t first = inserted.first->second;
+
+                    collides[first] = collides[index] = true;
+
+                    output << "Colisin: " << names[first] << " y " << names[index] << " se convierten los dos en " << stats[index].target << '\n';
+                }
+            }
+        }
+
+        parallel_for(number_of_sources, [&] (size_t index)
+        {
+            Conversion_Stats & asset = stats[index];
+
+            if (collides[index]) return;
+
+            clock::time_point asset_start = clock::now();
+
+            std::error_code error;
+
+            asset.source_bytes = fs::file_size(asset.source, error);
+
+            if (!hash_file_contents(asset.source, hashes[index])) return;
+
+            auto cached = cache.find(names[index]);
+
+            if (cached != cache.end() && cached->second == hashes[index] && fs::exists(asset.target, error))
+            {
+                asset.status       = Conversion_Stats::SKIPPED;
+                asset.target_bytes = fs::file_size(asset.target, error);
+            }
+            else
+            {
+                fs::create_directories(fs::path(asset.target).parent_path(), error);
+
+                Convert_Function converter;
+
+                asset.status = converter.Convert_File(asset.source, asset.target, asset) ? Conversion_Stats::CONVERTED : Conversion_Stats::FAILED;
+            }
+
+            asset.seconds = std::chrono::duration< double >(clock::now() - asset_start).count();
+        });
+
+        // Se guarda la cach con los modelos convertidos o saltados (los que fallan se reintentan la prxima vez):
+
+        for (size_t index = 0; index < number_of_sources; ++index)
+        {
+            if (stats[index].status == Conversion_Stats::FAILED) cache.erase(names[index]);
+            else                                                 cache[names[index]] = hashes[index];
+        }
+
+        {
+            std::error_code error;
+
+            fs::create_directories(output_directory, error);
+
+            std::ofstream cache_file(cache_path.string() + ".tmp");
+
+            for (const auto & entry : cache)
+            {
+                cache_file << std::hex << std::setw(16) << std::setfill('0') << entry.second << ' ' << entry.first << '\n';
+            }
+
+            cache_file.close();
+
+            fs::rename(cache_path.string() + ".tmp", cache_path, error);
+        }
+
+        // Informe por modelo y total:
+
+        const char * const status_names[] = { "converted", "skipped  ", "FAILED   " };
+
+        Saved_Format saved_format(output);
+
+        Report_Totals totals = write_report(stats, names, status_names, output);
+
+        double seconds = std::chrono::duration< double >(clock::now() - start).count();
+
+        output << number_of_sources << " assets: " << totals.counts[Conversion_Stats::CONVERTED] << " converted, "
+               << totals.counts[Conversion_Stats::SKIPPED] << " skipped, " << totals.counts[Conversion_Stats::FAILED] << " failed; "
+               << totals.source_total / 1024 << " KB -> " << totals.target_total / 1024 << " KB in " << seconds << " s on "
+               << worker_count() << " threads\n";
+
+        return int(totals.counts[Conversion_Stats::FAILED]);
+    }
+
+    ///Prepara y comprime en paralelo los modelos de input y los guarda en el paquete pack
+    int build_asset_pack(const std::string & input, const std::string & pack, std::ostream & output)
+    {
+        using clock = std::chrono::steady_clock;
+
+        clock::time_point start = clock::now();
+
+        std::string           base;
+        vector< std::string > sources = collect_conversion_sources(input, base);
+
+        size_t number_of_sources = sources.size();
+
+        vector< Conversion_Stats > stats(number_of_sources);
+        vector< std::string      > names = relative_names(sources, base);
+        vector< Compressed_Asset > assets(number_of_sources);
+
+        // Cada modelo se prepara y se comprime en un hilo. Los que tienen huesos se saltan porque el paquete no guarda
+        // esqueletos, y se siguen leyendo de su archivo:
+
+        parallel_for(number_of_sources, [&] (size_t index)
+        {
+            Conversion_Stats & asset = stats[index];
+
+            clock::time_point asset_start = clock::now();
+
+            std::error_code error;
+
+            asset.source       = sources[index];
+            asset.target       = pack;
+            asset.source_bytes = fs::file_size(asset.source, error);
+
+            Convert_Function converter;
+            Packed_Mesh      mesh;
+
+            if (converter.Prepare(asset.source, mesh))
+            {
+                if (converter.Is_Skinned())
+                {
+                    asset.status = Conversion_Stats::SKIPPED;
+                }
+                else
+                {
+                    assets[index] = compress_asset(mesh);
+
+                    asset.status       = Conversion_Stats::CONVERTED;
+                    asset.target_bytes = assets[index].compressed_bytes();
+                    asset.vertices     = mesh.vertices.size();
+                    asset.triangles    = mesh.indices .size() / 3;
+                    asset.meshlets     = mesh.meshlets.size();
+                }
+            }
+
+            asset.seconds = std::chrono::duration< double >(clock::now() - asset_start).count();
+        });
+
+        // Se escriben en el orden de la lista en un archivo temporal que se renombra al terminar, igual que los .mesh:
+
+        std::string temporary = pack + ".tmp";
+
+        Asset_Pack_Writer writer;
+
+        bool written = writer.open(temporary);
+
+        for (size_t index = 0; index < number_of_sources; ++index)
+        {
+            if (stats[index].status != Conversion_Stats::CONVERTED) continue;
+
+            written = written && writer.add(names[index], assets[index]);
+
+            Compressed_Asset().blocks.swap(assets[index].blocks);
+        }
+
+        written = writer.close() && written;
+
+        std::error_code error;
+
+        if (written) fs::rename(temporary, pack, error);
+
+        if (!written || error)
+        {
+            std::remove(temporary.c_str());
+
+            output << "No se puede escribir " << pack << '\n';
+
+            return int(number_of_sources) + 1;
+        }
+
+        const char * const status_names[] = { "packed   ", "skinned  ", "FAILED   " };
+
+        Saved_Format saved_format(output);
+
+        Report_Totals totals = write_report(stats, names, status_names, output);
+
+        double seconds = std::chrono::duration< double >(clock::now() - start).count();
+
+        output << number_of_sources << " assets: " << totals.counts[Conversion_Stats::CONVERTED] << " packed, "
+               << totals.counts[Conversion_Stats::SKIPPED] << " skinned, " << totals.counts[Conversion_Stats::FAILED] << " failed; "
+               << totals.source_total / 1024 << " KB -> " << fs::file_size(pack, error) / 1024 << " KB in " << seconds << " s on "
+               << worker_count() << " threads\n";
+
+        return int(totals.counts[Conversion_Stats::FAILED]);
+    }
+}
@@ -1,48 +1,99 @@
+/**
+* @file Convert_Function.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que convierte por lotes los modelos de una carpeta o de un manifiesto al formato preprocesado del motor (.mesh),
+* en paralelo y saltándose los que no han cambiado desde la última conversión
+**/
+
 #pragma once
 #include "math.hpp"
+#include "Meshlet.hpp"
+#include "Asset_Pack.hpp"
 #include <vector>
-#include <cassert>
+#include <string>
+#include <iostream>
+#include <cstdint>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
-#include <Color_Buffer.hpp>
-#include <cstdlib>
-#include "Rasterizer.hpp"
-
 using namespace std;
 
 namespace Engine
 {
-	using argb::Rgb888;
-	using argb::Color_Buffer;
+	///Resultado de convertir un modelo, para el informe del lote
+	struct Conversion_Stats
+	{
+		enum Status { CONVERTED, SKIPPED, FAILED };
+
+		std::string source;
+		std::string target;
+		Status      status       = FAILED;
+		double      seconds      = 0.0;
+		uint64_t    source_bytes = 0;
+		uint64_t    target_bytes = 0;
+		size_t      vertices     = 0;
+		size_t      triangles    = 0;
+		size_t      meshlets     = 0;
+	};
 
+	///Convierte un modelo: lo importa, lo triangula, quita los triángulos degenerados, calcula las normales si no tiene,
+	///lo divide en meshlets con sus volúmenes envolventes y lo escribe como .mesh. Cada hilo usa su propio objeto.
 	class Convert_Function
 	{
 	private:
 		typedef Point4f               Vertex;
 		typedef vector< Vertex >      Vertex_Buffer;
-
-		typedef Rgb888                Color;
-		typedef Point4f               Vertex;
-		typedef vector< Vertex >      Vertex_Buffer;
-		typedef vector< int    >      Index_Buffer;
-		typedef vector< Color  >      Vertex_Colors;
-
+		typedef vector< uint32_t >    Index_Buffer;
 
 		Vertex_Buffer     original_vertices;
+		Vertex_Buffer     original_normals;
 		Index_Buffer      original_indices;
-		Vertex_Colors     original_colors;
-		Vertex_Buffer     transformed_vertices;
-		vector< Point4i > display_vertices;
-
+		vector< Meshlet > meshlets;
+		bool              skinned = false;		///< Alguna malla tiene huesos, que no se guardan
 
 	public:
 		Convert_Function() {};
+		///Añade a los buffers la malla id de la escena (solo sus triángulos)
 		void Convert(const aiScene*, int);
-		float rand_clamp() { return float(rand() & 0xff) * 0.0039215f; }
+		///Importa el archivo con el lector propio de OBJ o con Assimp
+		bool Load(const std::string&);
+		///Quita los triángulos degenerados y genera normales suavizadas si el modelo no trae
+		void Optimize();
+		///Divide el modelo en meshlets y lo escribe en formato .mesh
+		bool Write(const std::string&);
+		///Hace todo el proceso de un archivo y rellena sus estadísticas
+		bool Convert_File(const std::string&, const std::string&, Conversion_Stats&);
+		///Importa, optimiza y divide en meshlets un archivo para guardarlo en un paquete de assets
+		bool Prepare(const std::string&, Packed_Mesh&);
+		///Devuelve true si el último archivo importado tenía huesos
+		bool Is_Skinned() const { return skinned; }
+		///Devuelve la memoria que ocupan los buffers del archivo que se está convirtiendo
+		size_t Buffer_Bytes() const;
 	};
-}
 
+	///Devuelve los modelos que hay que convertir: los de la carpeta (recursivamente) o los que lista el manifiesto
+	///(una ruta por línea, relativa al manifiesto; las líneas que empiezan por # se ignoran). En base se devuelve la
+	///carpeta respecto a la que se calculan las rutas de salida.
+	vector< std::string > collect_conversion_sources(const std::string& input, std::string& base);
+
+	///Hash FNV-1a de 64 bits del contenido de un archivo. Devuelve false si no se puede leer
+	bool hash_file_contents(const std::string& path, uint64_t& hash);
 
+	///Memoria aproximada que ocupa una escena de Assimp (vértices, normales y caras), para contarla mientras se importa
+	size_t assimp_scene_bytes(const aiScene* scene);
+
+	///Convierte en paralelo los modelos de input en output_directory y escribe el informe en output.
+	///Devuelve el número de modelos que no se han podido convertir.
+	int run_batch_conversion(const std::string& input, const std::string& output_directory, std::ostream& output = std::cout);
+
+	///Prepara y comprime en paralelo los modelos de input y los guarda en el paquete pack, con los nombres relativos
+	///a la carpeta de input. Escribe el informe en output y devuelve el número de modelos que no se han podido guardar.
+	int build_asset_pack(const std::string& input, const std::string& pack, std::ostream& output = std::cout);
+}
@@ -0,0 +1,184 @@
+/**
+* @file Depth_Format.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda los formatos del z-buffer que puede usar el rasterizer (32 bits entero, 16 y 24 bits normalizados
+* y float de 32 bits con la z invertida) y cómo se pasa a cada uno la profundidad de los vértices
+**/
+
+#ifndef DEPTH_FORMAT_HEADER
+#define DEPTH_FORMAT_HEADER
+
+    #include <cstdint>
+    #include <cstring>
+    #include <limits>
+    #include "math.hpp"
+
+    namespace Engine
+    {
+
+        ///Planos near y far de una proyección en perspectiva, de los que sale la profundidad que se guarda
+        struct Depth_Range
+        {
+            float near_plane = 1.f;
+            float far_plane  = 2.f;
+
+            ///Los saca de una matriz de glm::perspective, que deja -(f + n) / (f - n) y -2fn / (f - n) en la columna z
+            static Depth_Range from_projection (const Matrix44 & projection)
+            {
+                Depth_Range range;
+
+                range.near_plane = projection[3][2] / (projection[2][2] - 1.f);
+                range.far_plane  = projection[3][2] / (projection[2][2] + 1.f);
+
+                return range;
+            }
+
+            ///Lleva la z de NDC a [0, 1) desde near hasta el infinito, lo que vale 1 - near / distancia. No se corta
+            ///en far porque la escena pinta modelos más lejos.
+            float normalize (float ndc_z) const
+            {
+                float depth = (ndc_z + 1.f) * (far_plane - near_plane) / (2.f * far_plane);
+
+                return depth < 0.f ? 0.f : depth < 1.f ? depth : 1.f;
+            }
+        };
+
+        // Cada formato dice qué se guarda por píxel (Value) y qué se interpola por los lados y la scanline
+        // (Interpolated), que siempre es lineal en pantalla. encode deja en la z entera de los vértices de pantalla
+        // lo que luego lee from_vertex, y distance_key la convierte en un entero que crece con la distancia para
+        // ordenar. Los vértices llegan ya divididos por w, junto con 1 / w.
+
+        ///El formato de siempre: la z de NDC por 10^8 en un int. Es el predeterminado porque las imágenes de
+        ///referencia se generaron con él.
+        struct Depth_32
+        {
+            typedef int32_t Value;
+            typedef int32_t Interpolated;
+
+            static int32_t      encode       (float ndc_z, float, const Depth_Range &) { return int32_t(ndc_z * 100000000.f); }
+            static Interpolated from_vertex  (int32_t z)                     { return z; }
+            static int32_t      distance_key (int32_t z)                     { return z; }
+
+            static Value        clear_value  ()                              { return std::numeric_limits< int32_t >::max (); }
+            static bool         is_clear     (Value value)                   { return value == clear_value (); }
+            static bool         closer       (Interpolated z, Value old)     { return z < old; }
+            static Value        store        (Interpolated z)                { return z; }
+        };
+
+        ///Profundidad normalizada en 16 bits, la mitad de tráfico que Depth_32. Se interpola con 30 bits de
+        ///fracción y solo se redondea al guardar.
+        struct Depth_16
+        {
+            typedef uint16_t Value;
+            typedef int32_t  Interpolated;
+
+            static constexpr int fraction_bits = 30;
+
+            static int32_t      encode       (float ndc_z, float, const Depth_Range & range) { return int32_t(range.normalize (ndc_z) * float((1 << fraction_bits) - 64)); }
+            static Interpolated from_vertex  (int32_t z)                     { return z; }
+            static int32_t      distance_key (int32_t z)                     { return z; }
+
+            static Value        clear_value  ()                              { return 0xffff; }
+            static bool         is_clear     (Value value)                   { return value == clear_value (); }
+            static bool         closer       (Interpolated z, Value old)     { return store (z) < old; }
+            static Value        store        (Interpolated z)                { return Value(z >> (fraction_bits - 16)); }
+        };
+
+        ///Profundidad normalizada en 24 bits empaquetada en tres bytes por píxel
+        struct Depth_24
+        {
+            struct Value
+            {
+                uint8_t bytes[3];
+            };
+
+            typedef int32_t Interpolated;
+
+            static constexpr int fraction_bits = 30;
+
+            static int32_t      encode       (float ndc_z, float, const Depth_Range & range) { return int32_t(range.normalize (ndc_z) * float((1 << fraction_bits) - 64)); }
+            static Interpolated from_vertex  (int32_t z)                     { return z; }
+            static int32_t      distance_key (int32_t z)                     { return z; }
+
+            static Value        clear_value  ()                              { return Value{ { 0xff, 0xff, 0xff } }; }
+            static bool         is_clear     (Value value)                   { return load (value) == 0xffffffu; }
+            static bool         closer       (Interpolated z, Value old)     { return uint32_t(z >> (fraction_bits - 24)) < load (old); }
+
+            static Value store (Interpolated z)
+            {
+                uint32_t depth = uint32_t(z >> (fraction_bits - 24));
+
+                return Value{ { uint8_t(depth), uint8_t(depth >> 8), uint8_t(depth >> 16) } };
+            }
+
+            static uint32_t load (Value value)
+            {
+                return uint32_t(value.bytes[0]) | uint32_t(value.bytes[1]) << 8 | uint32_t(value.bytes[2]) << 16;
+            }
+        };
+
+        static_assert (sizeof(Depth_24::Value) == 3, "Depth_24 debe ocupar tres bytes por píxel");
+
+        ///Float de 32 bits con la z invertida: se guarda near / distancia, que vale 1 en near y tiende a 0 lejos.
+        ///Los float tienen más precisión cerca de 0, justo donde la proyección junta las distancias, por lo que la
+        ///precisión queda casi igual en toda la escena. Se calcula con 1 / w en lugar de con la z de NDC para no
+        ///perder esa precisión.
+        struct Depth_32f_Reversed
+        {
+            typedef float Value;
+            typedef float Interpolated;
+
+            static int32_t encode (float, float inverse_w, const Depth_Range & range)
+            {
+                float   depth = range.near_plane * inverse_w;
+                int32_t bits;
+
+                std::memcpy (&bits, &depth, sizeof(bits));
+
+                return bits;
+            }
+
+            static Interpolated from_vertex (int32_t z)
+            {
+                float depth;
+
+                std::memcpy (&depth, &z, sizeof(depth));
+
+                return depth;
+            }
+
+            ///Los bits de un float positivo crecen con su valor, y aquí más valor es más cerca
+            static int32_t      distance_key (int32_t z)                     { return -z; }
+
+            static Value        clear_value  ()                              { return 0.f; }
+            static bool         is_clear     (Value value)                   { return value == 0.f; }
+            static bool         closer       (Interpolated z, Value old)     { return z > old; }
+            static Value        store        (Interpolated z)                { return z; }
+        };
+
+        //El formato de la escena se elige al compilar, por ejemplo con -DENGINE_DEPTH_FORMAT=Depth_16
+        #ifndef ENGINE_DEPTH_FORMAT
+            #define ENGINE_DEPTH_FORMAT Depth_32
+        #endif
+
+        typedef ENGINE_DEPTH_FORMAT Scene_Depth_Format;
+
+        ///Pasa a pantalla un vértice dividido por w: x e y con la matriz de pantalla y la z con el formato dado
+        template< class DEPTH_FORMAT >
+        inline Point4i to_screen (const Matrix44 & screen_transformation, const Point4f & vertex, float inverse_w, const Depth_Range & range)
+        {
+            Point4i screen = Point4i(screen_transformation * Point4f(vertex.x, vertex.y, vertex.z, 1.f));
+
+            screen.z = DEPTH_FORMAT::encode (vertex.z, inverse_w, range);
+
+            return screen;
+        }
+
+    }
+
+#endif
@@ -0,0 +1,84 @@
+/**
+* @file Frame_Pipeline.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que solapa el update del frame siguiente (como un trabajo del sistema de trabajos) con el render del frame actual (en el hilo principal)
+**/
+
+#include "Frame_Pipeline.hpp"
+#include "View.hpp"
+#include "Hot_Reload.hpp"
+#include "Resolution_Controller.hpp"
+#include "Stats.hpp"
+#include <chrono>
+
+namespace Engine
+{
+    Frame_Pipeline::Frame_Pipeline(View & given_view, Hot_Reload * given_hot_reload, Resolution_Controller * given_resolution)
+    :
+        view      (given_view      ),
+        hot_reload(given_hot_reload),
+        resolution(given_resolution)
+    {
+    }
+
+    Frame_Pipeline::~Frame_Pipeline()
+    {
+        if (update) Job_System::instance ().wait (update);
+    }
+
+    ///Ejecuta un frame. Se llama desde el hilo principal, que es el que pinta.
+    void Frame_Pipeline::run_frame ()
+    {
+        Job_System & jobs = Job_System::instance ();
+
+        // En el primer frame todavía no hay ningún update terminado, así que se hace aquí mismo:
+
+        if (!update)
+        {
+            view.update ();
+        }
+        else
+        {
+            jobs.wait (update);
+        }
+
+        // El frame de estadísticas se cierra con el update terminado. Si se cerrase después del render, el update que
+        // corre a la vez caería en uno u otro frame según cuándo terminase. Así cada frame tiene un update entero, el
+        // que acaba de terminar, y el render anterior:
+
+        ENGINE_STATS_END_FRAME();
+        ENGINE_STATS_BEGIN_FRAME();
+
+        // Con nadie leyendo ni escribiendo los modelos se cambian los que se han vuelto a cargar:
+
+        if (hot_reload) hot_reload->apply ();
+
+        // Con el update terminado, el resultado pasa al render y se lanza el siguiente con la cámara actual:
+
+        view.swap_frames ();
+
+        Matrix44 camera = view.camera->transformation;
+
+        update = jobs.submit ([this, camera] { view.update (camera); });
+
+        // Mientras los demás hilos transforman el frame siguiente, se pinta este:
+
+        auto render_begin = std::chrono::steady_clock::now ();
+
+        view.render ();
+
+        // La escala que elija el control de resolución se aplica al update que se lance en el próximo frame:
+
+        if (resolution)
+        {
+            float milliseconds = std::chrono::duration< float, std::milli >(std::chrono::steady_clock::now () - render_begin).count ();
+
+            view.set_render_scale (resolution->next_scale (milliseconds));
+        }
+    }
+}
@@ -0,0 +1,57 @@
+/**
+* @file Frame_Pipeline.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que solapa el update del frame siguiente (en un hilo propio) con el render del frame actual (en el hilo principal)
+**/
+
+#ifndef FRAME_PIPELINE_HEADER
+#define FRAME_PIPELINE_HEADER
+
+    #include "Job_System.hpp"
+
+    namespace Engine
+    {
+
+        class View;
+        class Hot_Reload;
+        class Resolution_Controller;
+
+        ///Cada llamada a run_frame espera al update lanzado en la llamada anterior, intercambia los buffers de los
+        ///modelos, lanza el update del frame siguiente y pinta el que acaba de terminar. Lo que se ve en pantalla
+        ///va siempre exactamente un frame por detrás de la cámara.
+        ///El update es un trabajo más del sistema de trabajos, así que sus bucles paralelos y los del render comparten
+        ///los mismos hilos.
+        class Frame_Pipeline
+        {
+            View &                  view;
+
+            ///Update del frame siguiente, o nullptr si todavía no se ha lanzado ninguno
+            Job_System::Job_Handle  update;
+
+            ///Recarga de los archivos que cambian, o nullptr. Los modelos recargados se cambian entre dos frames.
+            Hot_Reload *            hot_reload;
+
+            ///Control de la resolución interna, o nullptr. Recibe el tiempo de cada render y fija la escala de los
+            ///updates siguientes.
+            Resolution_Controller * resolution;
+
+        public:
+
+            Frame_Pipeline(View &, Hot_Reload * = nullptr, Resolution_Controller * = nullptr);
+           ~Frame_Pipeline();
+
+            Frame_Pipeline(const Frame_Pipeline &) = delete;
+            Frame_Pipeline & operator = (const Frame_Pipeline &) = delete;
+
+            ///Ejecuta un frame. Se llama desde el hilo principal, que es el que pinta.
+            void run_frame ();
+        };
+
+    }
+
+#endif
@@ -0,0 +1,104 @@
+/**
+* @file Frustum.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda los planos del volumen de visión de la cámara y los tests de esferas y cajas contra ellos
+**/
+
+#ifndef FRUSTUM_HEADER
+#define FRUSTUM_HEADER
+
+    #include "math.hpp"
+
+    namespace Engine
+    {
+
+        struct Frustum
+        {
+            ///Planos izquierdo, derecho, inferior, superior y cercano, en espacio de cámara y normalizados.
+            ///No se usa el plano lejano porque el rasterizer pinta todo lo que queda detrás de él (el fondo está en z=-100).
+            static constexpr int number_of_planes = 5;
+
+            Vector4f planes[number_of_planes];
+
+        public:
+
+            ///Extrae los planos de una matriz de proyección (Gribb-Hartmann)
+            static Frustum from_projection (const Matrix44 & projection)
+            {
+                auto row = [&projection] (int i)
+                {
+                    return Vector4f(projection[0][i], projection[1][i], projection[2][i], projection[3][i]);
+                };
+
+                Frustum frustum;
+
+                frustum.planes[0] = row (3) + row (0);
+                frustum.planes[1] = row (3) - row (0);
+                frustum.planes[2] = row (3) + row (1);
+                frustum.planes[3] = row (3) - row (1);
+                frustum.planes[4] = row (3) + row (2);
+
+                for (Vector4f & plane : frustum.planes)
+                {
+                    plane = plane / glm::length (Vector3f(plane));
+                }
+
+                return frustum;
+            }
+
+            ///Devuelve el volumen de visión en otro espacio, dada la matriz que pasa de ese espacio al de la cámara
+            ///(por ejemplo la inversa de la cámara para el espacio del mundo, o la transformación de un modelo para su espacio local)
+            Frustum transformed (const Matrix44 & to_camera) const
+            {
+                Frustum  frustum;
+                Matrix44 planes_transformation = transpose (to_camera);
+
+                for (int index = 0; index < number_of_planes; ++index)
+                {
+                    Vector4f plane = planes_transformation * planes[index];
+
+                    frustum.planes[index] = plane / glm::length (Vector3f(plane));
+                }
+
+                return frustum;
+            }
+
+            ///Devuelve true si la esfera (en espacio de cámara) toca el volumen de visión
+            bool intersects_sphere (const Vector3f & center, float radius) const
+            {
+                for (const Vector4f & plane : planes)
+                {
+                    if (glm::dot (Vector3f(plane), center) + plane.w < -radius) return false;
+                }
+
+                return true;
+            }
+
+            ///Devuelve true si la caja alineada con los ejes (en espacio de cámara) toca el volumen de visión
+            bool intersects_box (const Vector3f & min_corner, const Vector3f & max_corner) const
+            {
+                for (const Vector4f & plane : planes)
+                {
+                    //Se prueba la esquina de la caja que queda más adentro del plano
+                    Vector3f corner
+                    (
+                        plane.x >= 0.f ? max_corner.x : min_corner.x,
+                        plane.y >= 0.f ? max_corner.y : min_corner.y,
+                        plane.z >= 0.f ? max_corner.z : min_corner.z
+                    );
+
+                    if (glm::dot (Vector3f(plane), corner) + plane.w < 0.f) return false;
+                }
+
+                return true;
+            }
+        };
+
+    }
+
+#endif
@@ -0,0 +1,274 @@
+/**
+* @file Golden_Check.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que pinta la escena sin ventana desde varias posiciones fijas de la cámara y compara el resultado con
+* imágenes de referencia y con los tiempos de frame guardados, para detectar cambios en la salida del rasterizer
+**/
+
+#include "Golden_Check.hpp"
+#include "View.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace Engine
+{
+    namespace
+    {
+        ///Posición fija de la cámara (mismos parámetros que Camera::Update)
+        struct Golden_Pose
+        {
+            const char * name;
+            float angle_x, angle_y, angle_z;
+            float x, y, z;
+        };
+
+        const Golden_Pose poses[] =
+        {
+            { "default",  0.f,  0.f,  0.f, 10.f ,  0.f , 15.f },
+            { "far",      0.f,  0.f,  0.f, 10.f ,  0.f , 25.f },
+            { "near",     0.f,  0.f,  0.f, 10.f ,  0.f , 13.f },
+            { "left",     0.f, 45.f,  0.f, 11.f ,  0.f , 15.f },
+            { "up",      45.f,  0.f, 45.f, 10.5f, -1.5f, 15.f },
+        };
+
+        struct Image
+        {
+            int width  = 0;
+            int height = 0;
+            std::vector< uint8_t > rgb;
+        };
+
+        bool write_ppm (const std::string & path, const Image & image)
+        {
+            std::ofstream file(path, std::ios::binary);
+
+            if (!file) return false;
+
+            file << "P6\n" << image.width << ' ' << image.height << "\n255\n";
+            file.write (reinterpret_cast< const char * >(image.rgb.data ()), std::streamsize(image.rgb.size ()));
+
+            return bool(file);
+        }
+
+        bool read_ppm (const std::string & path, Image & image)
+        {
+            std::ifstream file(path, std::ios::binary);
+            std::string   magic;
+            int           max_value;
+
+            if (!(file >> magic >> image.width >> image.height >> max_value) || magic != "P6" || max_value != 255) return false;
+
+            file.get ();
+
+            image.rgb.resize (size_t(image.width) * image.height * 3);
+            file.read (reinterpret_cast< char * >(image.rgb.data ()), std::streamsize(image.rgb.size ()));
+
+            return bool(file);
+        }
+
+        ///Copia el framebuffer de la escena a una imagen RGB
+        Image capture (const View & view)
+        {
+            Image image;
+
+            image.width  = int(view.width );
+            image.height = int(view.height);
+            image.rgb.reserve (size_t(image.width) * image.height * 3);
+
+            const auto * colors = view.color_buffer.colors ();
+
+            for (size_t index = 0, size = size_t(image.width) * image.height; index < size; ++index)
+            {
+                image.rgb.push_back (uint8_t(colors[index].red  ()));
+                image.rgb.push_back (uint8_t(colors[index].green()));
+                image.rgb.push_back (uint8_t(colors[index].blue ()));
+            }
+
+            return image;
+        }
+
+        ///Cuenta los píxeles con algún canal más distinto que la tolerancia y genera una imagen con las diferencias
+        size_t compare (const Image & actual, const Image & reference, int channel_tolerance, Image & difference)
+        {
+            difference.width  = actual.width;
+            difference.height = actual.height;
+            difference.rgb.assign (actual.rgb.size (), 0);
+
+            size_t different_pixels = 0;
+
+            for (size_t index = 0; index < actual.rgb.size (); index += 3)
+            {
+                int max_delta = 0;
+
+                for (size_t channel = 0; channel < 3; ++channel)
+                {
+                    max_delta = std::max (max_delta, std::abs (int(actual.rgb[index + channel]) - int(reference.rgb[index + channel])));
+                }
+
+                if (max_delta > channel_tolerance)
+                {
+                    //Los píxeles distintos se marcan en rojo con intensidad según la diferencia
+                    difference.rgb[index] = uint8_t(std::min (255, 64 + max_delta));
+                    different_pixels++;
+                }
+                else
+                {
+                    //Los iguales se dejan en gris oscuro para poder ver la escena de fondo
+                    uint8_t gray = uint8_t((int(actual.rgb[index]) + actual.rgb[index + 1] + actual.rgb[index + 2]) / 12);
+
+                    difference.rgb[index] = difference.rgb[index + 1] = difference.rgb[index + 2] = gray;
+                }
+            }
+
+            return different_pixels;
+        }
+
+        std::map< std::string, double > read_timings (const std::string & path)
+        {
+            std::map< std::string, double > timings;
+            std::ifstream file(path);
+            std::string   name;
+            double        microseconds;
+
+            while (file >> name >> microseconds) timings[name] = microseconds;
+
+            return timings;
+        }
+
+        ///Pinta un frame completo (update, intercambio de buffers y render) y devuelve los microsegundos que ha tardado
+        double render_frame (View & view)
+        {
+            auto start = std::chrono::steady_clock::now ();
+
+            view.update ();
+            view.swap_frames ();
+            view.render ();
+
+            return std::chrono::duration< double, std::micro >(std::chrono::steady_clock::now () - start).count ();
+        }
+    }
+
+    ///Devuelve 0 si todas las posiciones coinciden con las referencias y cumplen el presupuesto de tiempo.
+    int run_golden_check (const Golden_Settings & settings)
+    {
+        View view(800, 600);
+
+        view.headless = true;
+        view.camera   = new Camera(poses[0].x, poses[0].y, poses[0].z);
+
+        const std::string timings_path = settings.directory + "/timings.txt";
+
+        std::map< std::string, double > reference_timings = read_timings (timings_path);
+        std::map< std::string, double > measured_timings;
+
+        int failures = 0;
+
+        //Sin tiempos de referencia no se puede comprobar el presupuesto, así que la comprobación falla en vez de
+        //darlo por bueno
+        if (!settings.record && reference_timings.empty ())
+        {
+            std::cerr << "golden: missing reference timings " << timings_path << ", record them with --golden-record (see tests/golden/README.md)\n";
+            failures++;
+        }
+
+        for (const Golden_Pose & pose : poses)
+        {
+            view.camera->Update (pose.angle_x, pose.angle_y, pose.angle_z, pose.x, pose.y, pose.z);
+            view.update_background (pose.x, pose.y, pose.z);
+
+            // La escena se anima en cada update, pero el orden de las posiciones y de los frames es siempre el
+            // mismo, así que cada imagen es reproducible:
+
+            render_frame (view);
+
+            Image actual = capture (view);
+
+            const std::string image_path = settings.directory + "/" + pose.name + ".ppm";
+
+            if (settings.record)
+            {
+                if (!write_ppm (image_path, actual))
+                {
+                    std::cerr << "golden: cannot write " << image_path << '\n';
+                    failures++;
+                }
+            }
+            else
+            {
+                Image reference;
+
+                if (!read_ppm (image_path, reference) || reference.width != actual.width || reference.height != actual.height)
+                {
+                    std::cerr << "golden: missing or invalid reference " << image_path << ", record it with --golden-record (see tests/golden/README.md)\n";
+                    write_ppm (settings.directory + "/" + pose.name + ".actual.ppm", actual);
+                    failures++;
+                }
+                else
+                {
+                    Image  difference;
+                    size_t different_pixels = compare (actual, reference, settings.channel_tolerance, difference);
+                    float  fraction         = float(different_pixels) / float(actual.width * actual.height);
+
+                    if (fraction > settings.pixel_tolerance)
+                    {
+                        std::cerr << "golden: " << pose.name << " differs in " << different_pixels << " pixels (" << fraction * 100.f << "%)\n";
+                        write_ppm (settings.directory + "/" + pose.name + ".actual.ppm", actual    );
+                        write_ppm (settings.directory + "/" + pose.name + ".diff.ppm",   difference);
+                        failures++;
+                    }
+                }
+            }
+
+            // Tiempo de frame: se usa la mediana para que no afecten los picos puntuales del sistema:
+
+            std::vector< double > frame_times;
+
+            for (int frame = 0; frame < settings.timed_frames; ++frame)
+            {
+                frame_times.push_back (render_frame (view));
+            }
+
+            std::nth_element (frame_times.begin (), frame_times.begin () + frame_times.size () / 2, frame_times.end ());
+
+            double median = frame_times[frame_times.size () / 2];
+
+            measured_timings[pose.name] = median;
+
+            auto reference = reference_timings.find (pose.name);
+
+            if (!settings.record && reference != reference_timings.end () && median > reference->second * settings.time_tolerance)
+            {
+                std::cerr << "golden: " << pose.name << " takes " << median << "us, budget is " << reference->second * settings.time_tolerance << "us\n";
+                failures++;
+            }
+
+            std::cout << "golden: " << pose.name << ' ' << median << "us\n";
+        }
+
+        if (settings.record)
+        {
+            std::ofstream file(timings_path);
+
+            for (const auto & timing : measured_timings) file << timing.first << ' ' << timing.second << '\n';
+        }
+
+        delete view.camera;
+
+        std::cout << "golden: " << (failures ? "FAILED" : "OK") << '\n';
+
+        return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+}
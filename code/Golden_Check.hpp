@@ -0,0 +1,37 @@
+/**
+* @file Golden_Check.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que pinta la escena sin ventana desde varias posiciones fijas de la cámara y compara el resultado con
+* imágenes de referencia y con los tiempos de frame guardados, para detectar cambios en la salida del rasterizer
+**/
+
+#ifndef GOLDEN_CHECK_HEADER
+#define GOLDEN_CHECK_HEADER
+
+    #include <string>
+
+    namespace Engine
+    {
+
+        struct Golden_Settings
+        {
+            std::string directory;                      ///< Carpeta con las imágenes (.ppm) y los tiempos de referencia
+            bool        record          = false;        ///< Si es true se sobrescriben las referencias en lugar de comparar
+            int         channel_tolerance = 8;          ///< Diferencia máxima por canal para considerar dos píxeles iguales
+            float       pixel_tolerance = 0.001f;       ///< Fracción máxima de píxeles distintos
+            float       time_tolerance  = 1.25f;        ///< Factor máximo sobre el tiempo de frame de referencia
+            int         timed_frames    = 15;           ///< Frames que se miden en cada posición (se usa la mediana)
+        };
+
+        ///Devuelve 0 si todas las posiciones coinciden con las referencias y cumplen el presupuesto de tiempo.
+        ///Cuando falla una imagen se guardan junto a la referencia la imagen obtenida (.actual.ppm) y la diferencia (.diff.ppm).
+        int run_golden_check (const Golden_Settings &);
+
+    }
+
+#endif
@@ -0,0 +1,158 @@
+/**
+* @file Hot_Reload.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que vuelve a cargar los modelos de una escena cuando cambian sus archivos, sin parar ni volver a crear la escena
+**/
+
+#include "Hot_Reload.hpp"
+#include "View.hpp"
+#include "Stats.hpp"
+#include <iostream>
+
+namespace Engine
+{
+    Hot_Reload::Hot_Reload(View & given_view)
+    :
+        view(given_view)
+    {
+        for (const Model_Description & model : view.description.models)
+        {
+            watcher.watch (model.path);
+        }
+
+        thread = std::thread([this] { run (); });
+    }
+
+    Hot_Reload::~Hot_Reload()
+    {
+        running = false;
+
+        thread.join ();
+    }
+
+    void Hot_Reload::run ()
+    {
+        while (running)
+        {
+            for (const std::string & path : watcher.wait_for_changes (Asset_Watcher::poll_interval_milliseconds))
+            {
+                reimport (path);
+            }
+
+            std::vector< std::unique_ptr< Model > > finished;
+
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+
+                finished.swap (retired);
+            }
+        }
+    }
+
+    void Hot_Reload::reimport (const std::string & path)
+    {
+        std::vector< size_t > users;
+
+        for (size_t index = 0, count = view.description.models.size (); index < count; ++index)
+        {
+            if (view.description.models[index].path == path) users.push_back (index);
+        }
+
+        if (users.empty ()) return;
+
+        // El archivo se importa una sola vez, con lo que se vuelven a calcular sus meshlets, su caja y su BVH. Model
+        // guarda el puntero a la ruta, que tiene que ser la de la descripción de la escena:
+
+        auto create = [&] (size_t index, const Model * asset)
+        {
+            const Model_Description & model = view.description.models[index];
+
+            char * model_path = const_cast< char * >(model.path.c_str ());
+
+            return asset
+                ? new Model(*asset,     &view, model.red, model.green, model.blue, model.scale, model.x, model.y, model.z, model.rotation_x, model.rotation_y, model.active)
+                : new Model(model_path, &view, model.red, model.green, model.blue, model.scale, model.x, model.y, model.z, model.rotation_x, model.rotation_y, model.active);
+        };
+
+        std::unique_ptr< Model > asset(create (users[0], nullptr));
+
+        //Un archivo a medio escribir o que ya no se puede leer no sustituye a nada: los modelos siguen como estaban
+        if (asset->triangle_count == 0)
+        {
+            failures++;
+
+            std::cerr << "Recarga: no se puede cargar " << path << ", se mantiene el anterior\n";
+
+            return;
+        }
+
+        //Si la escena se pinta con buffer de visibilidad, el modelo nuevo también tiene que caber en sus identificadores
+        if (view.visibility_buffer && !View::fits_visibility_buffer (*asset))
+        {
+            failures++;
+
+            std::cerr << "Recarga: " << path << " tiene demasiados triángulos para el buffer de visibilidad, se mantiene el anterior\n";
+
+            return;
+        }
+
+        // El último modelo se queda con el importado y el resto lo copian. Los que se leen por partes no se pueden
+        // copiar y cada uno abre su propio lector:
+
+        std::vector< Replacement > replacements;
+
+        for (size_t user = 0; user < users.size (); ++user)
+        {
+            Model * instance = user + 1 == users.size ()
+                ? asset.release ()
+                : create (users[user], asset->stream ? nullptr : asset.get ());
+
+            replacements.push_back ({ int(users[user]), std::unique_ptr< Model >(instance) });
+        }
+
+        reloads++;
+
+        std::lock_guard< std::mutex > lock(mutex);
+
+        for (Replacement & replacement : replacements)
+        {
+            ready.push_back (std::move (replacement));
+        }
+    }
+
+    size_t Hot_Reload::apply ()
+    {
+        std::vector< Replacement > replacements;
+
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            replacements.swap (ready);
+        }
+
+        if (replacements.empty ()) return 0;
+
+        ENGINE_STATS_SCOPE("hot_reload", -1);
+
+        std::vector< std::unique_ptr< Model > > replaced;
+
+        for (Replacement & replacement : replacements)
+        {
+            replaced.emplace_back (view.replace_model (replacement.model, replacement.instance.release ()));
+        }
+
+        std::lock_guard< std::mutex > lock(mutex);
+
+        for (std::unique_ptr< Model > & model : replaced)
+        {
+            retired.push_back (std::move (model));
+        }
+
+        return replacements.size ();
+    }
+}
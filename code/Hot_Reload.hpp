@@ -0,0 +1,85 @@
+/**
+* @file Hot_Reload.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que vuelve a cargar los modelos de una escena cuando cambian sus archivos, sin parar ni volver a crear la escena
+**/
+
+#ifndef HOT_RELOAD_HEADER
+#define HOT_RELOAD_HEADER
+
+    #include <atomic>
+    #include <cstdint>
+    #include <memory>
+    #include <mutex>
+    #include <string>
+    #include <thread>
+    #include <vector>
+    #include "Asset_Watcher.hpp"
+
+    namespace Engine
+    {
+
+        class Model;
+        class View;
+
+        ///Un hilo propio espera a que cambie algún archivo de la escena, lo vuelve a importar una sola vez (con sus
+        ///meshlets, cajas y BVH de triángulos, sin tocar el resto de modelos) y prepara a partir de él una instancia
+        ///nueva para cada modelo de la escena que usa ese archivo. Entre dos frames, cuando ni el update ni el render
+        ///trabajan, apply cambia cada modelo por su sustituto, que es solo cambiar un puntero. Los modelos antiguos se
+        ///liberan en el hilo de la recarga para no pagar esa memoria en el hilo principal.
+        class Hot_Reload
+        {
+            struct Replacement
+            {
+                int                      model;         ///< Índice en total_models
+                std::unique_ptr< Model > instance;
+            };
+
+            View &                                view;
+            Asset_Watcher                         watcher;
+
+            std::mutex                            mutex;
+            std::vector< Replacement >            ready;        ///< Sustitutos que esperan al siguiente apply
+            std::vector< std::unique_ptr< Model > > retired;    ///< Modelos sustituidos que el hilo debe liberar
+
+            std::atomic< bool >                   running { true };
+            std::atomic< uint64_t >               reloads { 0 };
+            std::atomic< uint64_t >               failures{ 0 };
+
+            std::thread                           thread;
+
+        public:
+
+            ///Empieza a vigilar los archivos de todos los modelos de la escena, que debe vivir más que este objeto
+            explicit Hot_Reload(View &);
+           ~Hot_Reload();
+
+            Hot_Reload(const Hot_Reload &) = delete;
+            Hot_Reload & operator = (const Hot_Reload &) = delete;
+
+            ///Cambia los modelos que ya tienen sustituto. Se llama desde el hilo principal entre dos frames, con el
+            ///update terminado y antes de pasarlo al render. Devuelve cuántos modelos se han cambiado.
+            size_t apply ();
+
+            ///Archivos recargados y archivos que no se han podido leer (los modelos siguen con la geometría anterior)
+            uint64_t get_reloads  () const { return reloads;  }
+            uint64_t get_failures () const { return failures; }
+
+            bool uses_polling () const { return watcher.uses_polling (); }
+
+        private:
+
+            void run ();
+
+            ///Importa de nuevo el archivo y deja en ready una instancia nueva para cada modelo que lo usa
+            void reimport (const std::string & path);
+        };
+
+    }
+
+#endif
@@ -0,0 +1,118 @@
+/**
+* @file Index_Buffer.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda el index buffer de los modelos, que usa índices de 16 bits cuando todos los vértices del modelo
+* caben en ellos y de 32 bits cuando no
+**/
+
+#ifndef INDEX_BUFFER_HEADER
+#define INDEX_BUFFER_HEADER
+
+    #include <cstddef>
+    #include <cstdint>
+    #include <type_traits>
+    #include <vector>
+
+    namespace Engine
+    {
+
+        ///El ancho se elige al reservar el buffer a partir del número de vértices del modelo. Los que no llegan a
+        ///65536 vértices (la mayoría de los modelos pequeños de las escenas) leen la mitad de bytes por triángulo.
+        ///Quien necesita los índices sin convertir los pide con visit, que llama a la función dada con el puntero
+        ///del tipo que toca, de modo que los bucles calientes se compilan una vez por ancho.
+        class Index_Buffer
+        {
+        public:
+
+            ///Número de vértices hasta el que se usan índices de 16 bits
+            static constexpr size_t narrow_vertex_limit = size_t(1) << 16;
+
+            ///Número máximo de índices (y de vértices) de un modelo, el que cabe en los índices de 32 bits y en los
+            ///rangos de los meshlets. Los cargadores rechazan los modelos más grandes.
+            static constexpr size_t max_count = size_t(UINT32_MAX);
+
+        private:
+
+            std::vector< uint16_t > narrow;
+            std::vector< uint32_t > wide;
+
+            bool narrow_format = true;
+
+        public:
+
+            ///Deja count índices a 0 con el ancho que necesita un modelo de number_of_vertices vértices
+            void allocate (size_t count, size_t number_of_vertices)
+            {
+                narrow_format = number_of_vertices <= narrow_vertex_limit;
+
+                if (narrow_format)
+                {
+                    std::vector< uint32_t >().swap (wide);
+                    narrow.assign (count, 0);
+                }
+                else
+                {
+                    std::vector< uint16_t >().swap (narrow);
+                    wide.assign (count, 0);
+                }
+            }
+
+            ///Copia los índices que dejan los cargadores, que siempre están entre 0 y number_of_vertices - 1
+            void assign (const std::vector< uint32_t > & indices, size_t number_of_vertices)
+            {
+                allocate (indices.size (), number_of_vertices);
+
+                visit
+                (
+                    [&] (auto * data)
+                    {
+                        typedef typename std::remove_pointer< decltype(data) >::type Index;
+
+                        for (size_t index = 0, count = indices.size (); index < count; ++index)
+                        {
+                            data[index] = Index(indices[index]);
+                        }
+                    }
+                );
+            }
+
+            template< class FUNCTION >
+            void visit (FUNCTION && function)
+            {
+                if (narrow_format) function (narrow.data ()); else function (wide.data ());
+            }
+
+            template< class FUNCTION >
+            void visit (FUNCTION && function) const
+            {
+                if (narrow_format) function (narrow.data ()); else function (wide.data ());
+            }
+
+            uint32_t operator [] (size_t index) const
+            {
+                return narrow_format ? uint32_t(narrow[index]) : wide[index];
+            }
+
+            ///Punteros a los índices de cada ancho. El del ancho que no se usa es nullptr.
+            const uint16_t * narrow_data () const { return narrow_format ? narrow.data () : nullptr; }
+            const uint32_t * wide_data   () const { return narrow_format ? nullptr : wide.data (); }
+
+            bool   is_narrow () const { return narrow_format; }
+            size_t size      () const { return narrow_format ? narrow.size () : wide.size (); }
+            bool   empty     () const { return size () == 0; }
+
+            ///Memoria que ocupan los índices, contando lo reservado aunque no se use, como bytes_of
+            size_t bytes     () const { return narrow.capacity () * sizeof(uint16_t) + wide.capacity () * sizeof(uint32_t); }
+
+            ///Bytes de los índices que se usan, que son los que se guardan y se leen de los paquetes
+            size_t data_bytes () const { return size () * (narrow_format ? sizeof(uint16_t) : sizeof(uint32_t)); }
+        };
+
+    }
+
+#endif
@@ -0,0 +1,286 @@
+/**
+* @file Job_System.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda el sistema de trabajos de todo el motor: un hilo por núcleo con su propia cola, robo de trabajo
+* entre colas, dependencias entre trabajos y bucles paralelos en los que también trabaja el hilo que espera
+**/
+
+#include "Job_System.hpp"
+#include "Parallel.hpp"
+
+namespace Engine
+{
+    namespace
+    {
+        ///Sistema al que pertenece el hilo actual y su cola, o nullptr si no es un hilo de ningún sistema
+        thread_local Job_System * current_system = nullptr;
+        thread_local size_t       current_queue  = 0;
+    }
+
+    ///Sistema compartido por todo el motor, con un hilo menos que núcleos porque el que espera también trabaja
+    Job_System & Job_System::instance ()
+    {
+        static Job_System system(worker_count () - 1);
+
+        return system;
+    }
+
+    Job_System::Job_System(unsigned number_of_threads)
+    :
+        queued(0),
+        exit  (false)
+    {
+        for (unsigned index = 0; index <= number_of_threads; ++index)
+        {
+            queues.emplace_back (new Job_Queue);
+        }
+
+        for (unsigned index = 0; index < number_of_threads; ++index)
+        {
+            workers.emplace_back (&Job_System::worker_loop, this, index);
+        }
+    }
+
+    ///Los trabajos que quedan en las colas se terminan antes de parar los hilos
+    Job_System::~Job_System()
+    {
+        {
+            std::lock_guard< std::mutex > lock(sleep_mutex);
+
+            exit = true;
+        }
+
+        work_available.notify_all ();
+
+        for (std::thread & worker : workers) worker.join ();
+    }
+
+    ///Índice del hilo actual entre 0 y size() - 1. Todos los hilos que no son del sistema tienen el último.
+    size_t Job_System::thread_index () const
+    {
+        return current_system == this ? current_queue : workers.size ();
+    }
+
+    ///Encola un trabajo que empieza cuando han terminado todos los grupos de los que depende
+    Job_System::Job_Handle Job_System::submit (std::function< void () > function, const std::vector< Job_Handle > & dependencies)
+    {
+        Job_Handle group = std::make_shared< Job_Group > (1);
+
+        if (dependencies.empty ())
+        {
+            push ({ std::move (function), group });
+            return group;
+        }
+
+        // El trabajo se apunta en los grupos que aún no han terminado. Hay una cuenta de más que se quita al final,
+        // para que no se encole mientras se está apuntando:
+
+        auto deferred = std::make_shared< Deferred_Job > ();
+
+        deferred->job       = { std::move (function), group };
+        deferred->remaining = int(dependencies.size ()) + 1;
+
+        for (const Job_Handle & dependency : dependencies)
+        {
+            {
+                std::lock_guard< std::mutex > lock(dependency->mutex);
+
+                if (!dependency->finished)
+                {
+                    dependency->continuations.push_back (deferred);
+                    continue;
+                }
+            }
+
+            deferred->remaining--;
+        }
+
+        if (--deferred->remaining == 0) push (std::move (deferred->job));
+
+        return group;
+    }
+
+    ///Espera a que termine el grupo ejecutando mientras tanto sus trabajos pendientes
+    void Job_System::wait (const Job_Handle & group)
+    {
+        group->waiters++;
+
+        while (group->pending > 0)
+        {
+            Job job;
+
+            //Sin hilos en el sistema nadie más ejecutaría los trabajos de los que depende el grupo
+            if (pop_from (group.get (), job) || (workers.empty () && pop (job)))
+            {
+                run (job);
+                continue;
+            }
+
+            //Los trabajos que quedan ya están en marcha en otros hilos o esperan a sus dependencias
+            std::unique_lock< std::mutex > lock(sleep_mutex);
+
+            progress.wait (lock, [&] { return group->pending == 0 || group->queued > 0; });
+        }
+
+        group->waiters--;
+    }
+
+    ///Pone el trabajo en la cola del hilo actual, o en la compartida si el hilo no es del sistema
+    void Job_System::push (Job && job)
+    {
+        //El trabajo puede terminar y soltar su grupo antes de que acabe esta función
+        Job_Handle  group = job.group;
+        Job_Queue & queue = *queues[current_system == this ? current_queue : queues.size () - 1];
+
+        group->queued++;
+
+        {
+            std::lock_guard< std::mutex > lock(queue.mutex);
+
+            queue.jobs.push_back (std::move (job));
+        }
+
+        // Se pasa por el mutex de los hilos dormidos para que ninguno se quede esperando justo después de ver las
+        // cuentas sin este trabajo:
+
+        queued++;
+
+        {
+            std::lock_guard< std::mutex > lock(sleep_mutex);
+        }
+
+        work_available.notify_one ();
+
+        if (group->waiters > 0) progress.notify_all ();
+    }
+
+    ///Saca un trabajo cualquiera: de la propia cola, de la compartida o robándolo de otra
+    bool Job_System::pop (Job & job)
+    {
+        size_t number_of_queues = queues.size ();
+        size_t own              = current_system == this ? current_queue : number_of_queues - 1;
+
+        for (size_t offset = 0; offset < number_of_queues; ++offset)
+        {
+            size_t      index = (own + offset) % number_of_queues;
+            Job_Queue & queue = *queues[index];
+
+            std::lock_guard< std::mutex > lock(queue.mutex);
+
+            if (queue.jobs.empty ()) continue;
+
+            //De la propia cola se saca el último trabajo, y de las demás el primero
+            if (offset == 0 && index != number_of_queues - 1)
+            {
+                job = std::move (queue.jobs.back ());
+                queue.jobs.pop_back ();
+            }
+            else
+            {
+                job = std::move (queue.jobs.front ());
+                queue.jobs.pop_front ();
+            }
+
+            job.group->queued--;
+            queued--;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    ///Saca un trabajo del grupo dado de cualquier cola
+    bool Job_System::pop_from (const Job_Group * group, Job & job)
+    {
+        size_t number_of_queues = queues.size ();
+        size_t own              = current_system == this ? current_queue : number_of_queues - 1;
+
+        for (size_t offset = 0; offset < number_of_queues; ++offset)
+        {
+            Job_Queue & queue = *queues[(own + offset) % number_of_queues];
+
+            std::lock_guard< std::mutex > lock(queue.mutex);
+
+            for (auto candidate = queue.jobs.rbegin (); candidate != queue.jobs.rend (); ++candidate)
+            {
+                if (candidate->group.get () != group) continue;
+
+                job = std::move (*candidate);
+                queue.jobs.erase (std::next (candidate).base ());
+
+                job.group->queued--;
+                queued--;
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void Job_System::run (Job & job)
+    {
+        job.function ();
+
+        finish (job.group);
+    }
+
+    ///Se llama cuando termina un trabajo del grupo. Al terminar el último se encolan los que dependían de él.
+    void Job_System::finish (const Job_Handle & group)
+    {
+        if (--group->pending > 0) return;
+
+        std::vector< std::shared_ptr< Deferred_Job > > continuations;
+
+        {
+            std::lock_guard< std::mutex > lock(group->mutex);
+
+            group->finished = true;
+            continuations.swap (group->continuations);
+        }
+
+        for (const auto & deferred : continuations)
+        {
+            if (--deferred->remaining == 0) push (std::move (deferred->job));
+        }
+
+        //Se despierta a quien esté esperando al grupo
+        if (group->waiters > 0)
+        {
+            {
+                std::lock_guard< std::mutex > lock(sleep_mutex);
+            }
+
+            progress.notify_all ();
+        }
+    }
+
+    void Job_System::worker_loop (unsigned index)
+    {
+        current_system = this;
+        current_queue  = index;
+
+        while (true)
+        {
+            Job job;
+
+            if (pop (job))
+            {
+                run (job);
+                continue;
+            }
+
+            std::unique_lock< std::mutex > lock(sleep_mutex);
+
+            work_available.wait (lock, [this] { return exit || queued > 0; });
+
+            if (exit && queued == 0) return;
+        }
+    }
+}
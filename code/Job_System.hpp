@@ -0,0 +1,183 @@
+/**
+* @file Job_System.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda el sistema de trabajos de todo el motor: un hilo por núcleo con su propia cola, robo de trabajo
+* entre colas, dependencias entre trabajos y bucles paralelos en los que también trabaja el hilo que espera
+**/
+
+#ifndef JOB_SYSTEM_HEADER
+#define JOB_SYSTEM_HEADER
+
+    #include <algorithm>
+    #include <atomic>
+    #include <condition_variable>
+    #include <cstddef>
+    #include <deque>
+    #include <functional>
+    #include <memory>
+    #include <mutex>
+    #include <thread>
+    #include <vector>
+
+    namespace Engine
+    {
+
+        ///Cada hilo del sistema saca primero los trabajos de su cola por el final (los últimos que ha creado, que aún
+        ///tienen sus datos en caché) y, si está vacía, coge los de la cola de los hilos de fuera o roba por el principio
+        ///de las colas de los demás. Quien espera a un grupo no se bloquea: ejecuta los trabajos de ese grupo que sigan
+        ///en alguna cola, y solo se duerme cuando todos están ya en marcha. No ejecuta trabajos de otros grupos, de modo
+        ///que no puede quedarse atrapado en uno largo (el render no hace el update) ni volver a entrar en un mutex que
+        ///tiene cogido más arriba en su pila.
+        class Job_System
+        {
+        public:
+
+            ///Grupo de trabajos que se espera como uno solo
+            struct Job_Group;
+
+            typedef std::shared_ptr< Job_Group > Job_Handle;
+
+        private:
+
+            struct Job
+            {
+                std::function< void () > function;
+                Job_Handle               group;
+            };
+
+            ///Trabajo que espera a que terminen otros grupos antes de entrar en una cola
+            struct Deferred_Job
+            {
+                Job                 job;
+                std::atomic< int >  remaining;
+            };
+
+            struct Job_Queue
+            {
+                std::mutex        mutex;
+                std::deque< Job > jobs;
+            };
+
+        public:
+
+            struct Job_Group
+            {
+                std::atomic< size_t > pending;                  ///< Trabajos sin terminar
+                std::atomic< size_t > queued  { 0 };            ///< Trabajos que están en alguna cola
+                std::atomic< int    > waiters { 0 };            ///< Hilos dentro de wait
+
+                std::mutex            mutex;
+                bool                  finished = false;
+                std::vector< std::shared_ptr< Deferred_Job > > continuations;
+
+                explicit Job_Group(size_t jobs) : pending(jobs)
+                {
+                }
+            };
+
+        private:
+
+            std::vector< std::thread >                  workers;
+            std::vector< std::unique_ptr< Job_Queue > > queues;     ///< Una por hilo del sistema y la última para los de fuera
+
+            std::atomic< size_t >                       queued;     ///< Trabajos que están en alguna cola
+            std::mutex                                  sleep_mutex;
+            std::condition_variable                     work_available;     ///< Para los hilos del sistema sin trabajo
+            std::condition_variable                     progress;           ///< Para los que esperan a un grupo
+            bool                                        exit;
+
+        public:
+
+            ///Sistema compartido por todo el motor, con un hilo menos que núcleos porque el que espera también trabaja
+            static Job_System & instance ();
+
+            explicit Job_System(unsigned number_of_threads);
+           ~Job_System();
+
+            Job_System(const Job_System &) = delete;
+            Job_System & operator = (const Job_System &) = delete;
+
+            ///Encola un trabajo que empieza cuando han terminado todos los grupos de los que depende
+            Job_Handle submit (std::function< void () > function, const std::vector< Job_Handle > & dependencies = {});
+
+            ///Espera a que termine el grupo ejecutando mientras tanto sus trabajos pendientes
+            void wait (const Job_Handle & group);
+
+            bool is_done (const Job_Handle & group) const { return group->pending == 0; }
+
+            ///Hilos que trabajan en un bucle paralelo: los del sistema y el que lo llama
+            size_t size () const { return workers.size () + 1; }
+
+            ///Índice del hilo actual entre 0 y size() - 1. Todos los hilos que no son del sistema tienen el último.
+            size_t thread_index () const;
+
+            ///Ejecuta function(index) para cada index en [0, count). Cada hilo va cogiendo el siguiente índice libre,
+            ///y el hilo que llama también trabaja en lugar de quedarse esperando.
+            template< class FUNCTION >
+            void parallel_for (size_t count, FUNCTION && function);
+
+        private:
+
+            ///Pone el trabajo en la cola del hilo actual, o en la compartida si el hilo no es del sistema
+            void push (Job && job);
+
+            ///Saca un trabajo cualquiera: de la propia cola, de la compartida o robándolo de otra
+            bool pop (Job & job);
+
+            ///Saca un trabajo del grupo dado de cualquier cola
+            bool pop_from (const Job_Group * group, Job & job);
+
+            void run (Job & job);
+
+            ///Se llama cuando termina un trabajo del grupo. Al terminar el último se encolan los que dependían de él.
+            void finish (const Job_Handle & group);
+
+            void worker_loop (unsigned index);
+        };
+
+        template< class FUNCTION >
+        void Job_System::parallel_for (size_t count, FUNCTION && function)
+        {
+            if (count == 0) return;
+
+            std::atomic< size_t > next{ 0 };
+
+            auto work = [&] ()
+            {
+                for (size_t index = next++; index < count; index = next++)
+                {
+                    function (index);
+                }
+            };
+
+            // Se encola un trabajo por hilo libre como mucho. Los que empiecen cuando ya no queden índices terminan
+            // en seguida:
+
+            size_t helpers = std::min (workers.size (), count - 1);
+
+            if (helpers == 0)
+            {
+                work ();
+                return;
+            }
+
+            Job_Handle group = std::make_shared< Job_Group > (helpers);
+
+            for (size_t helper = 0; helper < helpers; ++helper)
+            {
+                push ({ work, group });
+            }
+
+            work ();
+
+            wait (group);
+        }
+
+    }
+
+#endif
@@ -0,0 +1,69 @@
+/**
+* @file Light.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda las propiedades de las luces de la escena (direccionales y puntuales)
+**/
+
+#ifndef LIGHT_HEADER
+#define LIGHT_HEADER
+
+    #include "math.hpp"
+
+    namespace Engine
+    {
+
+        struct Light
+        {
+            enum Type
+            {
+                DIRECTIONAL,
+                POINT
+            };
+
+            Type     type;
+
+            ///Direccion hacia la luz (direccional, en el mismo espacio que las normales transformadas)
+            ///o posicion en el mundo (puntual)
+            Vector4f vector;
+
+            ///Color de la luz (componentes entre 0 y 1) e intensidad
+            Vector3f color;
+            float    intensity;
+
+            ///Radio de influencia de las luces puntuales. A partir de esta distancia la atenuacion es 0
+            float    range;
+
+            ///Canales de iluminacion. Un modelo solo recibe las luces con las que comparte algun canal
+            unsigned channels;
+
+        public:
+
+            static Light directional (const Vector4f & direction, unsigned channels = 1, float intensity = 1.f)
+            {
+                return { DIRECTIONAL, direction, Vector3f(1.f, 1.f, 1.f), intensity, 0.f, channels };
+            }
+
+            static Light point (const Vector3f & position, float range, const Vector3f & color, float intensity = 1.f, unsigned channels = 1)
+            {
+                return { POINT, Vector4f(position, 1.f), color, intensity, range, channels };
+            }
+
+            ///Atenuacion suave que llega a 0 justo en el radio de la luz
+            static float attenuation (float distance_squared, float inverse_range_squared)
+            {
+                float falloff = 1.f - distance_squared * inverse_range_squared;
+
+                if (falloff < 0.f) falloff = 0.f;
+
+                return falloff * falloff;
+            }
+        };
+
+    }
+
+#endif
@@ -0,0 +1,230 @@
+/**
+* @file Lz4.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que comprime y descomprime bloques con el formato de bloque de LZ4, que se descomprime a más de 1 GB/s por
+* núcleo y es el que usan los paquetes de assets
+**/
+
+#include "Lz4.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace Engine
+{
+    namespace
+    {
+        // Reglas del formato: las coincidencias miden al menos 4 bytes, los 5 últimos bytes siempre son literales y
+        // ninguna coincidencia puede empezar en los 12 últimos:
+
+        const size_t min_match     = 4;
+        const size_t last_literals = 5;
+        const size_t match_limit   = 12;
+        const size_t max_offset    = 65535;
+
+        const int    hash_bits     = 12;
+
+        inline uint32_t read_32 (const uint8_t * pointer)
+        {
+            uint32_t value;
+
+            std::memcpy (&value, pointer, sizeof(value));
+
+            return value;
+        }
+
+        inline uint32_t hash_of (uint32_t sequence)
+        {
+            return (sequence * 2654435761u) >> (32 - hash_bits);
+        }
+
+        ///Las longitudes que no caben en los 4 bits del token siguen en bytes de 255 terminados por uno menor
+        inline uint8_t * write_length (uint8_t * output, size_t length)
+        {
+            for ( ; length >= 255; length -= 255) *output++ = 255;
+
+            *output++ = uint8_t(length);
+
+            return output;
+        }
+
+        inline bool read_length (const uint8_t * & input, const uint8_t * input_end, size_t & length)
+        {
+            uint8_t byte;
+
+            do
+            {
+                if (input >= input_end) return false;
+
+                byte    = *input++;
+                length += byte;
+            }
+            while (byte == 255);
+
+            return true;
+        }
+
+        ///Escribe una secuencia: los literales desde anchor y, si match_length no es 0, la coincidencia que les sigue
+        inline uint8_t * write_sequence (uint8_t * output, const uint8_t * anchor, size_t literal_length, size_t offset, size_t match_length)
+        {
+            uint8_t * token = output++;
+
+            size_t match_code = match_length ? match_length - min_match : 0;
+
+            *token = uint8_t(std::min< size_t > (literal_length, 15) << 4 | std::min< size_t > (match_code, 15));
+
+            if (literal_length >= 15) output = write_length (output, literal_length - 15);
+
+            if (literal_length > 0) std::memcpy (output, anchor, literal_length);
+
+            output += literal_length;
+
+            if (match_length == 0) return output;
+
+            *output++ = uint8_t(offset     );
+            *output++ = uint8_t(offset >> 8);
+
+            if (match_code >= 15) output = write_length (output, match_code - 15);
+
+            return output;
+        }
+    }
+
+    ///Compresión voraz con una tabla hash de las posiciones de cada secuencia de 4 bytes. En los datos que no se
+    ///comprimen el paso crece para no perder tiempo buscando.
+    size_t lz4_compress (const uint8_t * source, size_t size, uint8_t * destination)
+    {
+        const uint8_t * anchor = source;
+        const uint8_t * end    = source + size;
+              uint8_t * output = destination;
+
+        if (size > match_limit)
+        {
+            uint32_t table[1 << hash_bits] = {};
+
+            const uint8_t * input           = source + 1;
+            const uint8_t * search_limit    = end - match_limit;
+            const uint8_t * match_end_limit = end - last_literals;
+
+            unsigned misses = 0;
+
+            while (input < search_limit)
+            {
+                uint32_t        sequence  = read_32 (input);
+                uint32_t        hash      = hash_of (sequence);
+                const uint8_t * candidate = source + table[hash];
+
+                table[hash] = uint32_t(input - source);
+
+                if (candidate >= input || size_t(input - candidate) > max_offset || read_32 (candidate) != sequence)
+                {
+                    input += 1 + (misses++ >> 6);
+                    continue;
+                }
+
+                misses = 0;
+
+                // La coincidencia se alarga hacia atrás sobre los literales pendientes y hacia delante hasta donde se pueda:
+
+                while (input > anchor && candidate > source && input[-1] == candidate[-1])
+                {
+                    --input;
+                    --candidate;
+                }
+
+                const uint8_t * match_end = input     + min_match;
+                const uint8_t * reference = candidate + min_match;
+
+                while (match_end < match_end_limit && *match_end == *reference)
+                {
+                    ++match_end;
+                    ++reference;
+                }
+
+                output = write_sequence (output, anchor, size_t(input - anchor), size_t(input - candidate), size_t(match_end - input));
+
+                input  = match_end;
+                anchor = input;
+
+                //Se apunta también una posición dentro de la coincidencia, que mejora la compresión casi gratis
+                table[hash_of (read_32 (input - 2))] = uint32_t(input - 2 - source);
+            }
+        }
+
+        output = write_sequence (output, anchor, size_t(end - anchor), 0, 0);
+
+        return size_t(output - destination);
+    }
+
+    ///Descomprime un bloque de compressed_size bytes que debe dar exactamente raw_size bytes
+    bool lz4_decompress (const uint8_t * source, size_t compressed_size, uint8_t * destination, size_t raw_size)
+    {
+        const uint8_t * input      = source;
+        const uint8_t * input_end  = source + compressed_size;
+              uint8_t * output     = destination;
+              uint8_t * output_end = destination + raw_size;
+
+        while (input < input_end)
+        {
+            unsigned token  = *input++;
+            size_t   length = token >> 4;
+
+            if (length == 15 && !read_length (input, input_end, length)) return false;
+
+            if (length > size_t(input_end - input) || length > size_t(output_end - output)) return false;
+
+            //Los literales cortos se copian de 16 en 16 bytes cuando sobra sitio a ambos lados, sin llamar a memcpy con un tamaño variable
+            if (length <= 16 && input_end - input >= 16 && output_end - output >= 16)
+                std::memcpy (output, input, 16);
+            else
+            if (length > 0)
+                std::memcpy (output, input, length);
+
+            output += length;
+            input  += length;
+
+            //La última secuencia solo tiene literales
+            if (input == input_end) break;
+
+            if (input_end - input < 2) return false;
+
+            size_t offset = size_t(input[0]) | size_t(input[1]) << 8;
+
+            input += 2;
+
+            if (offset == 0 || offset > size_t(output - destination)) return false;
+
+            length = token & 15;
+
+            if (length == 15 && !read_length (input, input_end, length)) return false;
+
+            length += min_match;
+
+            if (length > size_t(output_end - output)) return false;
+
+            // Si la coincidencia se solapa con lo que se está escribiendo se copia byte a byte, que repite el patrón:
+
+            const uint8_t * match = output - offset;
+
+            if (offset >= 8 && size_t(output_end - output) >= length + 8)
+            {
+                //Con 8 bytes o más de distancia se puede copiar de 8 en 8 aunque se solape, pasándose como mucho 7 bytes
+                uint8_t * end = output + length;
+
+                for ( ; output < end; output += 8, match += 8) std::memcpy (output, match, 8);
+
+                output = end;
+            }
+            else
+            {
+                for (uint8_t * end = output + length; output < end; ) *output++ = *match++;
+            }
+        }
+
+        return output == output_end;
+    }
+}
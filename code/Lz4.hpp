@@ -0,0 +1,38 @@
+/**
+* @file Lz4.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que comprime y descomprime bloques con el formato de bloque de LZ4, que se descomprime a más de 1 GB/s por
+* núcleo y es el que usan los paquetes de assets
+**/
+
+#ifndef LZ4_HEADER
+#define LZ4_HEADER
+
+    #include <cstddef>
+    #include <cstdint>
+
+    namespace Engine
+    {
+
+        ///Tamaño máximo que puede ocupar un bloque de size bytes una vez comprimido
+        inline size_t lz4_compress_bound (size_t size)
+        {
+            return size + size / 255 + 16;
+        }
+
+        ///Comprime size bytes de source en destination, que debe tener al menos lz4_compress_bound(size) bytes.
+        ///Devuelve el tamaño comprimido. El resultado se puede leer con cualquier descompresor de bloques LZ4.
+        size_t lz4_compress   (const uint8_t * source, size_t size, uint8_t * destination);
+
+        ///Descomprime un bloque de compressed_size bytes que debe dar exactamente raw_size bytes. Devuelve false si
+        ///el bloque está mal formado, sin escribir nunca fuera de destination.
+        bool   lz4_decompress (const uint8_t * source, size_t compressed_size, uint8_t * destination, size_t raw_size);
+
+    }
+
+#endif
@@ -0,0 +1,132 @@
+/**
+* @file Mapped_File.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que proyecta un archivo en memoria en modo solo lectura (mmap en POSIX, MapViewOfFile en Windows)
+**/
+
+#include "Mapped_File.hpp"
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Engine
+{
+    Mapped_File::Mapped_File()
+    :
+        data_pointer(nullptr),
+        data_size   (0)
+    #ifdef _WIN32
+       ,file_handle   (nullptr),
+        mapping_handle(nullptr)
+    #endif
+    {
+    }
+
+    Mapped_File::~Mapped_File()
+    {
+        close ();
+    }
+
+    bool Mapped_File::open (const std::string & path)
+    {
+        close ();
+
+    #ifdef _WIN32
+
+        HANDLE file = CreateFileA (path.c_str (), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size;
+
+        if (!GetFileSizeEx (file, &size) || size.QuadPart == 0)
+        {
+            CloseHandle (file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA (file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (!mapping)
+        {
+            CloseHandle (file);
+            return false;
+        }
+
+        data_pointer   = static_cast< const char * >(MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0));
+        data_size      = size_t(size.QuadPart);
+        file_handle    = file;
+        mapping_handle = mapping;
+
+    #else
+
+        int file = ::open (path.c_str (), O_RDONLY);
+
+        if (file < 0) return false;
+
+        struct stat status;
+
+        if (fstat (file, &status) != 0 || status.st_size == 0)
+        {
+            ::close (file);
+            return false;
+        }
+
+        void * mapping = mmap (nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+        //La proyección sigue siendo válida después de cerrar el descriptor
+        ::close (file);
+
+        if (mapping == MAP_FAILED) return false;
+
+        madvise (mapping, size_t(status.st_size), MADV_SEQUENTIAL);
+
+        data_pointer = static_cast< const char * >(mapping);
+        data_size    = size_t(status.st_size);
+
+    #endif
+
+        if (!data_pointer)
+        {
+            close ();
+            return false;
+        }
+
+        return true;
+    }
+
+    void Mapped_File::close ()
+    {
+    #ifdef _WIN32
+
+        if (data_pointer  ) UnmapViewOfFile (data_pointer);
+        if (mapping_handle) CloseHandle (mapping_handle);
+        if (file_handle   ) CloseHandle (file_handle);
+
+        file_handle    = nullptr;
+        mapping_handle = nullptr;
+
+    #else
+
+        if (data_pointer) munmap (const_cast< char * >(data_pointer), data_size);
+
+    #endif
+
+        data_pointer = nullptr;
+        data_size    = 0;
+    }
+}
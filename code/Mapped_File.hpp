@@ -0,0 +1,48 @@
+/**
+* @file Mapped_File.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que proyecta un archivo en memoria en modo solo lectura (mmap en POSIX, MapViewOfFile en Windows)
+**/
+
+#ifndef MAPPED_FILE_HEADER
+#define MAPPED_FILE_HEADER
+
+    #include <cstddef>
+    #include <string>
+
+    namespace Engine
+    {
+
+        class Mapped_File
+        {
+            const char * data_pointer;
+            size_t       data_size;
+
+        #ifdef _WIN32
+            void *       file_handle;
+            void *       mapping_handle;
+        #endif
+
+        public:
+
+            Mapped_File();
+           ~Mapped_File();
+
+            Mapped_File(const Mapped_File &) = delete;
+            Mapped_File & operator = (const Mapped_File &) = delete;
+
+            bool open  (const std::string & path);
+            void close ();
+
+            const char * data () const { return data_pointer; }
+            size_t       size () const { return data_size;    }
+        };
+
+    }
+
+#endif
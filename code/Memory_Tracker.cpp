@@ -0,0 +1,130 @@
+/**
+* @file Memory_Tracker.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que lleva la cuenta de la memoria que ocupa cada parte del motor y de los límites que se le ponen
+**/
+
+#include "Memory_Tracker.hpp"
+#include <cstdio>
+
+namespace Engine
+{
+    namespace
+    {
+        const char * const category_names[Memory_Tracker::CATEGORY_COUNT] =
+        {
+            "geometry", "instances", "streaming", "framebuffers", "importers"
+        };
+
+        double megabytes (size_t bytes)
+        {
+            return double(bytes) / (1024. * 1024.);
+        }
+    }
+
+    Memory_Tracker & Memory_Tracker::instance ()
+    {
+        static Memory_Tracker tracker;
+
+        return tracker;
+    }
+
+    const char * Memory_Tracker::name_of (Category category)
+    {
+        return category_names[category];
+    }
+
+    bool Memory_Tracker::category_from (const std::string & name, Category & category)
+    {
+        for (int index = 0; index < CATEGORY_COUNT; ++index)
+        {
+            if (name == category_names[index])
+            {
+                category = Category(index);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void Memory_Tracker::add (Category category, size_t bytes)
+    {
+        Account & account = accounts[category];
+
+        size_t current = account.current.fetch_add (bytes, std::memory_order_relaxed) + bytes;
+        size_t peak    = account.peak.load (std::memory_order_relaxed);
+
+        while (current > peak && !account.peak.compare_exchange_weak (peak, current, std::memory_order_relaxed)) { }
+    }
+
+    void Memory_Tracker::remove (Category category, size_t bytes)
+    {
+        accounts[category].current.fetch_sub (bytes, std::memory_order_relaxed);
+    }
+
+    size_t Memory_Tracker::total () const
+    {
+        size_t bytes = 0;
+
+        for (const Account & account : accounts) bytes += account.current;
+
+        return bytes;
+    }
+
+    void Memory_Tracker::print (std::ostream & out) const
+    {
+        char line[128];
+
+        out << "memory";
+
+        for (int index = 0; index < CATEGORY_COUNT; ++index)
+        {
+            Category category = Category(index);
+
+            std::snprintf (line, sizeof(line), " | %s %.1fMB peak %.1fMB", category_names[index], megabytes (current (category)), megabytes (peak (category)));
+
+            out << line;
+
+            if (budget (category))
+            {
+                std::snprintf (line, sizeof(line), " budget %.1fMB%s", megabytes (budget (category)), over_budget (category) ? " OVER" : "");
+
+                out << line;
+            }
+        }
+
+        std::snprintf (line, sizeof(line), " | total %.1fMB\n", megabytes (total ()));
+
+        out << line;
+    }
+
+    std::string Memory_Tracker::metrics () const
+    {
+        std::string result;
+
+        char pair[96];
+
+        for (int index = 0; index < CATEGORY_COUNT; ++index)
+        {
+            Category category = Category(index);
+
+            std::snprintf
+            (
+                pair, sizeof(pair), "%smemory_%s=%llu memory_%s_peak=%llu",
+                index ? " " : "",
+                category_names[index], (unsigned long long)current (category),
+                category_names[index], (unsigned long long)peak    (category)
+            );
+
+            result += pair;
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,137 @@
+/**
+* @file Memory_Tracker.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que lleva la cuenta de la memoria que ocupa cada parte del motor y de los límites que se le ponen
+**/
+
+#ifndef MEMORY_TRACKER_HEADER
+#define MEMORY_TRACKER_HEADER
+
+    #include <atomic>
+    #include <cstddef>
+    #include <cstdint>
+    #include <ostream>
+    #include <string>
+    #include <vector>
+
+    namespace Engine
+    {
+
+        ///Bytes que ocupa un vector, contando lo reservado aunque no se use
+        template< typename TYPE >
+        inline size_t bytes_of (const std::vector< TYPE > & vector)
+        {
+            return vector.capacity () * sizeof(TYPE);
+        }
+
+        ///No se intercepta cada reserva: cada dueño de un buffer grande apunta lo que ocupa al crearlo y lo quita al
+        ///destruirse, de modo que llevar la cuenta no cuesta nada en el frame. Los límites (0 es sin límite) los
+        ///consultan quienes pueden ocupar menos: los modelos grandes se leen por partes en lugar de enteros y la caché
+        ///de assets olvida los prototipos que hace más tiempo que no se usan.
+        class Memory_Tracker
+        {
+        public:
+
+            enum Category
+            {
+                GEOMETRY,           ///< Vértices, índices, meshlets y BVH de los modelos y de los prototipos de la caché
+                INSTANCES,          ///< Buffers por vértice que cada modelo rellena en cada frame
+                STREAMING,          ///< Huecos de los modelos que se leen por partes
+                FRAMEBUFFERS,       ///< Color, profundidad y visibilidad de las escenas
+                IMPORTERS,          ///< Datos temporales de los importadores mientras se carga un archivo
+                CATEGORY_COUNT
+            };
+
+        private:
+
+            struct Account
+            {
+                std::atomic< size_t > current{ 0 };
+                std::atomic< size_t > peak   { 0 };
+                std::atomic< size_t > budget { 0 };
+            };
+
+            Account accounts[CATEGORY_COUNT];
+
+        public:
+
+            static Memory_Tracker & instance ();
+
+            ///Nombre de la categoría en la salida y en la línea de comandos ("geometry", "instances"...)
+            static const char * name_of       (Category);
+
+            ///Devuelve false si el nombre no es el de ninguna categoría
+            static bool         category_from (const std::string & name, Category & category);
+
+            void add    (Category, size_t bytes);
+            void remove (Category, size_t bytes);
+
+            size_t current (Category category) const { return accounts[category].current; }
+            size_t peak    (Category category) const { return accounts[category].peak;    }
+            size_t budget  (Category category) const { return accounts[category].budget;  }
+
+            ///Suma de todas las categorías
+            size_t total   () const;
+
+            void set_budget (Category category, size_t bytes) { accounts[category].budget = bytes; }
+
+            ///Indica si caben bytes más en la categoría sin pasarse de su límite
+            bool fits        (Category category, size_t bytes) const
+            {
+                size_t limit = budget (category);
+
+                return limit == 0 || current (category) + bytes <= limit;
+            }
+
+            bool over_budget (Category category) const { return !fits (category, 0); }
+
+            ///Escribe lo que ocupa cada categoría, su pico y su límite
+            void print (std::ostream &) const;
+
+            ///Lo mismo en una línea de pares clave=valor, para las métricas del servidor de render
+            std::string metrics () const;
+
+        public:
+
+            ///Memoria que se cuenta mientras vive el objeto, para los datos temporales
+            class Scope
+            {
+                Category category;
+                size_t   bytes;
+
+            public:
+
+                Scope(Category category, size_t bytes) : category(category), bytes(bytes)
+                {
+                    Memory_Tracker::instance ().add (category, bytes);
+                }
+
+               ~Scope()
+                {
+                    Memory_Tracker::instance ().remove (category, bytes);
+                }
+
+                ///Cambia lo que se cuenta, para cuando una estimación hecha antes de reservar se conoce ya de verdad
+                void resize (size_t new_bytes)
+                {
+                    Memory_Tracker & tracker = Memory_Tracker::instance ();
+
+                    if (new_bytes > bytes) tracker.add    (category, new_bytes - bytes);
+                    else                   tracker.remove (category, bytes - new_bytes);
+
+                    bytes = new_bytes;
+                }
+
+                Scope(const Scope &) = delete;
+                Scope & operator = (const Scope &) = delete;
+            };
+        };
+
+    }
+
+#endif
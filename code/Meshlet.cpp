@@ -0,0 +1,232 @@
+/**
+* @file Meshlet.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que divide los modelos en clusters pequeños de triángulos (meshlets) con su esfera envolvente y su cono de normales,
+* para poder descartar clusters enteros antes de transformar sus vértices
+**/
+
+#include "Meshlet.hpp"
+#include <cmath>
+
+namespace Engine
+{
+    using std::vector;
+
+    ///Devuelve true si, desde el punto de vista dado (en espacio local), todos los triángulos del cluster se descartarían por backface culling
+    bool Meshlet::is_backfacing (const Vector3f & eye) const
+    {
+        if (cone_cos <= 0.f) return false;
+
+        // Un triángulo se descarta si su normal forma menos de 90 grados con la dirección de la vista. Con todas las normales
+        // dentro del cono (semiángulo t) y todos los puntos dentro de la esfera (vistos bajo un semiángulo a), basta con que
+        // el ángulo entre el eje y la dirección al centro sea menor que 90 - t - a, es decir, cos >= sin(t + a):
+
+        Vector3f direction = Vector3f(bounding_sphere) - eye;
+        float    distance  = glm::length (direction);
+
+        if (distance <= bounding_sphere.w) return false;
+
+        float sin_a = bounding_sphere.w / distance;
+        float cos_a = std::sqrt (1.f - sin_a * sin_a);
+
+        //Si t + a llega a 90 grados no se puede descartar
+        if (cone_cos * cos_a - cone_sin * sin_a <= 0.f) return false;
+
+        return glm::dot (cone_axis, direction) >= (cone_sin * cos_a + cone_cos * sin_a) * distance;
+    }
+
+    ///Calcula la esfera envolvente y el cono de normales a partir de los vértices del cluster y de sus índices locales
+    void Meshlet::compute_bounds (const Point4f * vertices, int vertex_count, const int * local_indices, int index_count)
+    {
+        const Point4f * first = vertices;
+        const Point4f * last  = vertices + vertex_count;
+
+        // Esfera envolvente a partir de la caja envolvente:
+
+        Vector3f min_corner = Vector3f(*first);
+        Vector3f max_corner = min_corner;
+
+        for (const Point4f * vertex = first; vertex < last; ++vertex)
+        {
+            min_corner = glm::min (min_corner, Vector3f(*vertex));
+            max_corner = glm::max (max_corner, Vector3f(*vertex));
+        }
+
+        Vector3f center = (min_corner + max_corner) * 0.5f;
+        float    radius = 0.f;
+
+        for (const Point4f * vertex = first; vertex < last; ++vertex)
+        {
+            radius = glm::max (radius, glm::distance (center, Vector3f(*vertex)));
+        }
+
+        bounding_sphere = Vector4f(center, radius);
+
+        // Cono de normales. Se usa la normal de la cara que se pinta, que por el orden horario de los
+        // triángulos (y la inversión de la Y al importar) es cross(v2 - v0, v1 - v0):
+
+        vector< Vector3f > face_normals;
+        Vector3f           axis(0.f, 0.f, 0.f);
+
+        for (int index = 0; index < index_count; index += 3)
+        {
+            Vector3f v0 = Vector3f(vertices[local_indices[index + 0]]);
+            Vector3f v1 = Vector3f(vertices[local_indices[index + 1]]);
+            Vector3f v2 = Vector3f(vertices[local_indices[index + 2]]);
+
+            Vector3f normal = glm::cross (v2 - v0, v1 - v0);
+            float    length = glm::length (normal);
+
+            //Los triángulos degenerados no se pintan nunca y no influyen en el cono
+            if (length > 0.f)
+            {
+                face_normals.push_back (normal / length);
+                axis += face_normals.back ();
+            }
+        }
+
+        cone_axis = Vector3f(0.f, 0.f, 1.f);
+        cone_cos  = -1.f;
+        cone_sin  =  0.f;
+
+        float axis_length = glm::length (axis);
+
+        if (axis_length > 0.f)
+        {
+            axis /= axis_length;
+
+            float min_cos = 1.f;
+
+            for (const Vector3f & normal : face_normals)
+            {
+                min_cos = glm::min (min_cos, glm::dot (normal, axis));
+            }
+
+            cone_axis = axis;
+            cone_cos  = min_cos;
+            cone_sin  = std::sqrt (glm::max (0.f, 1.f - min_cos * min_cos));
+        }
+    }
+
+    int Meshlet_Builder::find (uint64_t key) const
+    {
+        for (int index = 0, size = int(keys.size ()); index < size; ++index)
+        {
+            if (keys[index] == key) return index;
+        }
+
+        return -1;
+    }
+
+    ///Devuelve false si el triángulo no cabe en el cluster actual y hay que cerrarlo antes de añadirlo
+    bool Meshlet_Builder::fits (const uint64_t triangle[3]) const
+    {
+        int new_vertices = 0;
+
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            bool repeated = (corner > 0 && triangle[corner] == triangle[0]) || (corner > 1 && triangle[corner] == triangle[1]);
+
+            if (!repeated && find (triangle[corner]) < 0) new_vertices++;
+        }
+
+        return int(keys.size ()) + new_vertices <= Meshlet::max_vertices && int(triangles.size ()) / 3 < Meshlet::max_triangles;
+    }
+
+    ///Añade el triángulo al cluster actual
+    void Meshlet_Builder::add (const uint64_t triangle[3])
+    {
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            int local = find (triangle[corner]);
+
+            if (local < 0)
+            {
+                local = int(keys.size ());
+                keys.push_back (triangle[corner]);
+            }
+
+            triangles.push_back (local);
+        }
+    }
+
+    ///Reordena los buffers del modelo para que cada meshlet tenga sus vértices contiguos y genera la lista de meshlets
+    void build_meshlets
+    (
+        vector< Point4f  > & vertices,
+        vector< Point4f  > & normals,
+        vector< uint32_t > & indices,
+        vector< Meshlet  > & meshlets,
+        vector< uint32_t > * source_vertices
+    )
+    {
+        vector< Point4f  > meshlet_vertices;
+        vector< Point4f  > meshlet_normals;
+        vector< uint32_t > meshlet_indices;
+
+        meshlet_vertices.reserve (vertices.size ());
+        meshlet_normals .reserve (normals .size ());
+        meshlet_indices .reserve (indices .size ());
+        meshlets.clear ();
+
+        if (source_vertices) source_vertices->clear ();
+
+        // Se agrupan los triángulos en el orden del archivo. La clave de cada vértice es su índice original:
+
+        Meshlet_Builder builder;
+
+        auto flush = [&] ()
+        {
+            if (builder.empty ()) return;
+
+            const vector< uint64_t > & keys  = builder.vertex_keys   ();
+            const vector< int      > & local = builder.local_indices ();
+
+            Meshlet meshlet;
+
+            meshlet.vertex_offset = uint32_t(meshlet_vertices.size ());
+            meshlet.vertex_count  = uint32_t(keys            .size ());
+            meshlet.index_offset  = uint32_t(meshlet_indices .size ());
+            meshlet.index_count   = uint32_t(local           .size ());
+
+            for (uint64_t vertex : keys)
+            {
+                meshlet_vertices.push_back (vertices[size_t(vertex)]);
+                meshlet_normals .push_back (normals [size_t(vertex)]);
+
+                if (source_vertices) source_vertices->push_back (uint32_t(vertex));
+            }
+
+            for (int index : local)
+            {
+                meshlet_indices.push_back (meshlet.vertex_offset + uint32_t(index));
+            }
+
+            meshlet.compute_bounds (meshlet_vertices.data () + meshlet.vertex_offset, int(meshlet.vertex_count), local.data (), int(meshlet.index_count));
+
+            meshlets.push_back (meshlet);
+
+            builder.clear ();
+        };
+
+        for (size_t index = 0, number_of_indices = indices.size (); index < number_of_indices; index += 3)
+        {
+            uint64_t triangle[3] = { uint64_t(indices[index]), uint64_t(indices[index + 1]), uint64_t(indices[index + 2]) };
+
+            if (!builder.fits (triangle)) flush ();
+
+            builder.add (triangle);
+        }
+
+        flush ();
+
+        vertices.swap (meshlet_vertices);
+        normals .swap (meshlet_normals );
+        indices .swap (meshlet_indices );
+    }
+}
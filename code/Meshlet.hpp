@@ -0,0 +1,99 @@
+/**
+* @file Meshlet.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que divide los modelos en clusters pequeños de triángulos (meshlets) con su esfera envolvente y su cono de normales,
+* para poder descartar clusters enteros antes de transformar sus vértices
+**/
+
+#ifndef MESHLET_HEADER
+#define MESHLET_HEADER
+
+    #include <cstdint>
+    #include <vector>
+    #include "math.hpp"
+
+    namespace Engine
+    {
+
+        struct Meshlet
+        {
+            static constexpr int max_vertices  = 64;
+            static constexpr int max_triangles = 124;
+
+            ///Rango de vértices propio del cluster (los vértices compartidos entre clusters se duplican)
+            uint32_t vertex_offset;
+            uint32_t vertex_count;
+
+            ///Rango del index buffer. Los índices apuntan dentro del rango de vértices del cluster
+            uint32_t index_offset;
+            uint32_t index_count;
+
+            ///Esfera envolvente en espacio local (centro en xyz y radio en w)
+            Vector4f bounding_sphere;
+
+            ///Cono con las normales de los triángulos que se pintan. Si cone_cos <= 0 el cono no permite descartar nada
+            Vector3f cone_axis;
+            float    cone_cos;
+            float    cone_sin;
+
+        public:
+
+            ///Devuelve true si, desde el punto de vista dado (en espacio local), todos los triángulos del cluster se descartarían por backface culling
+            bool is_backfacing (const Vector3f & eye) const;
+
+            ///Calcula la esfera envolvente y el cono de normales a partir de los vértices del cluster y de sus índices locales
+            void compute_bounds (const Point4f * vertices, int vertex_count, const int * local_indices, int index_count);
+        };
+
+        ///Agrupa triángulos en un cluster hasta llenarlo. Los vértices se identifican con una clave cualquiera
+        ///(el índice en el buffer original o, al importar por partes, el par posición/normal del OBJ).
+        class Meshlet_Builder
+        {
+            std::vector< uint64_t > keys;
+            std::vector< int      > triangles;
+
+        public:
+
+            Meshlet_Builder()
+            {
+                keys     .reserve (Meshlet::max_vertices );
+                triangles.reserve (Meshlet::max_triangles * 3);
+            }
+
+            ///Devuelve false si el triángulo no cabe en el cluster actual y hay que cerrarlo antes de añadirlo
+            bool fits (const uint64_t triangle[3]) const;
+
+            ///Añade el triángulo al cluster actual
+            void add  (const uint64_t triangle[3]);
+
+            bool empty () const { return triangles.empty (); }
+            void clear ()       { keys.clear (); triangles.clear (); }
+
+            const std::vector< uint64_t > & vertex_keys   () const { return keys;      }
+            const std::vector< int      > & local_indices () const { return triangles; }
+
+        private:
+
+            int find (uint64_t key) const;
+        };
+
+        ///Reordena los buffers del modelo para que cada meshlet tenga sus vértices contiguos y genera la lista de meshlets.
+        ///Si se pasa source_vertices, guarda en él el índice original de cada vértice reordenado, para reordenar igual
+        ///otros atributos por vértice.
+        void build_meshlets
+        (
+            std::vector< Point4f  > & vertices,
+            std::vector< Point4f  > & normals,
+            std::vector< uint32_t > & indices,
+            std::vector< Meshlet  > & meshlets,
+            std::vector< uint32_t > * source_vertices = nullptr
+        );
+
+    }
+
+#endif
@@ -10,9 +10,24 @@
 **/
 
 #include "Model.h"
+#include "Stats.hpp"
+#include "Obj_Loader.hpp"
+#include "Obj_Streamer.hpp"
+#include "Asset_Pack.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <mutex>
 
 namespace Engine
 {
+    size_t Model::streaming_budget    = size_t(256) << 20;
+    size_t Model::streaming_threshold = size_t(512) << 20;
+    bool   Model::use_compact_vertices = false;
+
     ///Constructor por defecto del modelo
 	Model::Model(char* path, View* given_view, float a, float g, float b, float given_scale, float x, float y, float z, float angle_rotation_x, float angle_rotation_y, bool _isActive)
 	{
@@ -21,13 +36,129 @@ namespace Engine
         //Recogemos una referencia a la escena
 		view = given_view;
 
-        ///Importamos el objeto dentro de la escena
+        Load(path);
+
+        Place(a, g, b, given_scale, x, y, z, angle_rotation_x, angle_rotation_y, _isActive);
+
+        Account_Memory();
+	}
+
+    ///Constructor que crea otra instancia de un modelo ya cargado, copiando su geometra en lugar de volver a leer el archivo.
+    Model::Model(const Model & asset, View* given_view, float a, float g, float b, float given_scale, float x, float y, float z, float angle_rotation_x, float angle_rotation_y, bool _isActive)
+    {
+        //Los modelos que se leen por partes cambian su geometra al pintarse, por lo que no se pueden compartir
+        assert(!asset.stream);
+
+        mode_path = asset.mode_path;
+        view = given_view;
+
+        original_vertices = asset.original_vertices;
+        original_normals  = asset.original_normals;
+        original_indices  = asset.original_indices;
+        compact_vertices  = asset.compact_vertices;
+        quantization      = asset.quantization;
+        meshlets          = asset.meshlets;
+        bounding_sphere   = asset.bounding_sphere;
+        bounds            = asset.bounds;
+        triangle_bvh      = asset.triangle_bvh;
+        triangle_count    = asset.triangle_count;
+        skeleton          = asset.skeleton;
+        skin_influences   = asset.skin_influences;
+
+        Allocate_Buffers(compact_vertices.empty() ? original_vertices.size() : compact_vertices.size());
+
+        if (skeleton)
+        {
+            Allocate_Skinning();
+        }
+
+        Place(a, g, b, given_scale, x, y, z, angle_rotation_x, angle_rotation_y, _isActive);
+
+        Account_Memory();
+    }
+
+    ///Destructor que quita la memoria del modelo de la cuenta
+    Model::~Model()
+    {
+        for (int category = 0; category < Memory_Tracker::CATEGORY_COUNT; ++category)
+        {
+            Memory_Tracker::instance().remove(Memory_Tracker::Category(category), accounted_memory[category]);
+        }
+    }
+
+    ///Funcin que lee la geometra del modelo, o lo abre por partes, y la prepara para pintarla.
+    void Model::Load(char* path)
+    {
+        //Los modelos que estn en un paquete de assets montado no necesitan importarse
+        if (Load_Packed(path)) return;
+
+        ///Importamos el objeto dentro de la escena. Los .mesh y los OBJ muy grandes no pasan por Assimp, sino que se leen por partes,
+        ///y el resto de OBJ se leen con el importador propio. Assimp se queda para los dems formatos o si el OBJ no se puede leer.
 		Assimp::Importer importer;
-		auto scene = importer.ReadFile
-		(
-			path,
-			aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType
-		);
+		const aiScene * scene = nullptr;
+
+		vector< uint32_t > indices;
+
+		//Cada cargador empieza con los buffers vacos, para que lo que deja uno que falla a medias no se mezcle con el siguiente
+		auto clear_buffers = [&] ()
+		{
+			original_vertices.clear();
+			original_normals .clear();
+			indices          .clear();
+		};
+
+        // La memoria de los importadores se cuenta desde antes de importar, para que su pico se vea mientras dura la
+        // carga. Hasta tener la escena se estima con el tamao del archivo, que es lo que tambin consulta
+        // Open_Stream para leer por partes los OBJ que no caben en el lmite de los importadores:
+
+		Memory_Tracker::Scope importer_memory(Memory_Tracker::IMPORTERS, 0);
+
+		bool loaded = Open_Stream(path);
+
+		if (!loaded)
+		{
+			std::error_code error;
+
+			uintmax_t file_size = std::filesystem::file_size(path, error);
+
+			importer_memory.resize(error ? 0 : size_t(file_size));
+		}
+
+		if (!loaded && has_extension(path, ".obj"))
+		{
+			clear_buffers();
+
+			loaded = load_obj(path, original_vertices, original_normals, indices);
+		}
+
+		if (!loaded)
+		{
+			clear_buffers();
+
+			scene = importer.ReadFile
+			(
+				path,
+				aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType
+			);
+		}
+
+        //Con la escena ya leda, la estimacin pasa a ser lo que ocupan la escena de Assimp y los ndices int de los cargadores
+        size_t importer_bytes = bytes_of(indices) + assimp_scene_bytes(scene);
+
+        for (unsigned mesh = 0; scene && mesh < scene->mNumMeshes; mesh++)
+        {
+            importer_bytes += size_t(scene->mMeshes[mesh]->mNumFaces) * 3 * sizeof(int);
+        }
+
+        importer_memory.resize(importer_bytes);
+
+        //Los ndices de un modelo tienen que caber en 32 bits, como en Index_Buffer y en los rangos de los meshlets
+        if (scene && scene->mNumMeshes > 0 && size_t(scene->mMeshes[0]->mNumFaces) * 3 > Index_Buffer::max_count)
+        {
+            std::cerr << "El modelo " << path << " tiene demasiados tringulos, no se carga\n";
+
+            scene = nullptr;
+        }
 
         //Si hay una escena creada y el nmero de meshes es mayor a 0
         if (scene && scene->mNumMeshes > 0)
@@ -56,44 +187,120 @@ namespace Engine
                 }
             }
 
-            //Se inicializan los vertices, normals, y colors
-            transformed_vertices.resize(number_of_vertices);
-            transformed_normals.resize(number_of_vertices);
-            transformed_colors.resize(number_of_vertices);
-            display_vertices.resize(number_of_vertices);
+            // Se generan los ndices de los tringulos:
+
+            size_t number_of_triangles = mesh->mNumFaces;
 
-            // Se inicializan los datos de color de los vrtices con colores aleatorios:
+            indices.resize(number_of_triangles * 3);
 
-            originals_color.resize(number_of_vertices);
+            vector< uint32_t >::iterator indices_iterator = indices.begin();
 
+            for (size_t index = 0; index < number_of_triangles; index++)
+            {
+                auto& face = mesh->mFaces[index];
+
+                assert(face.mNumIndices == 3);              // Una face puede llegar a tener de 1 a 4 ndices,
+                                                            // pero nos interesa que solo haya tringulos
+                auto face_indices = face.mIndices;
+
+                *indices_iterator++ = face_indices[0];
+                *indices_iterator++ = face_indices[1];
+                *indices_iterator++ = face_indices[2];
+            }
+
+            //Si el mesh tiene huesos se leen su esqueleto, sus animaciones y los pesos de cada vrtice
+            if (mesh->HasBones())
+            {
+                auto imported = std::make_shared< Skeleton >();
+
+                if (imported->import(scene, mesh, skin_influences))
+                {
+                    skeleton = imported;
+                }
+            }
+        }
+
+        if (!stream && !original_vertices.empty())
+        {
+            // Se calcula la esfera envolvente a partir de la caja envolvente del modelo:
+
+            size_t number_of_vertices = original_vertices.size();
+
+            Vector3f min_corner = Vector3f(original_vertices[0]);
+            Vector3f max_corner = min_corner;
+
+            for (size_t index = 1; index < number_of_vertices; index++)
+            {
+                min_corner = glm::min(min_corner, Vector3f(original_vertices[index]));
+                max_corner = glm::max(max_corner, Vector3f(original_vertices[index]));
+            }
+
+            Vector3f center = (min_corner + max_corner) * 0.5f;
+            float    radius = 0.f;
 
             for (size_t index = 0; index < number_of_vertices; index++)
             {
-                //Aqui cambiamos el color
-                originals_color[index].set(/*rand_clamp(), rand_clamp(), rand_clamp()*/ a,g,b);
+                radius = glm::max(radius, glm::distance(center, Vector3f(original_vertices[index])));
             }
 
-            // Se generan los ndices de los tringulos:
+            bounding_sphere = Vector4f(center, radius);
 
-            size_t number_of_triangles = mesh->mNumFaces;
+            // Se divide el modelo en meshlets. Los vrtices compartidos entre meshlets se duplican, por lo que
+            // el nmero de vrtices puede crecer:
 
-            original_indices.resize(number_of_triangles * 3);
+            vector< uint32_t > source_vertices;
 
-            Index_Buffer::iterator indices_iterator = original_indices.begin();
+            build_meshlets(original_vertices, original_normals, indices, meshlets, skeleton ? &source_vertices : nullptr);
 
-            for (size_t index = 0; index < number_of_triangles; index++)
+            triangle_count = indices.size() / 3;
+
+            //El ancho de los ndices se elige con los vrtices ya duplicados
+            original_indices.assign(indices, original_vertices.size());
+
+            bounds = Aabb(min_corner, max_corner);
+
+            //Se inicializan los vertices, normals, y colors
+            Allocate_Buffers(original_vertices.size());
+
+            if (skeleton)
             {
-                auto& face = mesh->mFaces[index];
+                // Los pesos se reordenan igual que los vrtices. La geometra cambia en cada frame, por lo que no hay
+                // BVH de tringulos, ni compresin dentro de la caja en reposo, ni conos de normales que sirvan:
 
-                assert(face.mNumIndices == 3);              // Una face puede llegar a tener de 1 a 4 ndices,
-                                                            // pero nos interesa que solo haya tringulos
-                auto indices = face.mIndices;
+                vector< Skin_Influences > meshlet_influences(source_vertices.size());
+
+                for (size_t index = 0, number_of_vertices = source_vertices.size(); index < number_of_vertices; index++)
+                {
+                    meshlet_influences[index] = skin_influences[source_vertices[index]];
+                }
 
-                *indices_iterator++ = int(indices[0]);
-                *indices_iterator++ = int(indices[1]);
-                *indices_iterator++ = int(indices[2]);
+                skin_influences.swap(meshlet_influences);
+
+                for (Meshlet & meshlet : meshlets)
+                {
+                    meshlet.cone_cos = 0.f;
+                }
+
+                Allocate_Skinning();
+            }
+            else
+            {
+                Build_Triangle_Bvh();
+
+                //Una vez ordenados los vrtices ya se pueden comprimir dentro de la caja del modelo
+                if (use_compact_vertices)
+                {
+                    Compress_Vertices(min_corner, max_corner);
+                }
             }
         }
+    }
+
+    ///Funcin que fija el color, las matrices y el estado inicial del modelo.
+    void Model::Place(float a, float g, float b, float given_scale, float x, float y, float z, float angle_rotation_x, float angle_rotation_y, bool _isActive)
+    {
+        //Aqui cambiamos el color
+        color.set(/*rand_clamp(), rand_clamp(), rand_clamp()*/ a, g, b);
 
         ///Inicializacin de las matrices. 
         Matrix44 identity(1);
@@ -101,115 +308,1015 @@ namespace Engine
         rotation_x = rotate_around_x(identity, (angle_rotation_x * PI) / 180);
         rotation_y = rotate_around_y(identity, (angle_rotation_y * PI) / 180);
         translation = translate(identity, Vector3f{ x, y, z });
+        scale_factor = given_scale;
+        light_channels = 1;
         isActive = _isActive;
+    }
 
-	}
+    ///Funcin que copia de otra instancia el color, las matrices y el estado en la escena, para ocupar su lugar al recargar el archivo.
+    void Model::Take_Placement(const Model & other)
+    {
+        color           = other.color;
+        scaling         = other.scaling;
+        rotation_x      = other.rotation_x;
+        rotation_y      = other.rotation_y;
+        translation     = other.translation;
+        scale_factor    = other.scale_factor;
+        light_channels  = other.light_channels;
+        isActive        = other.isActive;
+        scene_index     = other.scene_index;
+        animation_clip  = other.animation_clip;
+        animation_time  = other.animation_time;
+        animation_speed = other.animation_speed;
+    }
 
-    ///Funcin que recoge las matrices y recoge los vertices que se pintarn por pantalla. Es una funcin que se llamar antes del Render.
-    void Model::Post_Render(int given_width, int given_height)
+    ///Funcin que reserva los buffers por vrtice que se rellenan en cada frame.
+    void Model::Allocate_Buffers(size_t number_of_vertices)
     {
-        Matrix44 identity(1);
-        Matrix44 scaling = scale(identity, float(given_width / 2), float(given_height / 2), 100000000.f);
-        Matrix44 translation = translate(identity, Vector3f{ float(given_width / 2), float(given_height / 2), 0.f });
-        Matrix44 transformation = translation * scaling;
+        transformed_vertices.resize(number_of_vertices);
+        transformed_facing.resize(number_of_vertices);
+        transformed_colors.resize(number_of_vertices);
+        rendered_vertices.resize(number_of_vertices);
+        rendered_facing.resize(number_of_vertices);
+        rendered_colors.resize(number_of_vertices);
 
-        for (size_t index = 0, number_of_vertices = transformed_vertices.size(); index < number_of_vertices; index++)
+        for (int component = 0; component < 3; ++component)
         {
-            display_vertices[index] = Point4i(transformation * transformed_vertices[index]);
+            lighting_positions   [component].resize(number_of_vertices);
+            lighting_normals     [component].resize(number_of_vertices);
+            lighting_accumulation[component].resize(number_of_vertices);
         }
     }
 
-    ///Funcin que pinta los vertices del modelo, es decir, es la funcin que pinta el modelo y hace que se vea.
-    void Model::Render(bool isRendering)
+    ///Funcin que apunta en el Memory_Tracker lo que ocupan la geometra y los buffers del modelo.
+    void Model::Account_Memory()
     {
-        if (isRendering)
+        size_t bytes[Memory_Tracker::CATEGORY_COUNT] = {};
+
+        //En los modelos que se leen por partes los buffers de geometra son los huecos
+        size_t & geometry = bytes[stream ? Memory_Tracker::STREAMING : Memory_Tracker::GEOMETRY];
+
+        geometry += bytes_of(original_vertices) + bytes_of(original_normals) + original_indices.bytes() + bytes_of(compact_vertices);
+        geometry += bytes_of(meshlets) + triangle_bvh.bytes() + bytes_of(skin_influences);
+        geometry += bytes_of(meshlet_slot) + bytes_of(slot_meshlet) + bytes_of(meshlet_last_frame);
+
+        size_t & instance = bytes[Memory_Tracker::INSTANCES];
+
+        instance += bytes_of(transformed_vertices) + bytes_of(transformed_facing) + bytes_of(transformed_colors);
+        instance += bytes_of(rendered_vertices) + bytes_of(rendered_facing) + bytes_of(rendered_colors);
+        instance += bytes_of(skinned_vertices) + bytes_of(skinned_normals) + bytes_of(rendered_skinned_vertices) + bytes_of(rendered_skinned_normals);
+        instance += bytes_of(skin_palette) + bytes_of(skin_nodes);
+
+        for (int component = 0; component < 3; ++component)
+        {
+            instance += bytes_of(lighting_positions[component]) + bytes_of(lighting_normals[component]) + bytes_of(lighting_accumulation[component]);
+        }
+
+        Memory_Tracker & tracker = Memory_Tracker::instance();
+
+        for (int category = 0; category < Memory_Tracker::CATEGORY_COUNT; ++category)
+        {
+            tracker.remove(Memory_Tracker::Category(category), accounted_memory[category]);
+            tracker.add   (Memory_Tracker::Category(category), bytes[category]);
+
+            accounted_memory[category] = bytes[category];
+        }
+    }
+
+    ///Funcin que reserva la paleta de huesos y los buffers de la pose, que empiezan con la pose de reposo.
+    void Model::Allocate_Skinning()
+    {
+        skin_palette.resize(skeleton->palette_size());
+
+        skinned_vertices          = original_vertices;
+        skinned_normals           = original_normals;
+        rendered_skinned_vertices = original_vertices;
+        rendered_skinned_normals  = original_normals;
+    }
+
+    ///Funcin que avanza la animacin los segundos dados y deforma los vrtices con la nueva pose. No hace nada si el modelo no tiene huesos.
+    void Model::Animate(float seconds)
+    {
+        if (!skeleton) return;
+
+        animation_time += seconds * animation_speed;
+
+        skeleton->pose(animation_clip, animation_time, skin_nodes, skin_palette.data());
+
+        size_t number_of_vertices = skinned_vertices.size();
+
+        skin_vertices(skin_palette.data(), skin_influences.data(), original_vertices.data(), original_normals.data(), skinned_vertices.data(), skinned_normals.data(), number_of_vertices);
+
+        ENGINE_STATS_ADD(vertices_skinned, number_of_vertices);
+
+        Update_Skinned_Bounds();
+    }
+
+    ///Funcin que recalcula las esferas de los meshlets y la caja del modelo con los vrtices deformados.
+    void Model::Update_Skinned_Bounds()
+    {
+        // Cada esfera sale de la caja de su meshlet, que es ms rpido que buscar el vrtice ms lejano y basta para el culling:
+
+        Aabb model_bounds;
+
+        for (Meshlet & meshlet : meshlets)
         {
-            for (int* indices = original_indices.data(), *end = indices + original_indices.size(); indices < end; indices += 3)
+            Aabb meshlet_bounds;
+
+            for (uint32_t index = meshlet.vertex_offset, end = index + meshlet.vertex_count; index < end; index++)
             {
-                if (is_frontface(transformed_vertices.data(), indices))
+                meshlet_bounds.grow(Vector3f(skinned_vertices[index]));
+            }
+
+            Vector3f center = (meshlet_bounds.min_corner + meshlet_bounds.max_corner) * 0.5f;
+
+            meshlet.bounding_sphere = Vector4f(center, glm::distance(center, meshlet_bounds.max_corner));
+
+            model_bounds.grow(meshlet_bounds);
+        }
+
+        if (model_bounds.empty()) return;
+
+        Vector3f center = (model_bounds.min_corner + model_bounds.max_corner) * 0.5f;
+
+        bounds          = model_bounds;
+        bounding_sphere = Vector4f(center, glm::distance(center, model_bounds.max_corner));
+    }
+
+    ///Funcin que pasa los vrtices cargados al formato comprimido y libera los originales.
+    void Model::Compress_Vertices(const Vector3f & min_corner, const Vector3f & max_corner)
+    {
+        quantization = Vertex_Quantization(min_corner, max_corner);
+
+        size_t number_of_vertices = original_vertices.size();
+
+        compact_vertices.resize(number_of_vertices);
+
+        for (size_t index = 0; index < number_of_vertices; index++)
+        {
+            quantization.encode(original_vertices[index], original_normals[index], compact_vertices[index]);
+        }
+
+        Vertex_Buffer().swap(original_vertices);
+        Vertex_Buffer().swap(original_normals);
+    }
+
+    ///Funcin que construye la BVH de los tringulos del modelo.
+    void Model::Build_Triangle_Bvh()
+    {
+        vector< Aabb > triangle_bounds(original_indices.size() / 3);
+
+        for (size_t triangle = 0, number_of_triangles = triangle_bounds.size(); triangle < number_of_triangles; ++triangle)
+        {
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                triangle_bounds[triangle].grow(Vector3f(original_vertices[original_indices[triangle * 3 + corner]]));
+            }
+        }
+
+        triangle_bvh.build(triangle_bounds);
+    }
+
+    ///Funcin que devuelve la posicin en espacio local de un vrtice, est comprimido o no.
+    Vector3f Model::Local_Position(int index) const
+    {
+        //La pose de los modelos con huesos es la del ltimo update que ha pasado al render
+        if (skeleton)
+        {
+            return Vector3f(rendered_skinned_vertices[index]);
+        }
+
+        if (compact_vertices.empty())
+        {
+            return Vector3f(original_vertices[index]);
+        }
+
+        const Compact_Vertex & vertex = compact_vertices[index];
+
+        return quantization.minimum + quantization.step * Vector3f(float(vertex.position[0]), float(vertex.position[1]), float(vertex.position[2]));
+    }
+
+    ///Funcin que lee el modelo de un paquete de assets montado, ya dividido en meshlets. Devuelve false si no est en ninguno.
+    bool Model::Load_Packed(const std::string & path)
+    {
+        const Asset_Pack_Entry * entry;
+        const Asset_Pack       * pack = Asset_Pack::find_mounted(path, entry);
+
+        if (!pack) return false;
+
+        // Las secciones se descomprimen directamente en los buffers del modelo, que deben tener el tamao exacto:
+
+        original_vertices.resize(size_t(entry->vertex_count));
+        original_normals .resize(size_t(entry->vertex_count));
+        meshlets         .resize(entry->meshlet_count);
+        original_indices .allocate(size_t(entry->index_count), size_t(entry->vertex_count));
+
+        void * index_data = nullptr;
+
+        original_indices.visit([&] (auto * data) { index_data = data; });
+
+        const auto & sections = entry->sections;
+
+        bool valid = original_indices.data_bytes() == sections[Asset_Pack_Entry::INDICES].raw_size
+                  && original_vertices.size() * sizeof(Vertex)  == sections[Asset_Pack_Entry::VERTICES].raw_size
+                  && original_normals .size() * sizeof(Vertex)  == sections[Asset_Pack_Entry::NORMALS ].raw_size
+                  && meshlets         .size() * sizeof(Meshlet) == sections[Asset_Pack_Entry::MESHLETS].raw_size;
+
+        valid = valid
+             && pack->read(*entry, Asset_Pack_Entry::VERTICES, original_vertices.data())
+             && pack->read(*entry, Asset_Pack_Entry::NORMALS,  original_normals .data())
+             && pack->read(*entry, Asset_Pack_Entry::INDICES,  index_data)
+             && pack->read(*entry, Asset_Pack_Entry::MESHLETS, meshlets.data());
+
+        // Un paquete daado no puede dejar meshlets ni ndices que apunten fuera de los buffers, porque se usan sin
+        // comprobar al pintar:
+
+        size_t vertex_count = original_vertices.size();
+        size_t index_count  = original_indices .size();
+
+        valid = valid && index_count % 3 == 0;
+
+        for (size_t index = 0; valid && index < meshlets.size(); ++index)
+        {
+            const Meshlet & meshlet = meshlets[index];
+
+            valid = size_t(meshlet.vertex_offset) + size_t(meshlet.vertex_count) <= vertex_count
+                 && size_t(meshlet.index_offset)  + size_t(meshlet.index_count)  <= index_count
+                 && meshlet.index_count % 3 == 0;
+        }
+
+        if (valid)
+        {
+            original_indices.visit
+            (
+                [&] (const auto * data)
                 {
-                    // Se establece el color del polgono a partir del color de su primer vrtice:
+                    for (size_t index = 0; valid && index < index_count; ++index)
+                    {
+                        valid = size_t(data[index]) < vertex_count;
+                    }
+                }
+            );
+        }
+
+        //Si el paquete est mal se importa el archivo como siempre
+        if (!valid || meshlets.empty())
+        {
+            original_vertices.clear();
+            original_normals .clear();
+            original_indices .allocate(0, 0);
+            meshlets         .clear();
+
+            return false;
+        }
+
+        Vector3f min_corner(entry->min_corner[0], entry->min_corner[1], entry->min_corner[2]);
+        Vector3f max_corner(entry->max_corner[0], entry->max_corner[1], entry->max_corner[2]);
+
+        bounding_sphere = Vector4f(entry->bounding_sphere[0], entry->bounding_sphere[1], entry->bounding_sphere[2], entry->bounding_sphere[3]);
+        bounds          = Aabb(min_corner, max_corner);
+        triangle_count  = original_indices.size() / 3;
+
+        Allocate_Buffers(original_vertices.size());
+
+        Build_Triangle_Bvh();
+
+        if (use_compact_vertices)
+        {
+            Compress_Vertices(min_corner, max_corner);
+        }
+
+        return true;
+    }
+
+    ///Funcin que abre el modelo por partes si es un .mesh o un OBJ mayor que streaming_threshold. Devuelve false si hay que importarlo con Assimp.
+    bool Model::Open_Stream(const std::string & path)
+    {
+        std::string baked_path = path;
+
+        if (!has_extension(path, ".mesh"))
+        {
+            std::error_code error;
+
+            if (!has_extension(path, ".obj")) return false;
+
+            uintmax_t file_size = std::filesystem::file_size(path, error);
+
+            if (error) return false;
+
+            //Tambin se leen por partes los OBJ que no caben en el lmite de memoria de la geometra o en el de los
+            //importadores, tomando el tamao del archivo como estimacin de lo que ocuparan enteros y de lo que ocupa
+            //importarlos. As solo ocupan sus huecos.
+            Memory_Tracker & memory = Memory_Tracker::instance();
+
+            if (file_size <= streaming_threshold && memory.fits(Memory_Tracker::GEOMETRY, size_t(file_size)) && memory.fits(Memory_Tracker::IMPORTERS, size_t(file_size))) return false;
+
+            // El OBJ se convierte una sola vez a .mesh junto al original, importndolo por bloques, y se
+            // vuelve a convertir solo si el OBJ cambia:
+
+            baked_path = path + ".mesh";
+
+            //Los modelos se cargan en paralelo, y dos con el mismo OBJ no pueden escribir el .mesh a la vez
+            static std::mutex bake_mutex;
+
+            std::lock_guard< std::mutex > lock(bake_mutex);
 
-                    view->rasterizer.set_color(transformed_colors[*indices]);
+            std::error_code baked_error;
+
+            if (!std::filesystem::exists(baked_path, baked_error) ||
+                 std::filesystem::last_write_time(baked_path, baked_error) < std::filesystem::last_write_time(path, error))
+            {
+                if (!bake_obj_streaming(path, baked_path)) return false;
+            }
+        }
+
+        stream.reset(new Baked_Mesh_Reader);
+
+        if (!stream->open(baked_path))
+        {
+            stream.reset();
+            return false;
+        }
+
+        // Solo se carga la tabla de meshlets. Sus datos se leern cuando sean visibles:
+
+        const Baked_Mesh_Header & header = stream->get_header();
+
+        bounding_sphere = Vector4f(header.bounding_sphere[0], header.bounding_sphere[1], header.bounding_sphere[2], header.bounding_sphere[3]);
+        triangle_count  = size_t(header.index_count / 3);
+
+        Vector3f sphere_center = Vector3f(bounding_sphere);
+        Vector3f sphere_extent = Vector3f(bounding_sphere.w, bounding_sphere.w, bounding_sphere.w);
+
+        bounds = Aabb(sphere_center - sphere_extent, sphere_center + sphere_extent);
+
+        int number_of_meshlets = int(header.meshlet_count);
+
+        meshlets.resize(number_of_meshlets);
+
+        for (int index = 0; index < number_of_meshlets; ++index)
+        {
+            meshlets[index] = stream->meshlet_info(index);
+        }
+
+        // Los buffers se dividen en huecos del tamao de un meshlet. El nmero de huecos sale del presupuesto de memoria:
+
+        size_t source_bytes     = use_compact_vertices ? sizeof(Compact_Vertex) : sizeof(Vertex) * 2;
+        size_t bytes_per_vertex = source_bytes + sizeof(Point4i) * 2 + sizeof(Vector2f) * 2 + sizeof(Packed_Color) * 2 + sizeof(float) * 9;
+        size_t bytes_per_slot   = bytes_per_vertex * Meshlet::max_vertices + sizeof(int) * Meshlet::max_triangles * 3;
+        int    number_of_slots  = int(std::min(size_t(number_of_meshlets), std::max(size_t(1), streaming_budget / bytes_per_slot)));
+
+        size_t number_of_vertices = size_t(number_of_slots) * Meshlet::max_vertices;
+
+        original_vertices.resize(number_of_vertices);
+        original_normals .resize(number_of_vertices);
+        original_indices .allocate(size_t(number_of_slots) * Meshlet::max_triangles * 3, number_of_vertices);
+
+        slot_meshlet      .assign(number_of_slots, -1);
+        meshlet_slot      .assign(number_of_meshlets, -1);
+        meshlet_last_frame.assign(number_of_meshlets, 0);
+        update_frame = 0;
+        slot_hand    = 0;
+
+        Allocate_Buffers(number_of_vertices);
+
+        //Los huecos comprimidos se cuantizan en la caja de la esfera del modelo, que es lo nico que se conoce sin leerlo entero
+        if (use_compact_vertices)
+        {
+            Compress_Vertices(bounds.min_corner, bounds.max_corner);
+        }
+
+        return true;
+    }
+
+    ///Funcin que lee del archivo un meshlet visible y lo coloca en un hueco libre o en el que lleva ms tiempo sin verse.
+    bool Model::Page_In(int meshlet_index)
+    {
+        int number_of_slots = int(slot_meshlet.size());
 
-                    // Se rellena el polgono:
+        // Solo se puede reutilizar un hueco si su meshlet no se ha visto ni en este update ni en el anterior, que es
+        // el que se est pintando en el otro hilo:
 
-                    view->rasterizer.fill_convex_polygon_z_buffer(display_vertices.data(), indices, indices + 3);
+        for (int tries = 0; tries < number_of_slots; ++tries)
+        {
+            int slot = slot_hand;
+            int old  = slot_meshlet[slot];
+
+            slot_hand = (slot_hand + 1) % number_of_slots;
+
+            if (old >= 0 && meshlet_last_frame[old] + 1 >= update_frame) continue;
+
+            if (old >= 0) meshlet_slot[old] = -1;
+
+            slot_meshlet[slot] = -1;
+
+            Meshlet & meshlet = meshlets[meshlet_index];
+
+            meshlet.vertex_offset = slot * Meshlet::max_vertices;
+            meshlet.index_offset  = slot * Meshlet::max_triangles * 3;
+
+            if (compact_vertices.empty())
+            {
+                if (!stream->read_meshlet(meshlet_index, &original_vertices[meshlet.vertex_offset], &original_normals[meshlet.vertex_offset], original_indices, meshlet.index_offset, meshlet.vertex_offset))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                //Con vrtices comprimidos se leen a un buffer temporal y se comprimen en su hueco
+                Vertex page_vertices[Meshlet::max_vertices];
+                Vertex page_normals [Meshlet::max_vertices];
+
+                if (!stream->read_meshlet(meshlet_index, page_vertices, page_normals, original_indices, meshlet.index_offset, meshlet.vertex_offset))
+                {
+                    return false;
+                }
+
+                for (uint32_t index = 0; index < meshlet.vertex_count; ++index)
+                {
+                    quantization.encode(page_vertices[index], page_normals[index], compact_vertices[meshlet.vertex_offset + index]);
                 }
             }
 
-            // Se copia el framebffer oculto en el framebffer de la ventana:
+            slot_meshlet[slot]          = meshlet_index;
+            meshlet_slot[meshlet_index] = slot;
+
+            return true;
+        }
+
+        //Todos los huecos estn en uso: el meshlet se queda sin pintar hasta que se libere alguno
+        return false;
+    }
+
+    ///Funcin que graba en la cola los meshlets que se pintan, como fuente de ndice scene_index. Se puede llamar a la vez para varios modelos.
+    void Model::Render(bool isRendering, Render_Queue & queue)
+    {
+        if (isRendering)
+        {
+            ENGINE_STATS_ADD(triangles_in, triangle_count);
+
+            //Con el buffer de visibilidad cada pxel guarda el modelo en los bits altos y el tringulo en los bajos. La
+            //escena solo lo usa si todos sus modelos caben (View::fits_visibility_buffer).
+            queue.set_source(scene_index, { rendered_vertices.data(), rendered_facing.data(), rendered_colors.data(), original_indices.narrow_data(), original_indices.wide_data(), uint32_t(scene_index) << View::visibility_triangle_bits });
 
-            view->color_buffer.blit_to_window();
+            // El backface culling se hace al ejecutar la cola. Aqu solo se graba un rango por meshlet:
+
+            for (size_t rendered = 0; rendered < rendered_meshlets.size(); ++rendered)
+            {
+                const Meshlet & meshlet = meshlets[rendered_meshlets[rendered]];
+
+                queue.record(scene_index, uint32_t(rendered), rendered_depths[rendered], uint32_t(meshlet.index_offset), uint32_t(meshlet.index_count));
+            }
         }
-    }   
+    }
+
+    ///Funcin que pasa el resultado del ltimo update al render. No debe llamarse mientras se ejecuta el update o el render.
+    void Model::Swap_Frame()
+    {
+        transformed_vertices.swap(rendered_vertices);
+        transformed_facing  .swap(rendered_facing  );
+        transformed_colors  .swap(rendered_colors  );
+        visible_meshlets    .swap(rendered_meshlets);
+        visible_depths      .swap(rendered_depths  );
+        skinned_vertices    .swap(rendered_skinned_vertices);
+        skinned_normals     .swap(rendered_skinned_normals );
+
+        rendered_transformation         = transformation;
+        rendered_compact_transformation = transformation * quantization.dequantization();
+        rendered_view                   = inverse_matriz;
+        rendered_light_influences       = light_influences;
+    }
+
+    ///Funcin que calcula el color de un tringulo del frame que se est pintando, para el resolve del buffer de visibilidad.
+    Packed_Color Model::Shade_Triangle(int triangle, const vector< Light > & lights) const
+    {
+        if (light_channels == 0) return Packed_Color::from(color);
+
+        // Como en el update, el tringulo toma el color de su primer vrtice, con las mismas operaciones en el mismo orden:
+
+        int index = original_indices[size_t(triangle) * 3];
+
+        Vertex position;
+        Vertex local_normal;
+
+        if (!compact_vertices.empty())
+        {
+            const Compact_Vertex & source = compact_vertices[index];
+
+            position     = rendered_compact_transformation * Vertex(float(source.position[0]), float(source.position[1]), float(source.position[2]), 1.f);
+            local_normal = Vertex(decode_octahedral(source.normal), 0.f);
+        }
+        else
+        if (skeleton)
+        {
+            position     = rendered_transformation * rendered_skinned_vertices[index];
+            local_normal = rendered_skinned_normals[index];
+        }
+        else
+        {
+            position     = rendered_transformation * original_vertices[index];
+            local_normal = original_normals[index];
+        }
+
+        Vector3f normal = normalize(Vector3f(rendered_transformation * local_normal));
+
+        float r = 0.f, g = 0.f, b = 0.f;
+
+        for (int light_index : rendered_light_influences)
+        {
+            const Light & light = lights[light_index];
+
+            Vector3f light_color = light.color * light.intensity;
+            float    intensity;
+
+            if (light.type == Light::DIRECTIONAL)
+            {
+                Vector3f l = normalize(Vector3f(light.vector));
+
+                intensity = l.x * normal.x + l.y * normal.y + l.z * normal.z;
+                intensity = intensity < 0.f ? 0.f : intensity;
+            }
+            else
+            {
+                Vector4f light_position = rendered_view * light.vector;
+
+                float inverse_range_squared = 1.f / (light.range * light.range);
+
+                float lx = light_position.x - position.x;
+                float ly = light_position.y - position.y;
+                float lz = light_position.z - position.z;
+
+                float distance_squared = lx * lx + ly * ly + lz * lz;
+
+                intensity = (lx * normal.x + ly * normal.y + lz * normal.z) / std::sqrt(distance_squared + 1e-12f);
+                intensity = intensity < 0.f ? 0.f : intensity;
+                intensity *= Light::attenuation(distance_squared, inverse_range_squared);
+            }
+
+            r += light_color.x * intensity;
+            g += light_color.y * intensity;
+            b += light_color.z * intensity;
+        }
+
+        float red   = r > 1.f ? 1.f : r;
+        float green = g > 1.f ? 1.f : g;
+        float blue  = b > 1.f ? 1.f : b;
+
+        return Packed_Color(uint8_t(float(color.red()) * red), uint8_t(float(color.green()) * green), uint8_t(float(color.blue()) * blue));
+    }
+
+    ///Funcin que devuelve la esfera envolvente del modelo en coordenadas del mundo.
+    Vector4f Model::world_bounding_sphere() const
+    {
+        Vector4f center = translation * rotation_y * scaling * Vector4f(Vector3f(bounding_sphere), 1.f);
+
+        return Vector4f(Vector3f(center), bounding_sphere.w * scale_factor);
+    }
+
+    ///Funcin que devuelve la caja envolvente del modelo en coordenadas del mundo.
+    Aabb Model::world_bounds() const
+    {
+        return bounds.transformed(translation * rotation_y * scaling);
+    }
+
+    ///Funcin que busca el tringulo ms cercano que corta un rayo (en coordenadas del mundo) antes de la distancia dada.
+    bool Model::Ray_Cast(const Ray & ray, float max_distance, float & distance, int & triangle) const
+    {
+        // El rayo se pasa a espacio local sin normalizar su direccin, por lo que las distancias siguen siendo las del mundo:
+
+        Ray local_ray = ray.transformed(inverse(translation * rotation_y * scaling));
+
+        triangle = -1;
+
+        auto test = [&] (int candidate, float & closest)
+        {
+            size_t first = size_t(candidate) * 3;
+
+            float hit;
+
+            if (intersect_triangle(local_ray, Local_Position(original_indices[first]), Local_Position(original_indices[first + 1]), Local_Position(original_indices[first + 2]), closest, hit))
+            {
+                closest  = hit;
+                distance = hit;
+                triangle = candidate;
+            }
+        };
+
+        //Los modelos con huesos no tienen BVH de tringulos y se prueban todos con la ltima pose
+        if (skeleton)
+        {
+            for (int candidate = 0, number_of_triangles = int(triangle_count); candidate < number_of_triangles; ++candidate)
+            {
+                test(candidate, max_distance);
+            }
+        }
+        else
+            triangle_bvh.ray_cast(local_ray, max_distance, test);
+
+        return triangle >= 0;
+    }
+
+    ///Funcin que aade los tringulos del modelo que tocan el volumen de visin de la cmara dada.
+    void Model::Query_Frustum(const Matrix44 & camera, vector< int > & triangles) const
+    {
+        Frustum local_frustum = view->frustum.transformed(inverse(camera) * translation * rotation_y * scaling);
+
+        if (!skeleton)
+        {
+            triangle_bvh.query_frustum(local_frustum, triangles);
+            return;
+        }
+
+        //Los modelos con huesos no tienen BVH de tringulos y se prueban todos con la ltima pose
+        for (int triangle = 0, number_of_triangles = int(triangle_count); triangle < number_of_triangles; ++triangle)
+        {
+            Aabb triangle_bounds;
+
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                triangle_bounds.grow(Local_Position(original_indices[size_t(triangle) * 3 + corner]));
+            }
+
+            if (local_frustum.intersects_box(triangle_bounds.min_corner, triangle_bounds.max_corner))
+            {
+                triangles.push_back(triangle);
+            }
+        }
+    }
+
+    ///Funcin que deja el modelo sin nada que pintar cuando la escena sabe que queda fuera de la pantalla.
+    void Model::Skip_Update()
+    {
+        visible_meshlets.clear();
+        visible_depths  .clear();
+
+        ENGINE_STATS_ADD(triangles_clipped, triangle_count);
+    }
+
+    ///Funcin que elige, por canal y por distancia, las luces de la escena que afectan al modelo.
+    void Model::Select_Lights(const vector< Light > & lights)
+    {
+        light_influences.clear();
+
+        Vector4f sphere = world_bounding_sphere();
+
+        for (int index = 0, number_of_lights = int(lights.size()); index < number_of_lights; ++index)
+        {
+            const Light & light = lights[index];
+
+            if ((light.channels & light_channels) == 0) continue;
+
+            //Las luces puntuales solo se tienen en cuenta si su radio llega a tocar la esfera del modelo
+            if (light.type == Light::POINT)
+            {
+                float reach = light.range + sphere.w;
+
+                Vector3f offset = Vector3f(light.vector) - Vector3f(sphere);
+
+                if (glm::dot(offset, offset) > reach * reach) continue;
+            }
+
+            light_influences.push_back(index);
+        }
+    }
+
+    ///Funcin que descarta los meshlets que quedan de espaldas a la cmara o fuera de la pantalla.
+    void Model::Cull_Meshlets()
+    {
+        update_frame++;
+
+        Find_Visible_Meshlets(view->camera_transformation, transformation, view->frustum, visible_meshlets);
+
+        //En los modelos que se leen por partes, los meshlets visibles se cargan si no lo estn
+        Page_In_Meshlets(visible_meshlets);
+    }
+
+    ///Funcin que deja en visible los meshlets que no quedan de espaldas ni fuera del volumen de visin de una cmara,
+    ///estn cargados o no. to_camera es la matriz que pasa del espacio local del modelo al de esa cmara.
+    void Model::Find_Visible_Meshlets(const Matrix44 & camera_transformation, const Matrix44 & to_camera, const Frustum & frustum, vector< int > & visible) const
+    {
+        visible.clear();
+
+        ENGINE_STATS_LOCAL(uint64_t triangles_culled  = 0;)
+        ENGINE_STATS_LOCAL(uint64_t triangles_clipped = 0;)
+
+        // Se calcula la posicin de la cmara en espacio local para el test del cono de normales. El escalado
+        // del modelo es uniforme, por lo que los ngulos no cambian:
+
+        Matrix44 model_matrix = translation * rotation_y * scaling;
+        Vector3f eye          = Vector3f(inverse(model_matrix) * camera_transformation * Vector4f(0.f, 0.f, 0.f, 1.f));
+
+        // Si la esfera del modelo entero queda fuera de la pantalla se descartan todos sus meshlets:
+
+        Vector3f center = Vector3f(to_camera * Vector4f(Vector3f(bounding_sphere), 1.f));
+
+        if (!frustum.intersects_sphere(center, bounding_sphere.w * scale_factor))
+        {
+            ENGINE_STATS_ADD(triangles_clipped, triangle_count);
+            return;
+        }
+
+        for (int meshlet_index = 0, number_of_meshlets = int(meshlets.size()); meshlet_index < number_of_meshlets; ++meshlet_index)
+        {
+            const Meshlet & meshlet = meshlets[meshlet_index];
+
+            if (meshlet.is_backfacing(eye))
+            {
+                ENGINE_STATS_LOCAL(triangles_culled += meshlet.index_count / 3;)
+                continue;
+            }
+
+            center = Vector3f(to_camera * Vector4f(Vector3f(meshlet.bounding_sphere), 1.f));
+
+            if (!frustum.intersects_sphere(center, meshlet.bounding_sphere.w * scale_factor))
+            {
+                ENGINE_STATS_LOCAL(triangles_clipped += meshlet.index_count / 3;)
+                continue;
+            }
+
+            visible.push_back(meshlet_index);
+        }
+
+        ENGINE_STATS_ADD(triangles_culled,  triangles_culled );
+        ENGINE_STATS_ADD(triangles_clipped, triangles_clipped);
+    }
+
+    ///Funcin que, en los modelos que se leen por partes, carga los meshlets de la lista que no lo estn y los marca como
+    ///vistos en este update. Quita de la lista los que no caben.
+    void Model::Page_In_Meshlets(vector< int > & visible)
+    {
+        if (!stream) return;
+
+        size_t kept = 0;
+
+        for (int meshlet_index : visible)
+        {
+            if (meshlet_slot[meshlet_index] < 0 && !Page_In(meshlet_index)) continue;
+
+            meshlet_last_frame[meshlet_index] = update_frame;
+
+            visible[kept++] = meshlet_index;
+        }
+
+        visible.resize(kept);
+    }
 
     ///Funcin que calcula la iluminacin, y controla el movimiento de vertices.
-    void Model::Update(const Vector4f & transformed_light_vector, bool iluminated)
+    void Model::Update(const vector< Light > & lights, bool iluminated)
     {
 
-        inverse_matriz = inverse(view->camera->transformation);
+        //Se usa la copia de la cmara que guard la escena al empezar el update, ya que la cmara
+        //puede moverse mientras se pinta el frame anterior
+        inverse_matriz = inverse(view->camera_transformation);
 
         // Creacin de la matriz de transformacin unificada:
 
         transformation = inverse_matriz * translation * rotation_y * scaling;
 
-        // Se transforman todos los vrtices usando la matriz de transformacin resultante:
+        // Antes de transformar nada se descartan los meshlets que no se van a ver:
+
+        Cull_Meshlets();
+
+        float * px = lighting_positions[0].data(), * py = lighting_positions[1].data(), * pz = lighting_positions[2].data();
+        float * nx = lighting_normals  [0].data(), * ny = lighting_normals  [1].data(), * nz = lighting_normals  [2].data();
+
+        // Con vrtices comprimidos, la decodificacin de la posicin se junta con la transformacin en una sola matriz:
+
+        bool     compact                = !compact_vertices.empty();
+        Matrix44 compact_transformation = transformation * quantization.dequantization();
+
+        //Los modelos con huesos transforman la pose que ha dejado Animate en lugar de la de reposo
+        const Vertex * source_vertices  = skeleton ? skinned_vertices.data() : original_vertices.data();
+        const Vertex * source_normals   = skeleton ? skinned_normals .data() : original_normals .data();
+
+        //Con el buffer de visibilidad los colores los calcula el resolve, solo para los pxeles que se ven
+        bool     shade_vertices         = !view->visibility_buffer;
+
+        // Se transforman los vrtices de los meshlets visibles usando la matriz de transformacin resultante. Cada vrtice
+        // se lleva en una sola pasada hasta pantalla, y de paso se guarda el ms cercano de cada meshlet:
+
+        visible_depths.resize(visible_meshlets.size());
+
+        for (size_t visible = 0; visible < visible_meshlets.size(); ++visible)
+        {
+            const Meshlet & meshlet = meshlets[visible_meshlets[visible]];
+
+            int depth = std::numeric_limits< int >::max();
+
+            for (uint32_t index = meshlet.vertex_offset, end = index + meshlet.vertex_count; index < end; index++)
+            {
+                // Se multiplican todos los vrtices originales con la matriz de transformacin y
+                // se guarda el resultado en otro vertex buffer. La posicin en espacio de cmara se
+                // guarda aparte para la iluminacin de las luces puntuales:
+
+                Vertex position;
+                Vertex local_normal;
+
+                if (compact)
+                {
+                    const Compact_Vertex & source = compact_vertices[index];
+
+                    position     = compact_transformation * Vertex(float(source.position[0]), float(source.position[1]), float(source.position[2]), 1.f);
+                    local_normal = Vertex(decode_octahedral(source.normal), 0.f);
+                }
+                else
+                {
+                    position     = transformation * source_vertices[index];
+                    local_normal = source_normals[index];
+                }
+
+                Vertex vertex = view->projection * position;
 
-        for (size_t index = 0, number_of_vertices = original_vertices.size(); index < number_of_vertices; index++)
+                if (shade_vertices)
+                {
+                    Vector3f normal = normalize(Vector3f(transformation * local_normal));
+
+                    px[index] = position.x; py[index] = position.y; pz[index] = position.z;
+                    nx[index] = normal.x;   ny[index] = normal.y;   nz[index] = normal.z;
+                }
+
+                // La matriz de proyeccin en perspectiva hace que el ltimo componente del vector
+                // transformado no tenga valor 1.0, por lo que hay que normalizarlo dividiendo. La z
+                // se codifica con el formato del z-buffer de la escena, que puede necesitar el 1 / w:
+
+                float divisor = 1.f / vertex.w;
+
+                vertex.x *= divisor;
+                vertex.y *= divisor;
+                vertex.z *= divisor;
+
+                Point4i & screen = transformed_vertices[index] = to_screen< Scene_Depth_Format >(view->screen_transformation, vertex, divisor, view->depth_range);
+
+                transformed_facing[index] = Vector2f(vertex.x, vertex.y);
+
+                depth = std::min(depth, Scene_Depth_Format::distance_key(screen.z));
+            }
+
+            visible_depths[visible] = depth;
+        }
+
+        if (!shade_vertices) return;
+
+        Light_Vertices(lights, inverse_matriz, visible_meshlets, iluminated, transformed_colors.data());
+    }
+
+    ///Funcin que calcula el color de los vrtices de los meshlets dados a partir de las posiciones y normales que hay en
+    ///los buffers SoA de iluminacin. light_space pasa las luces puntuales del mundo al espacio de esos buffers.
+    void Model::Light_Vertices(const vector< Light > & lights, const Matrix44 & light_space, const vector< int > & visible, bool iluminated, Packed_Color * colors)
+    {
+        float * px = lighting_positions[0].data(), * py = lighting_positions[1].data(), * pz = lighting_positions[2].data();
+        float * nx = lighting_normals  [0].data(), * ny = lighting_normals  [1].data(), * nz = lighting_normals  [2].data();
+
+        if (!iluminated)
         {
-            // Se multiplican todos los vrtices originales con la matriz de transformacin y
-            // se guarda el resultado en otro vertex buffer:
+            for (int meshlet_index : visible)
+            {
+                const Meshlet & meshlet = meshlets[meshlet_index];
+
+                std::fill_n(colors + meshlet.vertex_offset, meshlet.vertex_count, Packed_Color::from(color));
+            }
 
-            Vertex& vertex = transformed_vertices[index] = view->projection * transformation * original_vertices[index];
+            return;
+        }
 
-            Vertex& n = transformed_normals[index] = transformation * original_normals[index];
+        // Se acumula la contribucin de cada luz que afecta al modelo. Cada luz recorre los
+        // vrtices en bucles sobre arrays contiguos (SoA) que el compilador puede vectorizar,
+        // por lo que el coste depende de las luces que tocan el modelo y no del total:
 
-            //Producto escalar entre el vector de luz y el vector normal
-            float intensity = glm::dot(normalize(transformed_light_vector) , normalize(n));
+        float * r = lighting_accumulation[0].data(), * g = lighting_accumulation[1].data(), * b = lighting_accumulation[2].data();
 
-            //Se clampea el resultado
-            if (intensity < 0.f)
-                intensity = 0.f;
-            else if (intensity > 1.f)
-                intensity = 1.f;
+        for (int meshlet_index : visible)
+        {
+            const Meshlet & meshlet = meshlets[meshlet_index];
 
-            //Se aplica la iluminacion a cada uno de los componentes RGB.
-            //IMPORTANTE: los componentes de los original colors deben ser divididos entre 255 para que no sea o blanco o negro.
-            if (iluminated)
+            std::fill_n(r + meshlet.vertex_offset, meshlet.vertex_count, 0.f);
+            std::fill_n(g + meshlet.vertex_offset, meshlet.vertex_count, 0.f);
+            std::fill_n(b + meshlet.vertex_offset, meshlet.vertex_count, 0.f);
+        }
+
+        for (int light_index : light_influences)
+        {
+            const Light & light = lights[light_index];
+
+            Vector3f color = light.color * light.intensity;
+
+            if (light.type == Light::DIRECTIONAL)
             {
-                transformed_colors[index].set_red(float(originals_color[index].red())/255.f * intensity);
-                transformed_colors[index].set_green(float(originals_color[index].green())/255.f * intensity);
-                transformed_colors[index].set_blue(float(originals_color[index].blue())/255.f * intensity);
+                //Producto escalar entre el vector de luz y el vector normal
+                Vector3f l = normalize(Vector3f(light.vector));
+
+                for (int meshlet_index : visible)
+                {
+                    const Meshlet & meshlet = meshlets[meshlet_index];
+
+                    for (uint32_t index = meshlet.vertex_offset, end = index + meshlet.vertex_count; index < end; index++)
+                    {
+                        float intensity = l.x * nx[index] + l.y * ny[index] + l.z * nz[index];
+
+                        intensity = intensity < 0.f ? 0.f : intensity;
+
+                        r[index] += color.x * intensity;
+                        g[index] += color.y * intensity;
+                        b[index] += color.z * intensity;
+                    }
+                }
             }
             else
             {
-                transformed_colors[index] = originals_color[index];
-            }
+                //Las luces puntuales se pasan al espacio de los vrtices y se atenan con la distancia
+                Vector4f position = light_space * light.vector;
 
+                float inverse_range_squared = 1.f / (light.range * light.range);
 
+                for (int meshlet_index : visible)
+                {
+                    const Meshlet & meshlet = meshlets[meshlet_index];
+
+                    for (uint32_t index = meshlet.vertex_offset, end = index + meshlet.vertex_count; index < end; index++)
+                    {
+                        float lx = position.x - px[index];
+                        float ly = position.y - py[index];
+                        float lz = position.z - pz[index];
 
-            // La matriz de proyeccin en perspectiva hace que el ltimo componente del vector
-            // transformado no tenga valor 1.0, por lo que hay que normalizarlo dividiendo:
+                        float distance_squared = lx * lx + ly * ly + lz * lz;
 
-            float divisor = 1.f / vertex.w;
+                        float intensity = (lx * nx[index] + ly * ny[index] + lz * nz[index]) / std::sqrt(distance_squared + 1e-12f);
 
-            vertex.x *= divisor;
-            vertex.y *= divisor;
-            vertex.z *= divisor;
-            vertex.w = 1.f;
+                        intensity = intensity < 0.f ? 0.f : intensity;
+                        intensity *= Light::attenuation(distance_squared, inverse_range_squared);
+
+                        r[index] += color.x * intensity;
+                        g[index] += color.y * intensity;
+                        b[index] += color.z * intensity;
+                    }
+                }
+            }
+        }
+
+        //Se aplica la iluminacion a cada uno de los componentes RGB.
+        //Como la iluminacin se clampea a 1, cada componente del color del modelo (de 0 a 255) se puede escalar
+        //directamente y escribir ya empaquetado en el formato del framebuffer.
+        float base_red   = float(color.red  ());
+        float base_green = float(color.green());
+        float base_blue  = float(color.blue ());
+
+        for (int meshlet_index : visible)
+        {
+            const Meshlet & meshlet = meshlets[meshlet_index];
+
+            for (uint32_t index = meshlet.vertex_offset, end = index + meshlet.vertex_count; index < end; index++)
+            {
+                //Se clampea el resultado
+                float red   = r[index] > 1.f ? 1.f : r[index];
+                float green = g[index] > 1.f ? 1.f : g[index];
+                float blue  = b[index] > 1.f ? 1.f : b[index];
+
+                colors[index] = Packed_Color(uint8_t(base_red * red), uint8_t(base_green * green), uint8_t(base_blue * blue));
+            }
         }
     }
 
-    bool Model::is_frontface(const Vertex* const projected_vertices, const int* const indices)
+    ///Funcin que rellena los buffers SoA de iluminacin con las posiciones y normales de los meshlets dados pasadas al
+    ///espacio que indica la matriz.
+    void Model::Fill_Lighting_Inputs(const Matrix44 & to_space, const vector< int > & visible)
     {
-        const Vertex& v0 = projected_vertices[indices[0]];
-        const Vertex& v1 = projected_vertices[indices[1]];
-        const Vertex& v2 = projected_vertices[indices[2]];
+        float * px = lighting_positions[0].data(), * py = lighting_positions[1].data(), * pz = lighting_positions[2].data();
+        float * nx = lighting_normals  [0].data(), * ny = lighting_normals  [1].data(), * nz = lighting_normals  [2].data();
+
+        bool     compact          = !compact_vertices.empty();
+        Matrix44 compact_to_space = to_space * quantization.dequantization();
+
+        const Vertex * source_vertices = skeleton ? skinned_vertices.data() : original_vertices.data();
+        const Vertex * source_normals  = skeleton ? skinned_normals .data() : original_normals .data();
+
+        for (int meshlet_index : visible)
+        {
+            const Meshlet & meshlet = meshlets[meshlet_index];
+
+            for (uint32_t index = meshlet.vertex_offset, end = index + meshlet.vertex_count; index < end; index++)
+            {
+                Vertex position;
+                Vertex local_normal;
 
-        // Se asumen coordenadas proyectadas y polgonos definidos en sentido horario.
-        // Se comprueba a qu lado de la lnea que pasa por v0 y v1 queda el punto v2:
+                if (compact)
+                {
+                    const Compact_Vertex & source = compact_vertices[index];
 
-        return ((v1[0] - v0[0]) * (v2[1] - v0[1]) - (v2[0] - v0[0]) * (v1[1] - v0[1]) < 0.f);
+                    position     = compact_to_space * Vertex(float(source.position[0]), float(source.position[1]), float(source.position[2]), 1.f);
+                    local_normal = Vertex(decode_octahedral(source.normal), 0.f);
+                }
+                else
+                {
+                    position     = to_space * source_vertices[index];
+                    local_normal = source_normals[index];
+                }
+
+                Vector3f normal = normalize(Vector3f(to_space * local_normal));
+
+                px[index] = position.x; py[index] = position.y; pz[index] = position.z;
+                nx[index] = normal.x;   ny[index] = normal.y;   nz[index] = normal.z;
+            }
+        }
     }
 }
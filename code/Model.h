@@ -13,7 +13,19 @@
 #include <vector>
 #include "math.hpp"
 #include <Color_Buffer.hpp>
+#include "Packed_Color_Buffer.hpp"
 #include "Rasterizer.hpp"
+#include "Light.hpp"
+#include "Meshlet.hpp"
+#include "Index_Buffer.hpp"
+#include "Compact_Vertex.hpp"
+#include "Baked_Mesh.hpp"
+#include "Bvh.hpp"
+#include "Skeleton.hpp"
+#include "Render_Queue.hpp"
+#include "Memory_Tracker.hpp"
+#include <memory>
+#include <string>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -46,24 +58,127 @@ namespace Engine
         typedef vector< Vertex >      Vertex_Buffer;
 
         typedef Rgb888                Color;
-        typedef vector< Color  >      Vertex_Color;
-
-        typedef vector< int    >      Index_Buffer;
+        typedef vector< Packed_Color > Vertex_Color;
 
 #pragma region Atributo de vertices
         Vertex_Buffer original_vertices;
         Vertex_Buffer original_normals;
-        Vertex_Color originals_color;
+        //Con 16 o 32 bits por ndice segn el nmero de vrtices. Los cargadores dejan los ndices en un vector< uint32_t >
+        //que se copia aqu al terminar de dividir el modelo en meshlets.
         Index_Buffer original_indices;
+
+        //Todos los vrtices del modelo tienen el mismo color, por lo que se guarda una sola vez
+        Color color;
+#pragma endregion
+
+#pragma region Vertices comprimidos
+        //Si use_compact_vertices est activo, las posiciones y normales se guardan en 8 bytes por vrtice y
+        //original_vertices y original_normals se quedan vacos. La decodificacin va dentro de la matriz de transformacin.
+        vector< Compact_Vertex > compact_vertices;
+        Vertex_Quantization quantization;
+
+        static bool use_compact_vertices;
 #pragma endregion
 
 #pragma region Transformacin de los atributos de los vertices
-        Vertex_Buffer transformed_vertices;
-        vector<Point4i> display_vertices;
-        Vertex_Buffer transformed_normals;
+        //El update deja cada vrtice directamente en pantalla, con la z en el formato del z-buffer, y aparte las x e y
+        //proyectadas con las que se descartan las caras traseras. Es lo nico que lee el rasterizer.
+        vector< Point4i > transformed_vertices;
+        vector< Vector2f > transformed_facing;
+        //Profundidad ms cercana en pantalla de cada meshlet de visible_meshlets, para ordenar los comandos de dibujo
+        vector< int > visible_depths;
         Vertex_Color transformed_colors;
 #pragma endregion
 
+#pragma region Frame que se est pintando
+        //El update escribe en los buffers transformed_* mientras el render lee el frame anterior de estos.
+        //Swap_Frame los intercambia cuando ninguno de los dos est trabajando.
+        vector< Point4i > rendered_vertices;
+        vector< Vector2f > rendered_facing;
+        Vertex_Color rendered_colors;
+        vector< int > rendered_meshlets;
+        vector< int > rendered_depths;
+#pragma endregion
+
+#pragma region Meshlets
+        //Clusters de tringulos en los que se divide el modelo al cargarlo, y los que han sobrevivido al culling en el ltimo update
+        vector< Meshlet > meshlets;
+        vector< int > visible_meshlets;
+#pragma endregion
+
+#pragma region Lectura por partes
+        //Si el modelo se lee de un .mesh, los meshlets se cargan del archivo cuando se ven y comparten un nmero fijo
+        //de huecos (de max_vertices vrtices cada uno) en los buffers del modelo
+        std::unique_ptr< Baked_Mesh_Reader > stream;
+        vector< int > meshlet_slot;
+        vector< int > slot_meshlet;
+        vector< unsigned > meshlet_last_frame;
+        unsigned update_frame = 0;
+        int slot_hand = 0;
+
+        //Memoria mxima de los huecos de un modelo, y tamao de OBJ a partir del cual no se importa con Assimp
+        static size_t streaming_budget;
+        static size_t streaming_threshold;
+#pragma endregion
+
+        //Nmero de tringulos del modelo completo
+        size_t triangle_count = 0;
+
+#pragma region Skinning
+        //Los modelos con huesos deforman en cada update sus vrtices en reposo (original_*) y dejan el resultado en
+        //skinned_*, que es lo que transforman el update y la iluminacin. Swap_Frame pasa la pose a rendered_skinned_*
+        //para el resolve. El esqueleto y las animaciones se comparten entre las instancias del mismo archivo.
+        std::shared_ptr< const Skeleton > skeleton;
+        vector< Skin_Influences > skin_influences;
+        vector< Skin_Matrix > skin_palette;
+        vector< Matrix44 > skin_nodes;
+        Vertex_Buffer skinned_vertices;
+        Vertex_Buffer skinned_normals;
+        Vertex_Buffer rendered_skinned_vertices;
+        Vertex_Buffer rendered_skinned_normals;
+
+        //Animacin que se reproduce, segundos que lleva y velocidad
+        int animation_clip = 0;
+        float animation_time = 0.f;
+        float animation_speed = 1.f;
+#pragma endregion
+
+#pragma region Buffer de visibilidad
+        //Con el buffer de visibilidad el update no ilumina los vrtices: el resolve sombrea despus los pxeles visibles
+        //con el estado del frame que se est pintando, que Swap_Frame copia aqu porque el update siguiente lo cambia.
+        unsigned scene_index = 0;
+        Matrix44 rendered_transformation;
+        Matrix44 rendered_compact_transformation;
+        Matrix44 rendered_view;
+        vector< int > rendered_light_influences;
+#pragma endregion
+
+#pragma region Consultas espaciales
+        //Caja del modelo en espacio local y BVH de sus tringulos. Los modelos que se leen por partes no tienen BVH de
+        //tringulos, ya que nunca estn enteros en memoria.
+        Aabb bounds;
+        Bvh triangle_bvh;
+#pragma endregion
+
+#pragma region Iluminacin
+        //Esfera que envuelve al modelo en espacio local (centro en xyz y radio en w)
+        Vector4f bounding_sphere;
+
+        //Canales de iluminacin del modelo y luces de la escena que le afectan (ndices a la lista de luces de la escena)
+        unsigned light_channels;
+        vector< int > light_influences;
+
+        //Buffers auxiliares en formato SoA para acumular la iluminacin de varias luces por vrtice
+        vector< float > lighting_positions[3];
+        vector< float > lighting_normals[3];
+        vector< float > lighting_accumulation[3];
+#pragma endregion
+
+#pragma region Memoria
+        //Bytes que el modelo tiene apuntados en cada categora del Memory_Tracker, para quitarlos al destruirse
+        size_t accounted_memory[Memory_Tracker::CATEGORY_COUNT] = {};
+#pragma endregion
+
         //Constante de PI
         const float PI = 3'1416;
 
@@ -77,18 +192,78 @@ namespace Engine
         Matrix44 translation;
         Matrix44 inverse_matriz;
         Matrix44 transformation;
+        float    scale_factor;
 
     public: 
         ///Constructor por defecto del modelo
         Model(char*, View*, float, float, float, float, float, float, float, float, float, bool);
+        ///Constructor que crea otra instancia de un modelo ya cargado (que no se lea por partes) sin volver a leer el archivo
+        Model(const Model &, View*, float, float, float, float, float, float, float, float, float, bool);
+        ///Destructor que quita la memoria del modelo de la cuenta
+        ~Model();
         float rand_clamp() { return float(rand() & 0xff) * 0.0039215f; }
-        ///Funcin que recoge las matrices y recoge los vertices que se pintarn por pantalla. Es una funcin que se llamar antes del Render.
-        void Post_Render(int, int);
-        ///Funcin que pinta los vertices del modelo, es decir, es la funcin que pinta el modelo y hace que se vea.
-        void Render(bool);
+        ///Funcin que devuelve la esfera envolvente del modelo en coordenadas del mundo.
+        Vector4f world_bounding_sphere() const;
+        ///Funcin que devuelve la caja envolvente del modelo en coordenadas del mundo.
+        Aabb world_bounds() const;
+        ///Funcin que busca el tringulo ms cercano que corta un rayo (en coordenadas del mundo) antes de la distancia dada.
+        bool Ray_Cast(const Ray &, float, float &, int &) const;
+        ///Funcin que aade los tringulos del modelo que tocan el volumen de visin de la cmara dada.
+        void Query_Frustum(const Matrix44 &, vector< int > &) const;
+        ///Funcin que deja el modelo sin nada que pintar cuando la escena sabe que queda fuera de la pantalla.
+        void Skip_Update();
+        ///Funcin que avanza la animacin los segundos dados y deforma los vrtices con la nueva pose. No hace nada si el modelo no tiene huesos.
+        void Animate(float);
+        ///Funcin que elige, por canal y por distancia, las luces de la escena que afectan al modelo.
+        void Select_Lights(const vector< Light > &);
+        ///Funcin que graba en la cola los meshlets que se pintan, como fuente de ndice scene_index. Se puede llamar a la vez para varios modelos.
+        void Render(bool, Render_Queue &);
         ///Funcin que calcula la iluminacin, y controla el movimiento de vertices.
-        void Update(const Vector4f &, bool);
-        bool is_frontface(const Vertex* const, const int* const);
+        void Update(const vector< Light > &, bool);
+        ///Funcin que descarta los meshlets que quedan de espaldas a la cmara o fuera de la pantalla.
+        void Cull_Meshlets();
+        ///Funcin que busca, sin cargar nada, los meshlets que se ven desde una cmara dada su transformacin y la matriz del modelo a la cmara.
+        void Find_Visible_Meshlets(const Matrix44 &, const Matrix44 &, const Frustum &, vector< int > &) const;
+        ///Funcin que carga los meshlets de la lista que no estn en memoria y quita los que no caben.
+        void Page_In_Meshlets(vector< int > &);
+        ///Funcin que rellena los buffers SoA de iluminacin con los vrtices de los meshlets dados pasados al espacio de la matriz.
+        void Fill_Lighting_Inputs(const Matrix44 &, const vector< int > &);
+        ///Funcin que ilumina los vrtices de los meshlets dados con los buffers SoA y escribe su color.
+        void Light_Vertices(const vector< Light > &, const Matrix44 &, const vector< int > &, bool, Packed_Color *);
+        ///Funcin que pasa el resultado del ltimo update al render. No debe llamarse mientras se ejecuta el update o el render.
+        void Swap_Frame();
+        ///Funcin que copia de otra instancia el color, las matrices y el estado en la escena, para ocupar su lugar al recargar el archivo.
+        void Take_Placement(const Model &);
+        ///Funcin que calcula el color de un tringulo del frame que se est pintando, para el resolve del buffer de visibilidad.
+        Packed_Color Shade_Triangle(int, const vector< Light > &) const;
+
+    private:
+        ///Funcin que lee la geometra del modelo, o lo abre por partes, y la prepara para pintarla.
+        void Load(char*);
+        ///Funcin que fija el color, las matrices y el estado inicial del modelo.
+        void Place(float, float, float, float, float, float, float, float, float, bool);
+        ///Funcin que reserva los buffers por vrtice que se rellenan en cada frame.
+        void Allocate_Buffers(size_t);
+        ///Funcin que apunta en el Memory_Tracker lo que ocupan la geometra y los buffers del modelo.
+        void Account_Memory();
+        ///Funcin que reserva la paleta de huesos y los buffers de la pose, que empiezan con la pose de reposo.
+        void Allocate_Skinning();
+        ///Funcin que recalcula las esferas de los meshlets y la caja del modelo con los vrtices deformados.
+        void Update_Skinned_Bounds();
+        ///Funcin que lee el modelo de un paquete de assets montado, ya dividido en meshlets. Devuelve false si no est en ninguno.
+        bool Load_Packed(const std::string &);
+        ///Funcin que abre el modelo por partes si es un .mesh o un OBJ mayor que streaming_threshold. Devuelve false si hay que importarlo con Assimp.
+        bool Open_Stream(const std::string &);
+        ///Funcin que lee del archivo un meshlet visible y lo coloca en un hueco libre o en el que lleva ms tiempo sin verse.
+        bool Page_In(int);
+        ///Funcin que pasa los vrtices cargados al formato comprimido y libera los originales.
+        void Compress_Vertices(const Vector3f &, const Vector3f &);
+        ///Funcin que construye la BVH de los tringulos del modelo.
+        void Build_Triangle_Bvh();
+        ///Funcin que devuelve la posicin en espacio local de un vrtice, est comprimido o no.
+        Vector3f Local_Position(int) const;
+
+    public:
         //function to calculate dot product of two vectors
         int dot_product(Vector3f, Vertex);
 
@@ -0,0 +1,230 @@
+/**
+* @file Multi_View_Renderer.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que pinta la escena desde muchas cámaras en una sola llamada, compartiendo entre todas las vistas el trabajo
+* que no depende de la cámara y repartiendo las vistas entre los núcleos
+**/
+
+#include "Multi_View_Renderer.hpp"
+#include "Parallel.hpp"
+#include "Rasterizer.hpp"
+#include "Stats.hpp"
+#include "View.hpp"
+
+namespace Engine
+{
+    using std::vector;
+
+    ///Pinta todas las vistas y deja en images una imagen por vista, en el mismo orden
+    void Multi_View_Renderer::render (const vector< Batch_View > & views, vector< Packed_Color_Buffer > & images)
+    {
+        ENGINE_STATS_SCOPE("multi_view", -1);
+
+        size_t number_of_views  = views.size ();
+        size_t number_of_models = scene.total_models.size ();
+
+        images.clear ();
+        images.reserve (number_of_views);
+
+        for (const Batch_View & view : views)
+        {
+            images.emplace_back (view.width, view.height);
+        }
+
+        view_meshlets.resize (number_of_views * number_of_models);
+        model_colors .resize (number_of_models);
+
+        // Lo que depende de la cámara se reparte por vistas y lo que no, por modelos:
+
+        parallel_for (number_of_views, [&] (size_t view_index)
+        {
+            find_visible_meshlets (view_index, views[view_index]);
+        });
+
+        parallel_for (number_of_models, [&] (size_t model_index)
+        {
+            light_model (model_index, number_of_views);
+        });
+
+        parallel_for (number_of_views, [&] (size_t view_index)
+        {
+            render_view (view_index, views[view_index], images[view_index]);
+        });
+    }
+
+    ///Busca los meshlets que ve una vista de cada modelo
+    void Multi_View_Renderer::find_visible_meshlets (size_t view_index, const Batch_View & view)
+    {
+        Matrix44 view_matrix = inverse (view.camera_transformation);
+        Frustum  frustum     = Frustum::from_projection (View::projection_for (view.width, view.height));
+
+        size_t number_of_models = scene.total_models.size ();
+
+        for (size_t model_index = 0; model_index < number_of_models; ++model_index)
+        {
+            const Model   & model   = *scene.total_models[model_index];
+            vector< int > & visible = view_meshlets[view_index * number_of_models + model_index];
+
+            visible.clear ();
+
+            if (!model.isActive) continue;
+
+            Matrix44 transformation = view_matrix * model.translation * model.rotation_y * model.scaling;
+
+            model.Find_Visible_Meshlets (view.camera_transformation, transformation, frustum, visible);
+        }
+    }
+
+    ///Carga los meshlets que ve alguna vista de un modelo y calcula su iluminación
+    void Multi_View_Renderer::light_model (size_t model_index, size_t number_of_views)
+    {
+        Model & model            = *scene.total_models[model_index];
+        size_t  number_of_models = scene.total_models.size ();
+
+        // Se juntan los meshlets de todas las vistas para cargarlos e iluminarlos una sola vez:
+
+        vector< char > seen(model.meshlets.size (), 0);
+        vector< int  > shared;
+
+        for (size_t view_index = 0; view_index < number_of_views; ++view_index)
+        {
+            for (int meshlet_index : view_meshlets[view_index * number_of_models + model_index])
+            {
+                if (!seen[meshlet_index])
+                {
+                    seen[meshlet_index] = 1;
+                    shared.push_back (meshlet_index);
+                }
+            }
+        }
+
+        if (shared.empty ()) return;
+
+        //Los meshlets se marcan como vistos en el update actual sin avanzarlo, por lo que no se reutilizan los huecos
+        //del frame que se está pintando en la ventana
+        model.Page_In_Meshlets (shared);
+
+        vector< Packed_Color > & colors = model_colors[model_index];
+
+        colors.resize (model.transformed_colors.size ());
+
+        model.Select_Lights        (scene.lights);
+        model.Fill_Lighting_Inputs (model.translation * model.rotation_y * model.scaling, shared);
+        model.Light_Vertices       (scene.lights, Matrix44(1), shared, model.light_channels != 0, colors.data ());
+    }
+
+    ///Pinta una vista en su imagen
+    void Multi_View_Renderer::render_view (size_t view_index, const Batch_View & view, Packed_Color_Buffer & image) const
+    {
+        typedef Model::Vertex Vertex;
+
+        Rasterizer< Packed_Color_Buffer > rasterizer(image);
+
+        rasterizer.clear ();
+
+        Matrix44    projection  = View::projection_for (view.width, view.height);
+        Matrix44    view_matrix = inverse (view.camera_transformation);
+        Depth_Range depth_range = Depth_Range::from_projection (projection);
+
+        //Misma transformación a pantalla y misma profundidad que Model::Update
+        Matrix44 identity(1);
+        Matrix44 screen_transformation = translate (identity, Vector3f{ float(view.width / 2), float(view.height / 2), 0.f })
+                                       * scale     (identity, float(view.width / 2), float(view.height / 2), 1.f);
+
+        vector< Vector2f > facing;
+        vector< Point4i  > screen;
+
+        size_t number_of_models = scene.total_models.size ();
+
+        ENGINE_STATS_LOCAL(uint64_t triangles_rasterized = 0;)
+
+        for (size_t model_index = 0; model_index < number_of_models; ++model_index)
+        {
+            const Model                  & model   = *scene.total_models[model_index];
+            const vector< int >          & visible = view_meshlets[view_index * number_of_models + model_index];
+            const vector< Packed_Color > & colors  = model_colors[model_index];
+
+            if (visible.empty ()) continue;
+
+            facing.resize (model.transformed_vertices.size ());
+            screen.resize (model.transformed_vertices.size ());
+
+            bool     compact                = !model.compact_vertices.empty ();
+            Matrix44 transformation         = view_matrix * model.translation * model.rotation_y * model.scaling;
+            Matrix44 compact_transformation = transformation * model.quantization.dequantization ();
+
+            //Los modelos con huesos se pintan con la pose del último Animate
+            const Vertex * source_vertices  = model.skeleton ? model.skinned_vertices.data () : model.original_vertices.data ();
+
+            //Los meshlets que no cupieron en los huecos de un modelo que se lee por partes no se pintan
+            auto loaded = [&] (int meshlet_index) { return !model.stream || model.meshlet_slot[meshlet_index] >= 0; };
+
+            for (int meshlet_index : visible)
+            {
+                if (!loaded (meshlet_index)) continue;
+
+                const Meshlet & meshlet = model.meshlets[meshlet_index];
+
+                for (uint32_t index = meshlet.vertex_offset, end = index + meshlet.vertex_count; index < end; index++)
+                {
+                    Vertex position;
+
+                    if (compact)
+                    {
+                        const Compact_Vertex & source = model.compact_vertices[index];
+
+                        position = compact_transformation * Vertex(float(source.position[0]), float(source.position[1]), float(source.position[2]), 1.f);
+                    }
+                    else
+                        position = transformation * source_vertices[index];
+
+                    Vertex vertex = projection * position;
+
+                    float divisor = 1.f / vertex.w;
+
+                    vertex.x *= divisor;
+                    vertex.y *= divisor;
+                    vertex.z *= divisor;
+                    vertex.w = 1.f;
+
+                    //Como en Model::Update, solo se guarda lo que lee el rasterizer y la x y la y para las caras traseras
+                    facing[index] = Vector2f(vertex.x, vertex.y);
+                    screen[index] = to_screen< Scene_Depth_Format > (screen_transformation, vertex, divisor, depth_range);
+                }
+            }
+
+            for (int meshlet_index : visible)
+            {
+                if (!loaded (meshlet_index)) continue;
+
+                const Meshlet & meshlet = model.meshlets[meshlet_index];
+
+                model.original_indices.visit
+                (
+                    [&] (const auto * index_buffer)
+                    {
+                        for (auto indices = index_buffer + meshlet.index_offset, end = indices + meshlet.index_count; indices < end; indices += 3)
+                        {
+                            if (is_frontface (facing.data (), indices))
+                            {
+                                rasterizer.set_color (colors[*indices]);
+                                rasterizer.fill_convex_polygon_z_buffer (screen.data (), indices, indices + 3);
+
+                                ENGINE_STATS_LOCAL(triangles_rasterized++;)
+                            }
+                        }
+                    }
+                );
+            }
+        }
+
+        ENGINE_STATS_ADD(triangles_rasterized, triangles_rasterized);
+
+        rasterizer.flush_stats ();
+    }
+}
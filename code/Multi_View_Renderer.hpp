@@ -0,0 +1,74 @@
+/**
+* @file Multi_View_Renderer.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que pinta la escena desde muchas cámaras en una sola llamada, compartiendo entre todas las vistas el trabajo
+* que no depende de la cámara y repartiendo las vistas entre los núcleos
+**/
+
+#ifndef MULTI_VIEW_RENDERER_HEADER
+#define MULTI_VIEW_RENDERER_HEADER
+
+    #include <vector>
+    #include "math.hpp"
+    #include "Packed_Color_Buffer.hpp"
+
+    namespace Engine
+    {
+
+        class View;
+
+        ///Cámara de un lote y medidas de la imagen que se pinta desde ella
+        struct Batch_View
+        {
+            Matrix44 camera_transformation;
+            unsigned width;
+            unsigned height;
+        };
+
+        ///Cada llamada a render busca en paralelo los meshlets que ve cada cámara, carga e ilumina una sola vez por
+        ///modelo la unión de todos ellos, y después pinta las vistas en paralelo, cada una con su framebuffer, su
+        ///rasterizer y sus buffers de vértices. Para que la iluminación no dependa de la cámara se calcula en coordenadas
+        ///del mundo, de forma que las luces direccionales se interpretan como direcciones del mundo.
+        class Multi_View_Renderer
+        {
+            View & scene;
+
+            ///Color iluminado de los vértices de cada modelo, compartido por todas las vistas
+            std::vector< std::vector< Packed_Color > > model_colors;
+
+            ///Meshlets que ve cada vista de cada modelo (índice vista * número de modelos + modelo)
+            std::vector< std::vector< int > > view_meshlets;
+
+        public:
+
+            Multi_View_Renderer(View & scene) : scene(scene)
+            {
+            }
+
+            Multi_View_Renderer(const Multi_View_Renderer &) = delete;
+            Multi_View_Renderer & operator = (const Multi_View_Renderer &) = delete;
+
+            ///Pinta todas las vistas y deja en images una imagen por vista, en el mismo orden. Usa la escena tal y como
+            ///está, por lo que no debe llamarse mientras se ejecuta su update o su render.
+            void render (const std::vector< Batch_View > & views, std::vector< Packed_Color_Buffer > & images);
+
+        private:
+
+            ///Busca los meshlets que ve una vista de cada modelo
+            void find_visible_meshlets (size_t view_index, const Batch_View &);
+
+            ///Carga los meshlets que ve alguna vista de un modelo y calcula su iluminación
+            void light_model (size_t model_index, size_t number_of_views);
+
+            ///Pinta una vista en su imagen
+            void render_view (size_t view_index, const Batch_View &, Packed_Color_Buffer & image) const;
+        };
+
+    }
+
+#endif
@@ -0,0 +1,333 @@
+/**
+* @file Obj_Loader.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que importa archivos OBJ sin pasar por Assimp: proyecta el archivo en memoria, lo lee por bloques en paralelo
+* y une los vértices idénticos, dejando los datos directamente en los buffers del modelo
+**/
+
+#include "Obj_Loader.hpp"
+#include "Index_Buffer.hpp"
+#include "Mapped_File.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace Engine
+{
+    using std::vector;
+
+    namespace
+    {
+        ///Tamaño mínimo de cada bloque del archivo que se lee en un hilo
+        const size_t min_chunk_size = size_t(256) << 10;
+
+        ///Esquina de una cara. Los índices negativos del OBJ son relativos a los vértices leídos hasta esa línea,
+        ///y como cada bloque no sabe cuántos hay antes que él, se guardan relativos al bloque y se resuelven al final.
+        struct Corner
+        {
+            int64_t position;
+            int64_t normal;                             ///< -1 si no tiene normal
+            bool    position_relative;
+            bool    normal_relative;
+        };
+
+        struct Chunk
+        {
+            const char *       begin;
+            const char *       end;
+
+            vector< Vector3f > positions;
+            vector< Vector3f > normals;
+            vector< Corner   > corners;
+            vector< uint32_t > face_sizes;
+
+            bool               failed = false;
+        };
+
+        inline const char * skip_spaces (const char * cursor, const char * end)
+        {
+            while (cursor < end && (*cursor == ' ' || *cursor == '\t')) cursor++;
+
+            return cursor;
+        }
+
+        inline const char * parse_float (const char * cursor, const char * end, float & value, bool & failed)
+        {
+            cursor = skip_spaces (cursor, end);
+
+            if (cursor < end && *cursor == '+') cursor++;
+
+            auto result = std::from_chars (cursor, end, value);
+
+            if (result.ec != std::errc()) failed = true;
+
+            return result.ptr;
+        }
+
+        inline const char * parse_index (const char * cursor, const char * end, int64_t & value, bool & failed)
+        {
+            auto result = std::from_chars (cursor, end, value);
+
+            if (result.ec != std::errc() || value == 0) failed = true;
+
+            return result.ptr;
+        }
+
+        void parse_chunk (Chunk & chunk)
+        {
+            const char * cursor = chunk.begin;
+            const char * end    = chunk.end;
+
+            while (cursor < end && !chunk.failed)
+            {
+                const char * line_end = static_cast< const char * >(std::memchr (cursor, '\n', size_t(end - cursor)));
+
+                if (!line_end) line_end = end;
+
+                const char * line = skip_spaces (cursor, line_end);
+
+                if (line_end - line > 2 && line[0] == 'v' && line[1] == ' ')
+                {
+                    float x, y, z;
+
+                    line = parse_float (line + 2, line_end, x, chunk.failed);
+                    line = parse_float (line,     line_end, y, chunk.failed);
+                    line = parse_float (line,     line_end, z, chunk.failed);
+
+                    chunk.positions.push_back (Vector3f(x, y, z));
+                }
+                else
+                if (line_end - line > 3 && line[0] == 'v' && line[1] == 'n' && line[2] == ' ')
+                {
+                    float x, y, z;
+
+                    line = parse_float (line + 3, line_end, x, chunk.failed);
+                    line = parse_float (line,     line_end, y, chunk.failed);
+                    line = parse_float (line,     line_end, z, chunk.failed);
+
+                    chunk.normals.push_back (Vector3f(x, y, z));
+                }
+                else
+                if (line_end - line > 2 && line[0] == 'f' && line[1] == ' ')
+                {
+                    uint32_t corners = 0;
+
+                    line += 2;
+
+                    while (true)
+                    {
+                        line = skip_spaces (line, line_end);
+
+                        if (line >= line_end || *line == '\r') break;
+
+                        // v, v/vt, v//vn o v/vt/vn:
+
+                        Corner corner;
+                        int64_t texture;
+
+                        line = parse_index (line, line_end, corner.position, chunk.failed);
+
+                        corner.normal = 0;
+
+                        if (line < line_end && *line == '/')
+                        {
+                            line++;
+
+                            if (line < line_end && *line != '/') line = parse_index (line, line_end, texture, chunk.failed);
+
+                            if (line < line_end && *line == '/')
+                            {
+                                line = parse_index (line + 1, line_end, corner.normal, chunk.failed);
+                            }
+                        }
+
+                        if (chunk.failed) break;
+
+                        corner.position_relative = corner.position < 0;
+                        corner.normal_relative   = corner.normal   < 0;
+                        corner.position          = corner.position < 0 ? int64_t(chunk.positions.size ()) + corner.position : corner.position - 1;
+                        corner.normal            = corner.normal   < 0 ? int64_t(chunk.normals  .size ()) + corner.normal   : corner.normal   - 1;
+
+                        chunk.corners.push_back (corner);
+                        corners++;
+                    }
+
+                    if (corners < 3) chunk.failed = true;
+
+                    chunk.face_sizes.push_back (corners);
+                }
+
+                cursor = line_end + 1;
+            }
+        }
+
+        ///Clave de un vértice para unir los que son idénticos: los bits de su posición y de su normal
+        struct Vertex_Key
+        {
+            uint32_t bits[6];
+
+            bool operator == (const Vertex_Key & other) const
+            {
+                return std::memcmp (bits, other.bits, sizeof(bits)) == 0;
+            }
+        };
+
+        struct Vertex_Key_Hash
+        {
+            size_t operator () (const Vertex_Key & key) const
+            {
+                uint64_t hash = 14695981039346656037ull;
+
+                for (uint32_t bits : key.bits)
+                {
+                    hash = (hash ^ bits) * 1099511628211ull;
+                }
+
+                return size_t(hash ^ (hash >> 32));
+            }
+        };
+    }
+
+    ///Lee un OBJ triangulando sus polígonos en abanico y uniendo los vértices con la misma posición y normal
+    bool load_obj (const std::string & path, vector< Point4f > & vertices, vector< Point4f > & normals, vector< uint32_t > & indices)
+    {
+        Mapped_File file;
+
+        if (!file.open (path)) return false;
+
+        // Se divide el archivo en bloques que empiezan siempre al principio de una línea:
+
+        const char * data = file.data ();
+        const char * end  = data + file.size ();
+
+        size_t number_of_chunks = std::max (size_t(1), std::min (size_t(worker_count ()) * 4, file.size () / min_chunk_size));
+
+        vector< Chunk > chunks(number_of_chunks);
+
+        const char * begin = data;
+
+        for (size_t index = 0; index < number_of_chunks; ++index)
+        {
+            const char * chunk_end = index + 1 == number_of_chunks ? end : data + file.size () * (index + 1) / number_of_chunks;
+
+            if (chunk_end < begin) chunk_end = begin;
+
+            const char * newline = static_cast< const char * >(std::memchr (chunk_end, '\n', size_t(end - chunk_end)));
+
+            chunk_end = newline ? newline + 1 : end;
+
+            chunks[index].begin = begin;
+            chunks[index].end   = chunk_end;
+
+            begin = chunk_end;
+        }
+
+        parallel_for (number_of_chunks, [&chunks] (size_t index) { parse_chunk (chunks[index]); });
+
+        // Se juntan las posiciones y normales de todos los bloques y se resuelven los índices relativos:
+
+        vector< size_t > position_base(number_of_chunks + 1, 0);
+        vector< size_t > normal_base  (number_of_chunks + 1, 0);
+
+        for (size_t index = 0; index < number_of_chunks; ++index)
+        {
+            if (chunks[index].failed) return false;
+
+            position_base[index + 1] = position_base[index] + chunks[index].positions.size ();
+            normal_base  [index + 1] = normal_base  [index] + chunks[index].normals  .size ();
+        }
+
+        vector< Vector3f > positions(position_base.back ());
+        vector< Vector3f > file_normals(normal_base.back ());
+
+        parallel_for (number_of_chunks, [&] (size_t index)
+        {
+            Chunk & chunk = chunks[index];
+
+            std::copy (chunk.positions.begin (), chunk.positions.end (), positions   .begin () + position_base[index]);
+            std::copy (chunk.normals  .begin (), chunk.normals  .end (), file_normals.begin () + normal_base  [index]);
+
+            for (Corner & corner : chunk.corners)
+            {
+                if (corner.position_relative) corner.position += int64_t(position_base[index]);
+                if (corner.normal_relative  ) corner.normal   += int64_t(normal_base  [index]);
+
+                if (corner.position < 0 || corner.position >= int64_t(positions   .size ())) chunk.failed = true;
+                if (corner.normal   >= int64_t(file_normals.size ()))                          chunk.failed = true;
+            }
+
+            vector< Vector3f > ().swap (chunk.positions);
+            vector< Vector3f > ().swap (chunk.normals  );
+        });
+
+        // Se generan los vértices únicos y los triángulos en el orden del archivo:
+
+        vertices.clear ();
+        normals .clear ();
+        indices .clear ();
+
+        std::unordered_map< Vertex_Key, uint32_t, Vertex_Key_Hash > unique_vertices;
+
+        unique_vertices.reserve (positions.size ());
+
+        vector< uint32_t > face;
+
+        for (Chunk & chunk : chunks)
+        {
+            if (chunk.failed) return false;
+
+            const Corner * corner = chunk.corners.data ();
+
+            for (uint32_t face_size : chunk.face_sizes)
+            {
+                face.clear ();
+
+                for (uint32_t index = 0; index < face_size; ++index, ++corner)
+                {
+                    Vector3f position = positions[size_t(corner->position)];
+                    Vector3f normal   = corner->normal >= 0 ? file_normals[size_t(corner->normal)] : Vector3f(0.f, 0.f, 0.f);
+
+                    Vertex_Key key;
+
+                    std::memcpy (key.bits,     &position.x, sizeof(float) * 3);
+                    std::memcpy (key.bits + 3, &normal.x,   sizeof(float) * 3);
+
+                    auto inserted = unique_vertices.emplace (key, uint32_t(vertices.size ()));
+
+                    if (inserted.second)
+                    {
+                        //Los vértices y los índices tienen que caber en 32 bits, como en Index_Buffer
+                        if (vertices.size () >= Index_Buffer::max_count) return false;
+
+                        vertices.push_back (Point4f(position.x, -position.y, position.z, 1.f));
+                        normals .push_back (Point4f(normal, 0.f));
+                    }
+
+                    face.push_back (inserted.first->second);
+                }
+
+                if (face.size () > 2 && indices.size () + (face.size () - 2) * 3 > Index_Buffer::max_count) return false;
+
+                for (size_t index = 2; index < face.size (); ++index)
+                {
+                    indices.push_back (face[0]);
+                    indices.push_back (face[index - 1]);
+                    indices.push_back (face[index]);
+                }
+            }
+
+            vector< Corner > ().swap (chunk.corners);
+        }
+
+        return !vertices.empty ();
+    }
+}
@@ -0,0 +1,38 @@
+/**
+* @file Obj_Loader.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que importa archivos OBJ sin pasar por Assimp: proyecta el archivo en memoria, lo lee por bloques en paralelo
+* y une los vértices idénticos, dejando los datos directamente en los buffers del modelo
+**/
+
+#ifndef OBJ_LOADER_HEADER
+#define OBJ_LOADER_HEADER
+
+    #include <cstdint>
+    #include <string>
+    #include <vector>
+    #include "math.hpp"
+
+    namespace Engine
+    {
+
+        ///Lee un OBJ triangulando sus polígonos en abanico y uniendo los vértices con la misma posición y normal
+        ///(como aiProcess_Triangulate | aiProcess_JoinIdenticalVertices). La Y de las posiciones se invierte igual
+        ///que al importar con Assimp. Devuelve false si el archivo no existe, no se puede interpretar o tiene más
+        ///índices de los que caben en Index_Buffer::max_count.
+        bool load_obj
+        (
+            const std::string      & path,
+            std::vector< Point4f  > & vertices,
+            std::vector< Point4f  > & normals,
+            std::vector< uint32_t > & indices
+        );
+
+    }
+
+#endif
@@ -0,0 +1,261 @@
+/**
+* @file Obj_Streamer.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que importa archivos OBJ por partes de tamaño fijo y escribe los meshlets en formato .mesh según se completan,
+* sin tener nunca en memoria la malla final ni la escena de Assimp
+**/
+
+#include "Obj_Streamer.hpp"
+#include "Baked_Mesh.hpp"
+#include "Meshlet.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace Engine
+{
+    using std::vector;
+
+    namespace
+    {
+        class Obj_Stream_Parser
+        {
+            Baked_Mesh_Writer & writer;
+            Meshlet_Builder     builder;
+
+            vector< Vector3f >  positions;
+            vector< Vector3f >  normals;
+
+            vector< Point4f >   meshlet_vertices;
+            vector< Point4f >   meshlet_normals;
+
+            vector< uint64_t >  face;
+
+        public:
+
+            bool failed = false;
+
+            Obj_Stream_Parser(Baked_Mesh_Writer & writer) : writer(writer)
+            {
+            }
+
+            ///Procesa una línea terminada en '\0'
+            void parse_line (char * line)
+            {
+                while (*line == ' ' || *line == '\t') line++;
+
+                if (line[0] == 'v' && line[1] == ' ')
+                {
+                    char * cursor = line + 2;
+
+                    float x = std::strtof (cursor, &cursor);
+                    float y = std::strtof (cursor, &cursor);
+                    float z = std::strtof (cursor, &cursor);
+
+                    //Igual que al importar con Assimp, la Y de las posiciones se invierte
+                    positions.push_back (Vector3f(x, -y, z));
+                }
+                else
+                if (line[0] == 'v' && line[1] == 'n' && line[2] == ' ')
+                {
+                    char * cursor = line + 3;
+
+                    float x = std::strtof (cursor, &cursor);
+                    float y = std::strtof (cursor, &cursor);
+                    float z = std::strtof (cursor, &cursor);
+
+                    normals.push_back (Vector3f(x, y, z));
+                }
+                else
+                if (line[0] == 'f' && line[1] == ' ')
+                {
+                    parse_face (line + 2);
+                }
+            }
+
+            ///Escribe el último meshlet
+            void finish ()
+            {
+                flush ();
+            }
+
+        private:
+
+            ///Convierte un índice del OBJ (base 1, o negativo si es relativo al final) en base 0
+            static long resolve (long index, size_t count)
+            {
+                return index < 0 ? long(count) + index : index - 1;
+            }
+
+            void parse_face (char * cursor)
+            {
+                face.clear ();
+
+                while (true)
+                {
+                    while (*cursor == ' ' || *cursor == '\t') cursor++;
+
+                    if (*cursor == '\0' || *cursor == '\r') break;
+
+                    // Cada esquina es v, v/vt, v//vn o v/vt/vn. La clave del vértice combina posición y normal:
+
+                    long position = resolve (std::strtol (cursor, &cursor, 10), positions.size ());
+                    long normal   = -1;
+
+                    if (*cursor == '/')
+                    {
+                        cursor++;
+
+                        if (*cursor != '/') std::strtol (cursor, &cursor, 10);
+
+                        if (*cursor == '/')
+                        {
+                            cursor++;
+                            normal = resolve (std::strtol (cursor, &cursor, 10), normals.size ());
+                        }
+                    }
+
+                    while (*cursor && *cursor != ' ' && *cursor != '\t' && *cursor != '\r') cursor++;
+
+                    if (position < 0 || size_t(position) >= positions.size ()) { failed = true; return; }
+
+                    face.push_back ((uint64_t(position) << 32) | uint64_t(uint32_t(normal + 1)));
+                }
+
+                // Los polígonos se triangulan en abanico desde la primera esquina:
+
+                for (size_t corner = 2; corner < face.size (); ++corner)
+                {
+                    uint64_t triangle[3] = { face[0], face[corner - 1], face[corner] };
+
+                    if (!builder.fits (triangle)) flush ();
+
+                    builder.add (triangle);
+                }
+            }
+
+            void flush ()
+            {
+                if (builder.empty ()) return;
+
+                meshlet_vertices.clear ();
+                meshlet_normals .clear ();
+
+                for (uint64_t key : builder.vertex_keys ())
+                {
+                    size_t position = size_t(key >> 32);
+                    size_t normal   = size_t(key & 0xffffffffu);
+
+                    meshlet_vertices.push_back (Point4f(positions[position], 1.f));
+                    meshlet_normals .push_back (normal > 0 && normal <= normals.size () ? Point4f(normals[normal - 1], 0.f) : Point4f(0.f, 0.f, 0.f, 0.f));
+                }
+
+                const vector< int > & indices = builder.local_indices ();
+
+                if (!writer.write (meshlet_vertices.data (), meshlet_normals.data (), int(meshlet_vertices.size ()), indices.data (), int(indices.size ())))
+                {
+                    failed = true;
+                }
+
+                builder.clear ();
+            }
+        };
+    }
+
+    ///Convierte un OBJ en un archivo .mesh leyéndolo en bloques de chunk_size bytes
+    bool bake_obj_streaming (const std::string & obj_path, const std::string & baked_path, size_t chunk_size)
+    {
+        FILE * file = std::fopen (obj_path.c_str (), "rb");
+
+        if (!file) return false;
+
+        // Se escribe en un archivo temporal y se renombra al terminar, como en el conversor. Así un bake interrumpido no
+        // deja un .mesh más nuevo que el OBJ que se daría por bueno, y quien esté leyendo el .mesh anterior sigue con
+        // su archivo en lugar de ver cómo se sobrescribe:
+
+        std::string temporary = baked_path + ".tmp";
+
+        Baked_Mesh_Writer writer;
+
+        if (!writer.open (temporary))
+        {
+            std::fclose (file);
+            return false;
+        }
+
+        Obj_Stream_Parser parser(writer);
+
+        // Se lee el archivo por bloques. La última línea de cada bloque puede estar a medias, así que se mueve
+        // al principio del buffer y se completa con el bloque siguiente:
+
+        vector< char > buffer(chunk_size + 1);
+        size_t         pending = 0;
+
+        while (!parser.failed)
+        {
+            size_t read = std::fread (buffer.data () + pending, 1, chunk_size - pending, file);
+            size_t size = pending + read;
+
+            if (size == 0) break;
+
+            char * begin = buffer.data ();
+            char * end   = begin + size;
+            char * line  = begin;
+
+            for (char * cursor = begin; cursor < end; ++cursor)
+            {
+                if (*cursor == '\n')
+                {
+                    *cursor = '\0';
+                    parser.parse_line (line);
+                    line = cursor + 1;
+                }
+            }
+
+            pending = size_t(end - line);
+
+            if (read == 0)
+            {
+                //Última línea sin salto de línea
+                *end = '\0';
+                parser.parse_line (line);
+                break;
+            }
+
+            if (pending == chunk_size)
+            {
+                //Una línea más larga que el bloque no es un OBJ válido
+                parser.failed = true;
+                break;
+            }
+
+            std::memmove (begin, line, pending);
+        }
+
+        std::fclose (file);
+
+        parser.finish ();
+
+        bool ok = writer.close () && !parser.failed;
+
+        std::error_code error;
+
+        if (ok) std::filesystem::rename (temporary, baked_path, error);
+
+        if (!ok || error)
+        {
+            std::remove (temporary.c_str ());
+            return false;
+        }
+
+        return true;
+    }
+}
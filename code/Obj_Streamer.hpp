@@ -0,0 +1,29 @@
+/**
+* @file Obj_Streamer.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que importa archivos OBJ por partes de tamaño fijo y escribe los meshlets en formato .mesh según se completan,
+* sin tener nunca en memoria la malla final ni la escena de Assimp
+**/
+
+#ifndef OBJ_STREAMER_HEADER
+#define OBJ_STREAMER_HEADER
+
+    #include <cstddef>
+    #include <string>
+
+    namespace Engine
+    {
+
+        ///Convierte un OBJ en un archivo .mesh leyéndolo en bloques de chunk_size bytes. Además del bloque y de un
+        ///meshlet en construcción, solo se guardan en memoria las posiciones y normales del OBJ, porque las caras
+        ///pueden referenciar cualquier vértice anterior. El .mesh solo se sustituye si el bake termina bien.
+        bool bake_obj_streaming (const std::string & obj_path, const std::string & baked_path, size_t chunk_size = size_t(1) << 20);
+
+    }
+
+#endif
@@ -0,0 +1,55 @@
+/**
+* @file Packed_Color_Buffer.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda el framebuffer de color con un píxel empaquetado en 32 bits, y las funciones que rellenan tramos
+* enteros de una scanline (con o sin máscara) escribiendo varios píxeles por instrucción
+**/
+
+#include "Packed_Color_Buffer.hpp"
+#include <fstream>
+#include <SFML/OpenGL.hpp>
+
+namespace Engine
+{
+    ///Copia el buffer a la ventana con OpenGL, ampliándolo con los factores dados si se pinta a menos resolución.
+    ///La ampliación la hace glPixelZoom al copiar, sin pasar por otro buffer.
+    void Packed_Color_Buffer::blit_to_window (float zoom_x, float zoom_y) const
+    {
+        glPixelZoom  (zoom_x, zoom_y);
+        glDrawPixels (GLsizei(width), GLsizei(height), GL_RGBA, GL_UNSIGNED_BYTE, buffer.data ());
+        glPixelZoom  (1.f, 1.f);
+    }
+
+    ///Guarda el buffer como imagen PPM binaria, con las filas en el mismo orden que en memoria
+    bool Packed_Color_Buffer::save_ppm (const std::string & path) const
+    {
+        std::ofstream file(path, std::ios::binary);
+
+        if (!file) return false;
+
+        file << "P6\n" << width << ' ' << height << "\n255\n";
+
+        std::vector< uint8_t > row(size_t(width) * 3);
+
+        for (unsigned y = 0; y < height; ++y)
+        {
+            const Color * pixels = buffer.data () + size_t(y) * width;
+
+            for (unsigned x = 0; x < width; ++x)
+            {
+                row[x * 3    ] = pixels[x].red   ();
+                row[x * 3 + 1] = pixels[x].green ();
+                row[x * 3 + 2] = pixels[x].blue  ();
+            }
+
+            file.write (reinterpret_cast< const char * >(row.data ()), std::streamsize(row.size ()));
+        }
+
+        return bool(file);
+    }
+}
@@ -0,0 +1,172 @@
+/**
+* @file Packed_Color_Buffer.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda el framebuffer de color con un píxel empaquetado en 32 bits, y las funciones que rellenan tramos
+* enteros de una scanline (con o sin máscara) escribiendo varios píxeles por instrucción
+**/
+
+#ifndef PACKED_COLOR_BUFFER_HEADER
+#define PACKED_COLOR_BUFFER_HEADER
+
+    #include <cstdint>
+    #include <string>
+    #include <vector>
+
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #include <emmintrin.h>
+        #define PACKED_COLOR_BUFFER_SSE2
+    #endif
+
+    namespace Engine
+    {
+
+        ///Color de 32 bits con los bytes en el orden R, G, B, A en memoria, que es el que espera glDrawPixels
+        ///con GL_RGBA y GL_UNSIGNED_BYTE (se asume una CPU little endian)
+        struct Packed_Color
+        {
+            uint32_t value;
+
+            Packed_Color() : value(0xff000000u)
+            {
+            }
+
+            Packed_Color(uint8_t red, uint8_t green, uint8_t blue)
+            :
+                value(uint32_t(red) | uint32_t(green) << 8 | uint32_t(blue) << 16 | 0xff000000u)
+            {
+            }
+
+            ///Convierte cualquier color que tenga red(), green() y blue() en bytes
+            template< class COLOR >
+            static Packed_Color from (const COLOR & color)
+            {
+                return Packed_Color(uint8_t(color.red ()), uint8_t(color.green ()), uint8_t(color.blue ()));
+            }
+
+            uint8_t red   () const { return uint8_t(value      ); }
+            uint8_t green () const { return uint8_t(value >>  8); }
+            uint8_t blue  () const { return uint8_t(value >> 16); }
+        };
+
+        static_assert (sizeof(Packed_Color) == sizeof(uint32_t), "Packed_Color debe ocupar 32 bits");
+
+        class Packed_Color_Buffer
+        {
+        public:
+
+            typedef Packed_Color Color;
+
+        private:
+
+            unsigned              width;
+            unsigned              height;
+            std::vector< Color >  buffer;
+            Color                 color;
+
+        public:
+
+            Packed_Color_Buffer(unsigned width, unsigned height)
+            :
+                width (width ),
+                height(height),
+                buffer(size_t(width) * height)
+            {
+            }
+
+            unsigned get_width  () const { return width;  }
+            unsigned get_height () const { return height; }
+
+            size_t   bytes      () const { return buffer.capacity () * sizeof(Color); }
+
+            ///Cambia las medidas del buffer. Nunca libera memoria, así que volver a unas medidas que ya se han usado
+            ///no reserva nada.
+            void resize (unsigned new_width, unsigned new_height)
+            {
+                width  = new_width;
+                height = new_height;
+
+                buffer.resize (size_t(width) * height);
+            }
+
+                  Color * colors ()       { return buffer.data (); }
+            const Color * colors () const { return buffer.data (); }
+
+            void set_color (const Color & new_color)
+            {
+                color = new_color;
+            }
+
+            void set_pixel (int offset)
+            {
+                buffer[offset] = color;
+            }
+
+            void set_pixel (int offset, const Color & pixel_color)
+            {
+                buffer[offset] = pixel_color;
+            }
+
+            void clear (const Color & clear_color)
+            {
+                fill_span (0, int(buffer.size ()), clear_color);
+            }
+
+            ///Pinta count píxeles seguidos a partir de offset
+            void fill_span (int offset, int count, const Color & span_color)
+            {
+                uint32_t * target = reinterpret_cast< uint32_t * >(buffer.data ()) + offset;
+                uint32_t   value  = span_color.value;
+                int        index  = 0;
+
+            #ifdef PACKED_COLOR_BUFFER_SSE2
+                __m128i values = _mm_set1_epi32 (int(value));
+
+                for ( ; index + 4 <= count; index += 4)
+                {
+                    _mm_storeu_si128 (reinterpret_cast< __m128i * >(target + index), values);
+                }
+            #endif
+
+                for ( ; index < count; ++index) target[index] = value;
+            }
+
+            ///Pinta los píxeles del tramo cuya máscara vale 0xffffffff y deja los que valen 0
+            void fill_span_masked (int offset, int count, const Color & span_color, const uint32_t * mask)
+            {
+                uint32_t * target = reinterpret_cast< uint32_t * >(buffer.data ()) + offset;
+                uint32_t   value  = span_color.value;
+                int        index  = 0;
+
+            #ifdef PACKED_COLOR_BUFFER_SSE2
+                __m128i values = _mm_set1_epi32 (int(value));
+
+                for ( ; index + 4 <= count; index += 4)
+                {
+                    __m128i * pixels = reinterpret_cast< __m128i * >(target + index);
+                    __m128i   select = _mm_loadu_si128 (reinterpret_cast< const __m128i * >(mask + index));
+
+                    _mm_storeu_si128 (pixels, _mm_or_si128 (_mm_and_si128 (select, values), _mm_andnot_si128 (select, _mm_loadu_si128 (pixels))));
+                }
+            #endif
+
+                for ( ; index < count; ++index)
+                {
+                    target[index] = (value & mask[index]) | (target[index] & ~mask[index]);
+                }
+            }
+
+            ///Copia el buffer a la ventana con OpenGL, ampliándolo con los factores dados si se pinta a menos resolución
+            void blit_to_window (float zoom_x = 1.f, float zoom_y = 1.f) const;
+
+            ///Guarda el buffer como imagen PPM binaria, con las filas en el mismo orden que en memoria
+            bool save_ppm (const std::string & path) const;
+        };
+
+    }
+
+#endif
@@ -0,0 +1,41 @@
+/**
+* @file Parallel.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que reparte bucles de trabajo independiente entre los núcleos del procesador
+**/
+
+#ifndef PARALLEL_HEADER
+#define PARALLEL_HEADER
+
+    #include <cstddef>
+    #include <thread>
+    #include <utility>
+    #include "Job_System.hpp"
+
+    namespace Engine
+    {
+
+        ///Número de hilos que se usan para el trabajo en paralelo
+        inline unsigned worker_count ()
+        {
+            unsigned count = std::thread::hardware_concurrency ();
+
+            return count > 0 ? count : 1;
+        }
+
+        ///Ejecuta function(index) para cada index en [0, count) con el sistema de trabajos del motor. Cada hilo va
+        ///cogiendo el siguiente índice libre, y el hilo que llama también trabaja en lugar de quedarse esperando.
+        template< class FUNCTION >
+        void parallel_for (size_t count, FUNCTION && function)
+        {
+            Job_System::instance ().parallel_for (count, std::forward< FUNCTION > (function));
+        }
+
+    }
+
+#endif
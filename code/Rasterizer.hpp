@@ -16,38 +16,64 @@
     #include <cstdint>
     #include <limits>
     #include "math.hpp"
+    #include "Depth_Format.hpp"
+    #include "Stats.hpp"
 
     namespace Engine
     {
 
-        template< class COLOR_BUFFER_TYPE >
+        ///El formato del z-buffer es un parámetro de la plantilla (ver Depth_Format.hpp). La z de los vértices de
+        ///pantalla tiene que estar codificada con el mismo formato.
+        template< class COLOR_BUFFER_TYPE, class DEPTH_FORMAT = Scene_Depth_Format >
         class Rasterizer
         {
         public:
 
             typedef COLOR_BUFFER_TYPE            Color_Buffer;
             typedef typename Color_Buffer::Color Color;
+            typedef DEPTH_FORMAT                 Depth_Format;
+            typedef typename DEPTH_FORMAT::Value        Depth;
+            typedef typename DEPTH_FORMAT::Interpolated Depth_Interpolated;
+
+            ///Número de scanlines de las cachés de los lados, que es el alto máximo que se puede pintar
+            static constexpr int max_height = 2160;
 
         private:
 
             Color_Buffer & color_buffer;
 
-            static int offset_cache0[2160];
-            static int offset_cache1[2160];
+            //Cachés de los lados del polígono. Son de cada rasterizer para poder pintar varias vistas a la vez en distintos hilos
+            int offset_cache0[max_height];
+            int offset_cache1[max_height];
 
-            static int z_cache0[2160];
-            static int z_cache1[2160];
+            Depth_Interpolated z_cache0[max_height];
+            Depth_Interpolated z_cache1[max_height];
 
             Color color;
 
-            std::vector< int > z_buffer;
+            std::vector< Depth > z_buffer;
+
+            //Máscara del test de profundidad de la scanline que se está pintando (0xffffffff donde pasa)
+            std::vector< uint32_t > span_mask;
+
+            //Buffer de visibilidad: identificador del triángulo visible en cada píxel. Solo se reserva si se activa.
+            std::vector< uint32_t > id_buffer;
+
+            //Triángulos pequeños pintados desde el último flush_stats(), para no hacer un incremento atómico por triángulo
+            ENGINE_STATS_LOCAL(uint64_t triangles_small = 0;)
+
+        public:
+
+            ///Valor de los píxeles del buffer de visibilidad que no tienen ningún triángulo
+            static constexpr uint32_t empty_id = 0xffffffffu;
 
         public:
 
             Rasterizer(Color_Buffer & target)
             :
                 color_buffer(target),
-                z_buffer(target.get_width () * target.get_height ())
+                z_buffer(target.get_width () * target.get_height ()),
+                span_mask(target.get_width ())
             {
             }
 
@@ -56,78 +82,139 @@
                 return (color_buffer);
             }
 
+            ///Reserva el buffer de visibilidad. A partir de entonces clear() también lo borra.
+            void enable_visibility_buffer ()
+            {
+                id_buffer.assign (z_buffer.size (), empty_id);
+            }
+
+            const uint32_t * get_id_buffer () const
+            {
+                return id_buffer.data ();
+            }
+
+            ///Ajusta los buffers por píxel a las medidas actuales del buffer de color, sin liberar memoria
+            void resize ()
+            {
+                size_t pixels = size_t(color_buffer.get_width ()) * color_buffer.get_height ();
+
+                z_buffer .resize (pixels);
+                span_mask.resize (color_buffer.get_width ());
+
+                if (!id_buffer.empty ()) id_buffer.resize (pixels);
+            }
+
+            ///Memoria de los buffers por píxel del rasterizer, sin contar el de color, que es de quien lo crea
+            size_t bytes () const
+            {
+                return z_buffer.capacity () * sizeof(Depth) + span_mask.capacity () * sizeof(uint32_t) + id_buffer.capacity () * sizeof(uint32_t);
+            }
+
         public:
 
             void set_color (const Color & new_color)
             {
                 color = new_color;
+                color_buffer.set_color (new_color);
             }
 
             void set_color (float r, float g, float b)
             {
-                color_buffer.set (r, g, b);
+                set_color (Color(uint8_t(r), uint8_t(g), uint8_t(b)));
+            }
+
+            ///Suma a las estadísticas lo contado por el rasterizer. Se llama una vez al terminar cada lote de triángulos.
+            void flush_stats ()
+            {
+                ENGINE_STATS_ADD(triangles_small, triangles_small);
+                ENGINE_STATS_LOCAL(triangles_small = 0;)
             }
 
             void clear ()
             {
                 color_buffer.clear ({ 0, 0, 0 });
 
-                for (int * z = z_buffer.data (), * end = z + z_buffer.size (); z != end; z++)
-                {
-                    *z = std::numeric_limits< int >::max ();
-                }
+                std::fill (z_buffer.begin (), z_buffer.end (), DEPTH_FORMAT::clear_value ());
+
+                std::fill (id_buffer.begin (), id_buffer.end (), empty_id);
             }
 
+            template< typename INDEX_TYPE >
             void fill_convex_polygon
             (
-                const Point4i * const vertices, 
-                const int     * const indices_begin, 
-                const int     * const indices_end
+                const Point4i    * const vertices, 
+                const INDEX_TYPE * const indices_begin, 
+                const INDEX_TYPE * const indices_end
             );
 
+            template< typename INDEX_TYPE >
             void fill_convex_polygon_z_buffer
             (
-                const Point4i * const vertices, 
-                const int     * const indices_begin, 
-                const int     * const indices_end
-            );
+                const Point4i    * const vertices, 
+                const INDEX_TYPE * const indices_begin, 
+                const INDEX_TYPE * const indices_end
+            )
+            {
+                fill_z_buffer< false > (vertices, indices_begin, indices_end, 0);
+            }
+
+            ///Hace el mismo test de profundidad que fill_convex_polygon_z_buffer pero, en lugar del color, escribe
+            ///el identificador dado en el buffer de visibilidad (que debe estar activado)
+            template< typename INDEX_TYPE >
+            void fill_convex_polygon_visibility
+            (
+                const Point4i    * const vertices, 
+                const INDEX_TYPE * const indices_begin, 
+                const INDEX_TYPE * const indices_end,
+                uint32_t                 id
+            )
+            {
+                fill_z_buffer< true > (vertices, indices_begin, indices_end, id);
+            }
 
         private:
 
+            template< bool WRITE_ID, typename INDEX_TYPE >
+            void fill_z_buffer
+            (
+                const Point4i    * const vertices, 
+                const INDEX_TYPE * const indices_begin, 
+                const INDEX_TYPE * const indices_end,
+                uint32_t                 id
+            );
+
             template< typename VALUE_TYPE, size_t SHIFT >
             void interpolate (int * cache, int v0, int v1, int y_min, int y_max);
 
-        };
-
-        template< class COLOR_BUFFER_TYPE > int Rasterizer< COLOR_BUFFER_TYPE >::offset_cache0[2160];
-        template< class COLOR_BUFFER_TYPE > int Rasterizer< COLOR_BUFFER_TYPE >::offset_cache1[2160];
+            ///Como interpolate pero en el tipo que interpola el formato de profundidad
+            void interpolate_depth (Depth_Interpolated * cache, Depth_Interpolated v0, Depth_Interpolated v1, int y_min, int y_max);
 
-        template< class COLOR_BUFFER_TYPE > int Rasterizer< COLOR_BUFFER_TYPE >::z_cache0[2160];
-        template< class COLOR_BUFFER_TYPE > int Rasterizer< COLOR_BUFFER_TYPE >::z_cache1[2160];
+        };
 
-        template< class  COLOR_BUFFER_TYPE >
-        void Rasterizer< COLOR_BUFFER_TYPE >::fill_convex_polygon
+        template< class  COLOR_BUFFER_TYPE, class DEPTH_FORMAT >
+        template< typename INDEX_TYPE >
+        void Rasterizer< COLOR_BUFFER_TYPE, DEPTH_FORMAT >::fill_convex_polygon
         (
-            const Point4i * const vertices, 
-            const int     * const indices_begin, 
-            const int     * const indices_end
+            const Point4i    * const vertices, 
+            const INDEX_TYPE * const indices_begin, 
+            const INDEX_TYPE * const indices_end
         )
         {
             // Se cachean algunos valores de interés:
 
-                  int   pitch         = color_buffer.get_width ();
-                  int * offset_cache0 = this->offset_cache0;
-                  int * offset_cache1 = this->offset_cache1;
-            const int * indices_back  = indices_end - 1;
+                  int          pitch         = color_buffer.get_width ();
+                  int        * offset_cache0 = this->offset_cache0;
+                  int        * offset_cache1 = this->offset_cache1;
+            const INDEX_TYPE * indices_back  = indices_end - 1;
 
             // Se busca el vértice de inicio (el que tiene menor Y) y el de terminación (el que tiene mayor Y):
 
-            const int * start_index   = indices_begin;
-                  int   start_y       = vertices[*start_index][1];
-            const int * end_index     = indices_begin;
-                  int   end_y         = start_y;
+            const INDEX_TYPE * start_index = indices_begin;
+                  int          start_y     = vertices[*start_index][1];
+            const INDEX_TYPE * end_index   = indices_begin;
+                  int          end_y       = start_y;
 
-            for (const int * index_iterator = start_index; ++index_iterator < indices_end; )
+            for (const INDEX_TYPE * index_iterator = start_index; ++index_iterator < indices_end; )
             {
                 int current_y = vertices[*index_iterator][1];
 
@@ -147,8 +234,8 @@
             // Se cachean las coordenadas X de los lados que van desde el vértice con Y menor al
             // vértice con Y mayor en sentido antihorario:
 
-            const int * current_index = start_index;
-            const int *    next_index = start_index > indices_begin ? start_index - 1 : indices_back;
+            const INDEX_TYPE * current_index = start_index;
+            const INDEX_TYPE *    next_index = start_index > indices_begin ? start_index - 1 : indices_back;
 
             int y0 = vertices[*current_index][1];
             int y1 = vertices[*   next_index][1];
@@ -208,46 +295,47 @@
                 o0 = *offset_cache0++;
                 o1 = *offset_cache1++;
 
-                if (o0 < o1)
-                {
-                    while (o0 < o1) color_buffer.set_pixel (o0++);
+                // Cada scanline se pinta de una vez, del lado con menor offset al de mayor offset:
 
-                    if (o0 > end_offset) break;
-                }
-                else
+                int span_begin = o0 < o1 ? o0 : o1;
+                int span_end   = o0 < o1 ? o1 : o0;
+
+                if (span_begin < span_end)
                 {
-                    while (o1 < o0) color_buffer.set_pixel (o1++);
+                    color_buffer.fill_span (span_begin, span_end - span_begin, color);
 
-                    if (o1 > end_offset) break;
+                    if (span_end > end_offset) break;
                 }
             }
         }
 
-        template< class  COLOR_BUFFER_TYPE >
-        void Rasterizer< COLOR_BUFFER_TYPE >::fill_convex_polygon_z_buffer
+        template< class  COLOR_BUFFER_TYPE, class DEPTH_FORMAT >
+        template< bool WRITE_ID, typename INDEX_TYPE >
+        void Rasterizer< COLOR_BUFFER_TYPE, DEPTH_FORMAT >::fill_z_buffer
         (
-            const Point4i * const vertices, 
-            const int     * const indices_begin, 
-            const int     * const indices_end
+            const Point4i    * const vertices, 
+            const INDEX_TYPE * const indices_begin, 
+            const INDEX_TYPE * const indices_end,
+            uint32_t                 id
         )
         {
             // Se cachean algunos valores de interés:
 
-                  int   pitch         = color_buffer.get_width ();
-                  int * offset_cache0 = this->offset_cache0;
-                  int * offset_cache1 = this->offset_cache1;
-                  int * z_cache0      = this->z_cache0;
-                  int * z_cache1      = this->z_cache1;
-            const int * indices_back  = indices_end - 1;
+                  int                  pitch         = color_buffer.get_width ();
+                  int                * offset_cache0 = this->offset_cache0;
+                  int                * offset_cache1 = this->offset_cache1;
+                  Depth_Interpolated * z_cache0      = this->z_cache0;
+                  Depth_Interpolated * z_cache1      = this->z_cache1;
+            const INDEX_TYPE         * indices_back  = indices_end - 1;
 
             // Se busca el vértice de inicio (el que tiene menor Y) y el de terminación (el que tiene mayor Y):
 
-            const int * start_index   = indices_begin;
-                  int   start_y       = vertices[*start_index][1];
-            const int * end_index     = indices_begin;
-                  int   end_y         = start_y;
+            const INDEX_TYPE * start_index = indices_begin;
+                  int          start_y     = vertices[*start_index][1];
+            const INDEX_TYPE * end_index   = indices_begin;
+                  int          end_y       = start_y;
 
-            for (const int * index_iterator = start_index; ++index_iterator < indices_end; )
+            for (const INDEX_TYPE * index_iterator = start_index; ++index_iterator < indices_end; )
             {
                 int current_y = vertices[*index_iterator][1];
 
@@ -264,69 +352,130 @@
                 }
             }
 
-            // Se cachean las coordenadas X de los lados que van desde el vértice con Y menor al
-            // vértice con Y mayor en sentido antihorario:
+            // Los triángulos se clasifican por su caja en pantalla. Los que no tienen altura o anchura no llegan a
+            // ningún píxel, y los de una sola scanline se pintan sin recorrer los lados. En las mallas densas vistas
+            // de lejos son casi todos, y así no pagan la preparación de las cachés:
 
-            const int * current_index = start_index;
-            const int *    next_index = start_index > indices_begin ? start_index - 1 : indices_back;
+            if (end_y == start_y)
+            {
+                ENGINE_STATS_LOCAL(triangles_small++;)
+                return;
+            }
 
-            int y0 = vertices[*current_index][1];
-            int y1 = vertices[*   next_index][1];
-            int z0 = vertices[*current_index][2];
-            int z1 = vertices[*   next_index][2];
-            int o0 = vertices[*current_index][0] + y0 * pitch;
-            int o1 = vertices[*   next_index][0] + y1 * pitch;
+            int min_x = vertices[*indices_begin][0];
+            int max_x = min_x;
 
-            while (true)
+            for (const INDEX_TYPE * index_iterator = indices_begin; ++index_iterator < indices_end; )
             {
-                interpolate< int64_t, 32 > (offset_cache0, o0, o1, y0, y1);
-                interpolate< int32_t,  0 > (     z_cache0, z0, z1, y0, y1);
+                int current_x = vertices[*index_iterator][0];
 
-                if (current_index == indices_begin) current_index = indices_back; else current_index--;
-                if (current_index == end_index    ) break;
-                if (   next_index == indices_begin) next_index    = indices_back; else    next_index--;
+                min_x = current_x < min_x ? current_x : min_x;
+                max_x = current_x > max_x ? current_x : max_x;
+            }
 
-                y0 = y1;
-                y1 = vertices[*next_index][1];
-                z0 = z1;
-                z1 = vertices[*next_index][2];
-                o0 = o1;
-                o1 = vertices[*next_index][0] + y1 * pitch;
+            if (min_x == max_x)
+            {
+                ENGINE_STATS_LOCAL(triangles_small++;)
+                return;
             }
 
-            int end_offset = o1;
+            int end_offset;
 
-            // Se cachean las coordenadas X de los lados que van desde el vértice con Y menor al
-            // vértice con Y mayor en sentido horario:
+            if (end_y == start_y + 1)
+            {
+                // En cada lado, la única scanline toma el valor del último vértice que sigue en start_y antes del
+                // primer lado que baja, que es lo mismo que dejaría en las cachés el recorrido de los lados:
 
-            current_index = start_index;
-               next_index = start_index < indices_back ? start_index + 1 : indices_begin;
+                const INDEX_TYPE * side0 = start_index;
+                const INDEX_TYPE * side1 = start_index;
 
-            y0 = vertices[*current_index][1];
-            y1 = vertices[*   next_index][1];
-            z0 = vertices[*current_index][2];
-            z1 = vertices[*   next_index][2];
-            o0 = vertices[*current_index][0] + y0 * pitch;
-            o1 = vertices[*   next_index][0] + y1 * pitch;
+                for (const INDEX_TYPE * previous = side0 > indices_begin ? side0 - 1 : indices_back; vertices[*previous][1] == start_y; )
+                {
+                    side0    = previous;
+                    previous = side0 > indices_begin ? side0 - 1 : indices_back;
+                }
 
-            while (true)
-            {
-                interpolate< int64_t, 32 > (offset_cache1, o0, o1, y0, y1);
-                interpolate< int32_t,  0 > (     z_cache1, z0, z1, y0, y1);
+                for (const INDEX_TYPE * next = side1 < indices_back ? side1 + 1 : indices_begin; vertices[*next][1] == start_y; )
+                {
+                    side1 = next;
+                    next  = side1 < indices_back ? side1 + 1 : indices_begin;
+                }
 
-                if (current_index == indices_back) current_index = indices_begin; else current_index++;
-                if (current_index == end_index   ) break;
-                if (   next_index == indices_back) next_index    = indices_begin; else next_index++;
+                offset_cache0[start_y] = vertices[*side0][0] + start_y * pitch;
+                offset_cache1[start_y] = vertices[*side1][0] + start_y * pitch;
+                z_cache0     [start_y] = DEPTH_FORMAT::from_vertex (vertices[*side0][2]);
+                z_cache1     [start_y] = DEPTH_FORMAT::from_vertex (vertices[*side1][2]);
 
-                y0 = y1;
-                y1 = vertices[*next_index][1];
-                z0 = z1;
-                z1 = vertices[*next_index][2];
-                o0 = o1;
-                o1 = vertices[*next_index][0] + y1 * pitch;
+                end_offset = std::numeric_limits< int >::max ();
+
+                ENGINE_STATS_LOCAL(triangles_small++;)
             }
+            else
+            {
+                // Se cachean las coordenadas X de los lados que van desde el vértice con Y menor al
+                // vértice con Y mayor en sentido antihorario:
 
-            if (o1 > end_offset) end_offset = o1;
+                const INDEX_TYPE * current_index = start_index;
+                const INDEX_TYPE *    next_index = start_index > indices_begin ? start_index - 1 : indices_back;
+
+                int y0 = vertices[*current_index][1];
+                int y1 = vertices[*   next_index][1];
+                Depth_Interpolated z0 = DEPTH_FORMAT::from_vertex (vertices[*current_index][2]);
+                Depth_Interpolated z1 = DEPTH_FORMAT::from_vertex (vertices[*   next_index][2]);
+                int o0 = vertices[*current_index][0] + y0 * pitch;
+                int o1 = vertices[*   next_index][0] + y1 * pitch;
+
+                while (true)
+                {
+                    interpolate< int64_t, 32 > (offset_cache0, o0, o1, y0, y1);
+                    interpolate_depth          (     z_cache0, z0, z1, y0, y1);
+
+                    if (current_index == indices_begin) current_index = indices_back; else current_index--;
+                    if (current_index == end_index    ) break;
+                    if (   next_index == indices_begin) next_index    = indices_back; else    next_index--;
+
+                    y0 = y1;
+                    y1 = vertices[*next_index][1];
+                    z0 = z1;
+                    z1 = DEPTH_FORMAT::from_vertex (vertices[*next_index][2]);
+                    o0 = o1;
+                    o1 = vertices[*next_index][0] + y1 * pitch;
+                }
+
+                end_offset = o1;
+
+                // Se cachean las coordenadas X de los lados que van desde el vértice con Y menor al
+                // vértice con Y mayor en sentido horario:
+
+                current_index = start_index;
+                   next_index = start_index < indices_back ? start_index + 1 : indices_begin;
+
+                y0 = vertices[*current_index][1];
+                y1 = vertices[*   next_index][1];
+                z0 = DEPTH_FORMAT::from_vertex (vertices[*current_index][2]);
+                z1 = DEPTH_FORMAT::from_vertex (vertices[*   next_index][2]);
+                o0 = vertices[*current_index][0] + y0 * pitch;
+                o1 = vertices[*   next_index][0] + y1 * pitch;
+
+                while (true)
+                {
+                    interpolate< int64_t, 32 > (offset_cache1, o0, o1, y0, y1);
+                    interpolate_depth          (     z_cache1, z0, z1, y0, y1);
+
+                    if (current_index == indices_back) current_index = indices_begin; else current_index++;
+                    if (current_index == end_index   ) break;
+                    if (   next_index == indices_back) next_index    = indices_begin; else next_index++;
+
+                    y0 = y1;
+                    y1 = vertices[*next_index][1];
+                    z0 = z1;
+                    z1 = DEPTH_FORMAT::from_vertex (vertices[*next_index][2]);
+                    o0 = o1;
+                    o1 = vertices[*next_index][0] + y1 * pitch;
+                }
+
+                if (o1 > end_offset) end_offset = o1;
+            }
 
             // Se rellenan las scanlines desde la que tiene menor Y hasta la que tiene mayor Y:
 
@@ -335,56 +484,75 @@
             z_cache0 += start_y;
             z_cache1 += start_y;
 
+            ENGINE_STATS_LOCAL(uint64_t pixels_tested    = 0;)
+            ENGINE_STATS_LOCAL(uint64_t pixels_passed    = 0;)
+            ENGINE_STATS_LOCAL(uint64_t pixels_overdrawn = 0;)
+
             for (int y = start_y; y < end_y; y++)
             {
-                o0 = *offset_cache0++;
-                o1 = *offset_cache1++;
-                z0 = *z_cache0++;
-                z1 = *z_cache1++;
+                int                o0 = *offset_cache0++;
+                int                o1 = *offset_cache1++;
+                Depth_Interpolated z0 = *z_cache0++;
+                Depth_Interpolated z1 = *z_cache1++;
+
+                // Cada scanline se recorre del lado con menor offset al de mayor offset:
 
-                if (o0 < o1)
+                int                span_begin = o0 < o1 ? o0 : o1;
+                int                span_end   = o0 < o1 ? o1 : o0;
+                Depth_Interpolated z          = o0 < o1 ? z0 : z1;
+                Depth_Interpolated z_end      = o0 < o1 ? z1 : z0;
+
+                if (span_begin < span_end)
                 {
-                    int z_step = (z1 - z0) / (o1 - o0);
+                    int                count  = span_end - span_begin;
+                    Depth_Interpolated z_step = (z_end - z) / Depth_Interpolated(count);
+
+                    ENGINE_STATS_LOCAL(pixels_tested += count;)
+
+                    if (count > int(span_mask.size ())) span_mask.resize (count);
+
+                    // Primero se hace el test de profundidad de todo el tramo sin saltos, guardando en la máscara
+                    // los píxeles que pasan, y después se pintan (o se marcan con el id) con una escritura enmascarada:
 
-                    while (o0 < o1)
+                    Depth    * depth = z_buffer.data () + span_begin;
+                    uint32_t * mask  = span_mask.data ();
+
+                    for (int index = 0; index < count; ++index, z += z_step)
                     {
-                        if (z0 < z_buffer[o0])
-                        {
-                            color_buffer.set_pixel (o0, color);
-                            z_buffer[o0] = z0;
-                        }
+                        Depth    old  = depth[index];
+                        uint32_t pass = DEPTH_FORMAT::closer (z, old) ? 0xffffffffu : 0u;
 
-                        z0 += z_step;
-                        o0++;
-                    }
+                        ENGINE_STATS_LOCAL(pixels_passed    += pass & 1u;)
+                        ENGINE_STATS_LOCAL(pixels_overdrawn += pass & uint32_t(!DEPTH_FORMAT::is_clear (old));)
 
-                    if (o0 > end_offset) break;
-                }
-                else
-                if (o1 < o0)
-                {
-                    int z_step = (z0 - z1) / (o0 - o1);
+                        mask [index] = pass;
+                        depth[index] = pass ? DEPTH_FORMAT::store (z) : old;
+                    }
 
-                    while (o1 < o0)
+                    if (WRITE_ID)
                     {
-                        if (z1 < z_buffer[o1])
+                        uint32_t * ids = id_buffer.data () + span_begin;
+
+                        for (int index = 0; index < count; ++index)
                         {
-                            color_buffer.set_pixel (o1, color);
-                            z_buffer[o1] = z1;
+                            ids[index] = (id & mask[index]) | (ids[index] & ~mask[index]);
                         }
-
-                        z1 += z_step;
-                        o1++;
                     }
+                    else
+                        color_buffer.fill_span_masked (span_begin, count, color, mask);
 
-                    if (o1 > end_offset) break;
+                    if (span_end > end_offset) break;
                 }
             }
+
+            ENGINE_STATS_ADD(pixels_tested,    pixels_tested   );
+            ENGINE_STATS_ADD(pixels_passed,    pixels_passed   );
+            ENGINE_STATS_ADD(pixels_overdrawn, pixels_overdrawn);
         }
 
-        template< class  COLOR_BUFFER_TYPE >
+        template< class  COLOR_BUFFER_TYPE, class DEPTH_FORMAT >
         template< typename VALUE_TYPE, size_t SHIFT >
-        void Rasterizer< COLOR_BUFFER_TYPE >::interpolate (int * cache, int v0, int v1, int y_min, int y_max)
+        void Rasterizer< COLOR_BUFFER_TYPE, DEPTH_FORMAT >::interpolate (int * cache, int v0, int v1, int y_min, int y_max)
         {
             if (y_max > y_min)
             {
@@ -401,6 +569,31 @@
             }
         }
 
+        template< class  COLOR_BUFFER_TYPE, class DEPTH_FORMAT >
+        void Rasterizer< COLOR_BUFFER_TYPE, DEPTH_FORMAT >::interpolate_depth
+        (
+            Depth_Interpolated * cache,
+            Depth_Interpolated   v0,
+            Depth_Interpolated   v1,
+            int                  y_min,
+            int                  y_max
+        )
+        {
+            if (y_max > y_min)
+            {
+                Depth_Interpolated value = v0;
+                Depth_Interpolated step  = (v1 - v0) / Depth_Interpolated(y_max - y_min);
+
+                for (Depth_Interpolated * iterator = cache + y_min, * end = cache + y_max; iterator <= end; )
+                {
+                   *iterator++ = value;
+                    value += step;
+                   *iterator++ = value;
+                    value += step;
+                }
+            }
+        }
+
     }
 
 #endif
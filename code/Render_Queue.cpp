@@ -0,0 +1,121 @@
+/**
+* @file Render_Queue.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda la cola de comandos de dibujo: los modelos graban en paralelo los rangos de triángulos que se
+* pintan, y después se juntan, se ordenan y se mandan al rasterizer
+**/
+
+#include "Render_Queue.hpp"
+#include "Job_System.hpp"
+#include "Stats.hpp"
+#include <algorithm>
+
+namespace Engine
+{
+    ///Vacía la cola y reserva sitio para las fuentes del frame
+    void Render_Queue::begin (size_t number_of_sources)
+    {
+        sources.assign (number_of_sources, Draw_Source{});
+
+        buffers.resize (Job_System::instance ().size ());
+
+        for (Thread_Buffer & buffer : buffers) buffer.commands.clear ();
+    }
+
+    ///Graba un rango de triángulos de la fuente dada. Se puede llamar a la vez desde todos los hilos del sistema de
+    ///trabajos, y desde uno solo de fuera.
+    void Render_Queue::record (uint32_t source, uint32_t order, int min_depth, uint32_t index_offset, uint32_t index_count)
+    {
+        //Se cambia el bit de signo para que las profundidades negativas queden delante al ordenar sin signo
+        uint32_t depth = uint32_t(min_depth) ^ 0x80000000u;
+
+        buffers[Job_System::instance ().thread_index ()].commands.push_back ({ depth, source, order, index_offset, index_count });
+    }
+
+    ///Junta, ordena y pinta todos los comandos descartando las caras traseras. Con visibility se escriben
+    ///identificadores en lugar de colores.
+    void Render_Queue::execute (Rasterizer< Packed_Color_Buffer > & rasterizer, bool visibility)
+    {
+        merged.clear ();
+
+        for (const Thread_Buffer & buffer : buffers)
+        {
+            merged.insert (merged.end (), buffer.commands.begin (), buffer.commands.end ());
+        }
+
+        // La fuente y el orden de grabación desempatan, de modo que el orden final no depende de los hilos:
+
+        bool by_depth = order == FRONT_TO_BACK;
+
+        std::sort
+        (
+            merged.begin (), merged.end (), [by_depth] (const Draw_Command & a, const Draw_Command & b)
+            {
+                if (by_depth && a.depth != b.depth) return a.depth < b.depth;
+                if (a.source != b.source)           return a.source < b.source;
+
+                return a.order < b.order;
+            }
+        );
+
+        ENGINE_STATS_ADD(draw_commands, merged.size ());
+        ENGINE_STATS_LOCAL(uint64_t triangles_visible    = 0;)
+        ENGINE_STATS_LOCAL(uint64_t triangles_rasterized = 0;)
+
+        // El color solo se cambia cuando es distinto del anterior:
+
+        uint32_t current_color = 0;
+        bool     color_set     = false;
+
+        for (const Draw_Command & command : merged)
+        {
+            const Draw_Source & source = sources[command.source];
+
+            ENGINE_STATS_LOCAL(triangles_visible += command.index_count / 3;)
+
+            //El bucle se compila una vez por cada ancho de índice
+            auto draw = [&] (const auto * index_buffer)
+            {
+                for (auto indices = index_buffer + command.index_offset, end = indices + command.index_count; indices < end; indices += 3)
+                {
+                    if (!is_frontface (source.projected, indices)) continue;
+
+                    if (visibility)
+                    {
+                        uint32_t triangle = uint32_t(indices - index_buffer) / 3;
+
+                        rasterizer.fill_convex_polygon_visibility (source.screen, indices, indices + 3, source.id | triangle);
+                    }
+                    else
+                    {
+                        const Packed_Color & color = source.colors[*indices];
+
+                        if (!color_set || color.value != current_color)
+                        {
+                            rasterizer.set_color (color);
+
+                            current_color = color.value;
+                            color_set     = true;
+                        }
+
+                        rasterizer.fill_convex_polygon_z_buffer (source.screen, indices, indices + 3);
+                    }
+
+                    ENGINE_STATS_LOCAL(triangles_rasterized++;)
+                }
+            };
+
+            if (source.narrow_indices) draw (source.narrow_indices); else draw (source.wide_indices);
+        }
+
+        ENGINE_STATS_ADD(triangles_rasterized, triangles_rasterized);
+        ENGINE_STATS_ADD(triangles_culled, triangles_visible - triangles_rasterized);
+
+        rasterizer.flush_stats ();
+    }
+}
@@ -0,0 +1,114 @@
+/**
+* @file Render_Queue.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda la cola de comandos de dibujo: los modelos graban en paralelo los rangos de triángulos que se
+* pintan, y después se juntan, se ordenan y se mandan al rasterizer
+**/
+
+#ifndef RENDER_QUEUE_HEADER
+#define RENDER_QUEUE_HEADER
+
+    #include <cstdint>
+    #include <vector>
+    #include "math.hpp"
+    #include "Packed_Color_Buffer.hpp"
+    #include "Rasterizer.hpp"
+
+    namespace Engine
+    {
+
+        ///Devuelve true si el triángulo mira a la cámara, a partir de la x y la y proyectadas de sus vértices.
+        ///Se asumen polígonos definidos en sentido horario: se comprueba a qué lado de la línea que pasa por v0 y v1
+        ///queda el punto v2.
+        template< typename INDEX_TYPE >
+        inline bool is_frontface (const Vector2f * projected, const INDEX_TYPE * indices)
+        {
+            const Vector2f & v0 = projected[indices[0]];
+            const Vector2f & v1 = projected[indices[1]];
+            const Vector2f & v2 = projected[indices[2]];
+
+            return ((v1[0] - v0[0]) * (v2[1] - v0[1]) - (v2[0] - v0[0]) * (v1[1] - v0[1]) < 0.f);
+        }
+
+        ///Buffers de un modelo que leen sus comandos. Se apuntan una vez por frame y no deben cambiar hasta execute.
+        struct Draw_Source
+        {
+            const Point4i      * screen;        ///< Vértices en coordenadas de pantalla
+            const Vector2f     * projected;     ///< x e y proyectadas de los vértices, para descartar las caras traseras
+            const Packed_Color * colors;        ///< El color del primer vértice pinta todo el triángulo
+            const uint16_t     * narrow_indices; ///< Index buffer de la fuente, con uno solo de los dos anchos
+            const uint32_t     * wide_indices;
+            uint32_t             id;            ///< Bits altos del identificador en el buffer de visibilidad
+        };
+
+        ///Rango de triángulos de una fuente
+        struct Draw_Command
+        {
+            uint32_t depth;                     ///< Profundidad más cercana del rango, convertida para ordenar sin signo
+            uint32_t source;
+            uint32_t order;                     ///< Posición en la que lo grabó su fuente
+            uint32_t index_offset;
+            uint32_t index_count;
+        };
+
+        ///Cada hilo del sistema de trabajos graba en su propio buffer, así que grabar no necesita ningún bloqueo.
+        ///Antes de pintar se juntan todos y se ordenan por fuente y orden de grabación, que es el orden en el que
+        ///pintaba cada modelo, o de delante hacia atrás para que el test de profundidad descarte antes los píxeles
+        ///tapados. El resultado no depende de qué hilo grabó cada comando.
+        class Render_Queue
+        {
+        public:
+
+            enum Order
+            {
+                SUBMISSION_ORDER,
+                FRONT_TO_BACK
+            };
+
+        private:
+
+            ///Alineado para que dos hilos no escriban en la misma línea de caché
+            struct alignas(64) Thread_Buffer
+            {
+                std::vector< Draw_Command > commands;
+            };
+
+            std::vector< Draw_Source   > sources;
+            std::vector< Thread_Buffer > buffers;
+            std::vector< Draw_Command  > merged;
+
+        public:
+
+            Order order = SUBMISSION_ORDER;
+
+        public:
+
+            ///Vacía la cola y reserva sitio para las fuentes del frame
+            void begin (size_t number_of_sources);
+
+            ///Cada fuente se apunta desde un solo hilo, aunque puede ser a la vez que otras
+            void set_source (uint32_t index, const Draw_Source & source)
+            {
+                sources[index] = source;
+            }
+
+            ///Graba un rango de triángulos de la fuente dada. Se puede llamar a la vez desde todos los hilos del
+            ///sistema de trabajos, y desde uno solo de fuera.
+            void record (uint32_t source, uint32_t order, int min_depth, uint32_t index_offset, uint32_t index_count);
+
+            ///Junta, ordena y pinta todos los comandos descartando las caras traseras. Con visibility se escriben
+            ///identificadores en lugar de colores.
+            void execute (Rasterizer< Packed_Color_Buffer > & rasterizer, bool visibility);
+
+            ///Comandos que se pintaron en el último execute
+            size_t size () const { return merged.size (); }
+        };
+
+    }
+
+#endif
@@ -0,0 +1,547 @@
+/**
+* @file Render_Server.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda el servidor de render sin ventana, que recibe trabajos por la entrada estándar o por un socket
+* Unix y los pinta en paralelo manteniendo los modelos cargados entre un trabajo y otro
+**/
+
+#include "Render_Server.hpp"
+#include "Camera.hpp"
+#include "Multi_View_Renderer.hpp"
+#include "Stats.hpp"
+#include "Memory_Tracker.hpp"
+#include "View.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+namespace Engine
+{
+    using std::string;
+    using std::vector;
+
+    namespace
+    {
+        ///Lee la lista de cámaras de un trabajo
+        bool load_cameras (const string & path, unsigned width, unsigned height, vector< Batch_View > & views, string & error)
+        {
+            std::ifstream file(path);
+
+            if (!file)
+            {
+                error = "no se puede abrir " + path;
+                return false;
+            }
+
+            string line;
+
+            while (std::getline (file, line))
+            {
+                line = line.substr (0, line.find ('#'));
+
+                std::istringstream tokens(line);
+                float              angle_x, angle_y, angle_z, x, y, z;
+
+                if (!(tokens >> angle_x)) continue;
+
+                if (!(tokens >> angle_y >> angle_z >> x >> y >> z))
+                {
+                    error = path + ": cámara no válida";
+                    return false;
+                }
+
+                Camera camera(x, y, z);
+
+                camera.Update (angle_x, angle_y, angle_z, x, y, z);
+
+                views.push_back ({ camera.transformation, width, height });
+            }
+
+            if (views.empty ())
+            {
+                error = path + ": no hay cámaras";
+                return false;
+            }
+
+            return true;
+        }
+
+        double percentile (vector< double > values, double fraction)
+        {
+            if (values.empty ()) return 0.0;
+
+            size_t index = std::min (values.size () - 1, size_t(fraction * double(values.size ())));
+
+            std::nth_element (values.begin (), values.begin () + index, values.end ());
+
+            return values[index];
+        }
+    }
+
+    Render_Server::Render_Server(unsigned number_of_workers)
+    :
+        running        (0),
+        exit           (false),
+        start          (Clock::now ()),
+        jobs_done      (0),
+        jobs_failed    (0),
+        frames_rendered(0),
+        latency_next   (0)
+    {
+        for (unsigned index = 0; index < std::max (1u, number_of_workers); ++index)
+        {
+            workers.emplace_back (&Render_Server::worker_loop, this);
+        }
+    }
+
+    Render_Server::~Render_Server()
+    {
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            exit = true;
+        }
+
+        work_available.notify_all ();
+
+        for (std::thread & worker : workers) worker.join ();
+    }
+
+    ///Encola un trabajo. reply se llama desde el hilo que lo ejecuta cuando termina
+    void Render_Server::submit (const Render_Job & job, Reply reply)
+    {
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            queue.push_back ({ job, std::move (reply), Clock::now () });
+        }
+
+        work_available.notify_one ();
+    }
+
+    ///Espera a que no quede ningún trabajo en la cola ni en marcha
+    void Render_Server::wait_idle ()
+    {
+        std::unique_lock< std::mutex > lock(mutex);
+
+        work_finished.wait (lock, [this] { return queue.empty () && running == 0; });
+    }
+
+    void Render_Server::worker_loop ()
+    {
+        while (true)
+        {
+            Queued_Job queued;
+
+            {
+                std::unique_lock< std::mutex > lock(mutex);
+
+                work_available.wait (lock, [this] { return exit || !queue.empty (); });
+
+                //Al salir se terminan antes los trabajos que quedan en la cola
+                if (queue.empty ()) return;
+
+                queued = std::move (queue.front ());
+                queue.pop_front ();
+                running++;
+            }
+
+            size_t frames  = 0;
+            string error;
+            bool   success = false;
+
+            //Un trabajo que falla con una excepción (memoria, archivos, importadores) no puede tirar el servidor ni los
+            //trabajos que se están pintando a la vez: se responde como cualquier otro fallo
+            try
+            {
+                success = run_job (queued.job, frames, error);
+            }
+            catch (const std::exception & exception)
+            {
+                error = string("excepción: ") + exception.what ();
+            }
+            catch (...)
+            {
+                error = "excepción desconocida";
+            }
+
+            double milliseconds = std::chrono::duration< double, std::milli >(Clock::now () - queued.submitted).count ();
+
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+
+                if (success)
+                {
+                    jobs_done++;
+                    frames_rendered += frames;
+                }
+                else
+                    jobs_failed++;
+
+                if (latencies.size () < latency_window)
+                    latencies.push_back (milliseconds);
+                else
+                    latencies[latency_next] = milliseconds;
+
+                latency_next = (latency_next + 1) % latency_window;
+            }
+
+            char milliseconds_text[32];
+
+            std::snprintf (milliseconds_text, sizeof(milliseconds_text), "%.1f", milliseconds);
+
+            queued.reply (success
+                ? "done "   + queued.job.id + " " + std::to_string (frames) + " " + milliseconds_text
+                : "failed " + queued.job.id + " " + error);
+
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+
+                //Las estadísticas son globales y los trabajos van a la vez, así que en el servidor solo son agregadas:
+                //cada trabajo que termina cierra un frame con lo que hicieron todos los trabajos desde el cierre
+                //anterior. Se cierran de uno en uno, con el mutex, para que los frames no se pisen.
+                ENGINE_STATS_END_FRAME();
+
+                running--;
+            }
+
+            work_finished.notify_all ();
+        }
+    }
+
+    ///Pinta un trabajo. Devuelve false y deja en error el motivo si falla
+    bool Render_Server::run_job (const Render_Job & job, size_t & frames, string & error)
+    {
+        Scene_Description description;
+        vector< Batch_View > views;
+
+        if (!description.load (job.scene, error)) return false;
+        if (!load_cameras (job.cameras, job.width, job.height, views, error)) return false;
+
+        // Cada trabajo tiene su propia escena, pero sus modelos copian la geometría de los que ya están en la caché:
+
+        View view(job.width, job.height, description, &cache);
+
+        view.headless = true;
+
+        //Los modelos con huesos se pintan en el segundo de su animación que indica la escena
+        view.animate (0.f);
+
+        Multi_View_Renderer          renderer(view);
+        vector< Packed_Color_Buffer > images;
+
+        renderer.render (views, images);
+
+        for (size_t index = 0; index < images.size (); ++index)
+        {
+            char suffix[16];
+
+            std::snprintf (suffix, sizeof(suffix), "_%04zu.ppm", index);
+
+            if (!images[index].save_ppm (job.output + suffix))
+            {
+                error = "no se puede escribir " + job.output + suffix;
+                return false;
+            }
+        }
+
+        frames = images.size ();
+
+        return true;
+    }
+
+    ///Línea con el rendimiento (trabajos e imágenes por segundo), la latencia, el estado de la caché y la memoria
+    string Render_Server::metrics ()
+    {
+        std::lock_guard< std::mutex > lock(mutex);
+
+        double uptime = std::chrono::duration< double >(Clock::now () - start).count ();
+
+        char text[512];
+
+        std::snprintf
+        (
+            text, sizeof(text),
+            "metrics uptime_s=%.1f queued=%zu running=%zu done=%llu failed=%llu frames=%llu jobs_per_s=%.2f frames_per_s=%.2f "
+            "latency_ms_p50=%.1f latency_ms_p95=%.1f latency_ms_max=%.1f cache_assets=%zu cache_hits=%llu cache_misses=%llu cache_evictions=%llu ",
+            uptime,
+            queue.size (),
+            running,
+            (unsigned long long)jobs_done,
+            (unsigned long long)jobs_failed,
+            (unsigned long long)frames_rendered,
+            uptime > 0.0 ? double(jobs_done      ) / uptime : 0.0,
+            uptime > 0.0 ? double(frames_rendered) / uptime : 0.0,
+            percentile (latencies, 0.50),
+            percentile (latencies, 0.95),
+            latencies.empty () ? 0.0 : *std::max_element (latencies.begin (), latencies.end ()),
+            cache.size (),
+            (unsigned long long)cache.get_hits   (),
+            (unsigned long long)cache.get_misses (),
+            (unsigned long long)cache.get_evictions ()
+        );
+
+        return text + Memory_Tracker::instance ().metrics ();
+    }
+
+    ///Ejecuta una línea del protocolo y responde con reply
+    Render_Server::Command_Result Render_Server::handle_command (const string & line, const Reply & reply)
+    {
+        std::istringstream tokens(line);
+        string             command;
+
+        if (!(tokens >> command)) return CONTINUE;
+
+        if (command == "render")
+        {
+            Render_Job job;
+
+            if (!(tokens >> job.id >> job.scene >> job.cameras >> job.width >> job.height >> job.output) || job.width == 0 || job.height == 0)
+            {
+                reply ("error render <id> <escena> <cámaras> <ancho> <alto> <salida>");
+            }
+            else
+            if (job.width > max_width || job.height > max_height)
+            {
+                reply ("error la resolución máxima es " + std::to_string (max_width) + "x" + std::to_string (max_height));
+            }
+            else
+                submit (job, reply);
+        }
+        else
+        if (command == "metrics" ) reply (metrics ());
+        else
+        if (command == "quit"    ) return CLOSE;
+        else
+        if (command == "shutdown") return SHUTDOWN;
+        else
+            reply ("error orden desconocida: " + command);
+
+        return CONTINUE;
+    }
+
+    ///Atiende las órdenes de un stream (la entrada estándar) hasta que se acaba o pide terminar
+    void Render_Server::serve_stream (std::istream & in, std::ostream & out)
+    {
+        //Las respuestas llegan desde los hilos de trabajo, así que se escriben de una en una
+        auto output_mutex = std::make_shared< std::mutex > ();
+
+        Reply reply = [&out, output_mutex] (const string & text)
+        {
+            std::lock_guard< std::mutex > lock(*output_mutex);
+
+            out << text << std::endl;
+        };
+
+        string line;
+
+        while (std::getline (in, line) && handle_command (line, reply) == CONTINUE)
+        {
+        }
+
+        wait_idle ();
+
+        reply (metrics ());
+    }
+
+#ifndef _WIN32
+
+    namespace
+    {
+        ///Conexión de un cliente. Se cierra cuando ya no la usan ni su hilo ni las respuestas pendientes
+        struct Connection
+        {
+            int        socket;
+            std::mutex mutex;
+
+            explicit Connection(int socket) : socket(socket)
+            {
+            }
+
+           ~Connection()
+            {
+                ::close (socket);
+            }
+
+            void send_line (const string & text)
+            {
+                string message = text + "\n";
+
+                std::lock_guard< std::mutex > lock(mutex);
+
+                for (size_t sent = 0; sent < message.size (); )
+                {
+                #ifdef MSG_NOSIGNAL
+                    ssize_t result = ::send (socket, message.data () + sent, message.size () - sent, MSG_NOSIGNAL);
+                #else
+                    ssize_t result = ::send (socket, message.data () + sent, message.size () - sent, 0);
+                #endif
+
+                    //Si el cliente se ha ido la respuesta se pierde
+                    if (result <= 0) return;
+
+                    sent += size_t(result);
+                }
+            }
+        };
+    }
+
+    ///Atiende conexiones en un socket Unix hasta que alguna pide shutdown
+    bool Render_Server::serve_socket (const string & path)
+    {
+        sockaddr_un address = {};
+
+        if (path.size () >= sizeof(address.sun_path)) return false;
+
+        address.sun_family = AF_UNIX;
+        path.copy (address.sun_path, path.size ());
+
+        int listener = ::socket (AF_UNIX, SOCK_STREAM, 0);
+
+        if (listener < 0) return false;
+
+        ::unlink (path.c_str ());
+
+        if (::bind (listener, reinterpret_cast< sockaddr * >(&address), sizeof(address)) != 0 || ::listen (listener, 16) != 0)
+        {
+            ::close (listener);
+            return false;
+        }
+
+        // Cada cliente se quita de connections al terminar su bucle, así que su socket se cierra en cuanto dejan de
+        // usarlo las respuestas pendientes, y los hilos que ya han terminado se recogen al aceptar el siguiente:
+
+        struct Client
+        {
+            std::thread                           thread;
+            std::shared_ptr< std::atomic< bool > > finished;
+        };
+
+        std::mutex                                         connections_mutex;
+        std::map< uint64_t, std::weak_ptr< Connection > >  connections;
+        std::list< Client >                                clients;
+        uint64_t                                           next_client = 0;
+
+        auto reap = [&clients] ()
+        {
+            for (auto client = clients.begin (); client != clients.end (); )
+            {
+                if (!*client->finished) { ++client; continue; }
+
+                client->thread.join ();
+                client = clients.erase (client);
+            }
+        };
+
+        while (true)
+        {
+            int client = ::accept (listener, nullptr, nullptr);
+
+            //shutdown cierra el socket de escucha y accept falla
+            if (client < 0) break;
+
+            reap ();
+
+            auto     connection = std::make_shared< Connection > (client);
+            auto     finished   = std::make_shared< std::atomic< bool > > (false);
+            uint64_t id         = next_client++;
+
+            {
+                std::lock_guard< std::mutex > lock(connections_mutex);
+
+                connections[id] = connection;
+            }
+
+            std::thread thread([this, connection, finished, id, listener, &connections, &connections_mutex] () mutable
+            {
+                Reply reply = [connection] (const string & text) { connection->send_line (text); };
+
+                string pending;
+                char   buffer[4096];
+
+                bool open = true;
+
+                while (open)
+                {
+                    ssize_t received = ::recv (connection->socket, buffer, sizeof(buffer), 0);
+
+                    if (received <= 0) break;
+
+                    pending.append (buffer, size_t(received));
+
+                    for (size_t end = pending.find ('\n'); open && end != string::npos; end = pending.find ('\n'))
+                    {
+                        string line = pending.substr (0, end);
+
+                        pending.erase (0, end + 1);
+
+                        Command_Result result = handle_command (line, reply);
+
+                        if (result == SHUTDOWN) ::shutdown (listener, SHUT_RDWR);
+                        if (result != CONTINUE) open = false;
+                    }
+                }
+
+                {
+                    std::lock_guard< std::mutex > lock(connections_mutex);
+
+                    connections.erase (id);
+                }
+
+                //Si no quedan respuestas pendientes el socket se cierra aquí mismo
+                connection.reset ();
+
+                *finished = true;
+            });
+
+            clients.push_back ({ std::move (thread), finished });
+        }
+
+        // Se terminan los trabajos pendientes, que aún pueden responder, y después se cierran las conexiones:
+
+        wait_idle ();
+
+        {
+            std::lock_guard< std::mutex > lock(connections_mutex);
+
+            for (const auto & entry : connections)
+            {
+                if (auto connection = entry.second.lock ()) ::shutdown (connection->socket, SHUT_RDWR);
+            }
+        }
+
+        for (Client & client : clients) client.thread.join ();
+
+        ::close  (listener);
+        ::unlink (path.c_str ());
+
+        return true;
+    }
+
+#else
+
+    bool Render_Server::serve_socket (const string &)
+    {
+        return false;
+    }
+
+#endif
+}
@@ -0,0 +1,139 @@
+/**
+* @file Render_Server.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda el servidor de render sin ventana, que recibe trabajos por la entrada estándar o por un socket
+* Unix y los pinta en paralelo manteniendo los modelos cargados entre un trabajo y otro
+**/
+
+#ifndef RENDER_SERVER_HEADER
+#define RENDER_SERVER_HEADER
+
+    #include <chrono>
+    #include <condition_variable>
+    #include <deque>
+    #include <functional>
+    #include <iostream>
+    #include <mutex>
+    #include <string>
+    #include <thread>
+    #include <vector>
+    #include "Asset_Cache.hpp"
+    #include "Packed_Color_Buffer.hpp"
+    #include "Rasterizer.hpp"
+
+    namespace Engine
+    {
+
+        ///Trabajo de render: una escena, una lista de cámaras, la resolución y el prefijo de las imágenes que se generan
+        ///(<output>_0000.ppm, <output>_0001.ppm...)
+        struct Render_Job
+        {
+            std::string id;
+            std::string scene;
+            std::string cameras;
+            unsigned    width  = 0;
+            unsigned    height = 0;
+            std::string output;
+        };
+
+        ///Protocolo de texto, una orden por línea:
+        ///
+        ///    render <id> <escena> <cámaras> <ancho> <alto> <salida>   ->  done <id> <imágenes> <ms>  |  failed <id> <motivo>
+        ///    metrics                                                  ->  metrics <clave>=<valor> ...
+        ///    quit                                                     cierra la conexión (o la entrada estándar)
+        ///    shutdown                                                 termina el servidor cuando acaban los trabajos
+        ///
+        ///El archivo de cámaras tiene una cámara por línea con los parámetros de Camera::Update:
+        ///<ángulo x> <ángulo y> <ángulo z> <x> <y> <z>. Los trabajos se responden en el orden en que terminan.
+        class Render_Server
+        {
+        public:
+
+            typedef std::function< void (const std::string &) > Reply;
+            typedef std::chrono::steady_clock                   Clock;
+
+            enum Command_Result
+            {
+                CONTINUE,
+                CLOSE,
+                SHUTDOWN
+            };
+
+        private:
+
+            struct Queued_Job
+            {
+                Render_Job        job;
+                Reply             reply;
+                Clock::time_point submitted;
+            };
+
+            ///Número de latencias que se guardan para los percentiles
+            static constexpr size_t latency_window = 1024;
+
+            ///Resolución máxima de un trabajo. El alto lo limitan las cachés del rasterizer y el ancho se limita al
+            ///doble del 4K para que un trabajo no pueda pedir un framebuffer que no cabe en memoria
+            static constexpr unsigned max_width  = 7680;
+            static constexpr unsigned max_height = unsigned(Rasterizer< Packed_Color_Buffer >::max_height);
+
+            Asset_Cache                 cache;
+
+            std::vector< std::thread >  workers;
+            std::mutex                  mutex;
+            std::condition_variable     work_available;
+            std::condition_variable     work_finished;
+            std::deque< Queued_Job >    queue;
+            size_t                      running;
+            bool                        exit;
+
+            Clock::time_point           start;
+            uint64_t                    jobs_done;
+            uint64_t                    jobs_failed;
+            uint64_t                    frames_rendered;
+            std::vector< double >       latencies;              ///< Milisegundos entre la llegada y la respuesta
+            size_t                      latency_next;
+
+        public:
+
+            explicit Render_Server(unsigned number_of_workers);
+           ~Render_Server();
+
+            Render_Server(const Render_Server &) = delete;
+            Render_Server & operator = (const Render_Server &) = delete;
+
+            ///Encola un trabajo. reply se llama desde el hilo que lo ejecuta cuando termina
+            void submit (const Render_Job &, Reply reply);
+
+            ///Espera a que no quede ningún trabajo en la cola ni en marcha
+            void wait_idle ();
+
+            ///Línea con el rendimiento (trabajos e imágenes por segundo), la latencia y el estado de la caché
+            std::string metrics ();
+
+            ///Ejecuta una línea del protocolo y responde con reply
+            Command_Result handle_command (const std::string & line, const Reply & reply);
+
+            ///Atiende las órdenes de un stream (la entrada estándar) hasta que se acaba o pide terminar, y espera a
+            ///que acaben sus trabajos
+            void serve_stream (std::istream &, std::ostream &);
+
+            ///Atiende conexiones en un socket Unix hasta que alguna pide shutdown. Devuelve false si no se puede abrir
+            ///el socket o si la plataforma no los tiene.
+            bool serve_socket (const std::string & path);
+
+        private:
+
+            void worker_loop ();
+
+            ///Pinta un trabajo. Devuelve false y deja en error el motivo si falla
+            bool run_job (const Render_Job &, size_t & frames, std::string & error);
+        };
+
+    }
+
+#endif
@@ -0,0 +1,57 @@
+/**
+* @file Resolution_Controller.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que elige en cada frame la resolución interna con la que se pinta la escena para no pasarse de un tiempo
+* de render dado
+**/
+
+#include "Resolution_Controller.hpp"
+
+namespace Engine
+{
+    namespace
+    {
+        ///Lo que cambia el número de píxeles al pasar de un escalón a otro
+        inline float area_ratio (int to, int from)
+        {
+            float ratio = Resolution_Controller::scales[to] / Resolution_Controller::scales[from];
+
+            return ratio * ratio;
+        }
+    }
+
+    ///Recibe lo que ha tardado el último render y devuelve la escala con la que hay que hacer el siguiente
+    float Resolution_Controller::next_scale (float render_milliseconds)
+    {
+        average = average < 0.f ? render_milliseconds : average + (render_milliseconds - average) * smoothing;
+
+        if (++frames_since_change < settle_frames) return scales[step];
+
+        int next = step;
+
+        if (average > target)
+        {
+            if (step + 1 < scale_count) next = step + 1;
+        }
+        else
+        if (step > 0 && average * area_ratio (step - 1, step) < target * headroom)
+        {
+            next = step - 1;
+        }
+
+        if (next != step)
+        {
+            //La media sigue a partir de lo que se espera a la nueva resolución, en lugar de arrastrar la anterior
+            average            *= area_ratio (next, step);
+            step                = next;
+            frames_since_change = 0;
+        }
+
+        return scales[step];
+    }
+}
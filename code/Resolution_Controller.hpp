@@ -0,0 +1,59 @@
+/**
+* @file Resolution_Controller.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que elige en cada frame la resolución interna con la que se pinta la escena para no pasarse de un tiempo
+* de render dado
+**/
+
+#ifndef RESOLUTION_CONTROLLER_HEADER
+#define RESOLUTION_CONTROLLER_HEADER
+
+    namespace Engine
+    {
+
+        ///La escala se mueve por escalones fijos. Para no oscilar, el tiempo se suaviza con una media exponencial, después
+        ///de cada cambio se esperan unos frames, y solo se sube un escalón si el tiempo previsto a la nueva resolución
+        ///(que crece con el número de píxeles) deja margen bajo el objetivo.
+        class Resolution_Controller
+        {
+        public:
+
+            ///Fracción de la pantalla, en cada eje, de cada escalón. El último pinta la cuarta parte de los píxeles.
+            static constexpr float scales[]       = { 1.f, .875f, .75f, .625f, .5f };
+            static constexpr int   scale_count    = int(sizeof(scales) / sizeof(scales[0]));
+
+            ///Frames que se esperan tras un cambio, peso de cada frame en la media y fracción del objetivo bajo la que
+            ///se sube de resolución
+            static constexpr int   settle_frames  = 8;
+            static constexpr float smoothing      = .2f;
+            static constexpr float headroom       = .85f;
+
+        private:
+
+            float target;                   ///< Milisegundos de render que no se quieren pasar
+            float average = -1.f;           ///< Media de los últimos frames, o negativa si todavía no hay ninguno
+            int   step    = 0;
+            int   frames_since_change = 0;
+
+        public:
+
+            explicit Resolution_Controller(float target_milliseconds) : target(target_milliseconds)
+            {
+            }
+
+            ///Recibe lo que ha tardado el último render y devuelve la escala con la que hay que hacer el siguiente
+            float next_scale (float render_milliseconds);
+
+            float get_scale   () const { return scales[step]; }
+            float get_average () const { return average;      }
+            float get_target  () const { return target;       }
+        };
+
+    }
+
+#endif
@@ -0,0 +1,201 @@
+/**
+* @file Scene_Description.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda la descripción de una escena (modelos, colores, transformaciones y luces) y la lee de un archivo de texto
+**/
+
+#include "Scene_Description.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace Engine
+{
+    namespace fs = std::filesystem;
+
+    ///Lee la escena de un archivo. Si falla devuelve false y deja en error el motivo.
+    bool Scene_Description::load (const std::string & path, std::string & error)
+    {
+        std::ifstream file(path);
+
+        if (!file)
+        {
+            error = "no se puede abrir " + path;
+            return false;
+        }
+
+        models.clear ();
+        lights.clear ();
+
+        animated = false;
+
+        fs::path    base = fs::path(path).parent_path ();
+        std::string line;
+        int         line_number = 0;
+
+        while (std::getline (file, line))
+        {
+            line_number++;
+
+            line = line.substr (0, line.find ('#'));
+
+            std::istringstream tokens(line);
+            std::string        type;
+
+            if (!(tokens >> type)) continue;
+
+            bool valid = false;
+
+            if (type == "model")
+            {
+                Model_Description model;
+                std::string       model_path;
+
+                valid = bool(tokens >> model_path >> model.red >> model.green >> model.blue >> model.scale
+                                    >> model.x >> model.y >> model.z >> model.rotation_x >> model.rotation_y);
+
+                if (valid)
+                {
+                    unsigned channels;
+                    int      animation;
+                    float    animation_time;
+
+                    if (tokens >> channels)
+                    {
+                        model.light_channels = channels;
+
+                        if (tokens >> animation)
+                        {
+                            model.animation = animation;
+
+                            if (tokens >> animation_time) model.animation_time = animation_time;
+                        }
+                    }
+
+                    model.path = fs::path(model_path).is_absolute () ? model_path : (base / model_path).string ();
+
+                    models.push_back (model);
+                }
+            }
+            else
+            if (type == "directional")
+            {
+                Vector4f direction(0.f, 0.f, 0.f, 0.f);
+                unsigned channels  = 1;
+                float    intensity = 1.f;
+
+                valid = bool(tokens >> direction.x >> direction.y >> direction.z);
+
+                if (valid)
+                {
+                    //Los valores opcionales se leen aparte porque una lectura fallida deja la variable a 0
+                    unsigned read_channels;
+                    float    read_intensity;
+
+                    if (tokens >> read_channels)
+                    {
+                        channels = read_channels;
+
+                        if (tokens >> read_intensity) intensity = read_intensity;
+                    }
+
+                    lights.push_back (Light::directional (direction, channels, intensity));
+                }
+            }
+            else
+            if (type == "point")
+            {
+                Vector3f position;
+                Vector3f color(1.f, 1.f, 1.f);
+                float    range;
+                float    intensity = 1.f;
+                unsigned channels  = 1;
+
+                valid = bool(tokens >> position.x >> position.y >> position.z >> range);
+
+                if (valid)
+                {
+                    Vector3f read_color;
+                    float    read_intensity;
+                    unsigned read_channels;
+
+                    if (tokens >> read_color.x >> read_color.y >> read_color.z)
+                    {
+                        color = read_color;
+
+                        if (tokens >> read_intensity)
+                        {
+                            intensity = read_intensity;
+
+                            if (tokens >> read_channels) channels = read_channels;
+                        }
+                    }
+
+                    lights.push_back (Light::point (position, range, color, intensity, channels));
+                }
+            }
+
+            if (!valid)
+            {
+                error = path + ":" + std::to_string (line_number) + ": entrada no válida";
+                return false;
+            }
+        }
+
+        if (models.empty ())
+        {
+            error = path + ": la escena no tiene modelos";
+            return false;
+        }
+
+        return true;
+    }
+
+    ///Escena de la demo interactiva
+    Scene_Description Scene_Description::default_scene ()
+    {
+        Scene_Description scene;
+
+        scene.animated = true;
+
+        //Luces de la escena. La primera ilumina el canal 1 (conejo y montañas) y la segunda el canal 2 (árboles)
+        scene.lights.push_back (Light::directional ({ 80, 70, -30, 0 }, 1));
+        scene.lights.push_back (Light::directional ({ 5, 50, -20, 0 }, 2));
+
+        //Ruta, color, escala, posición, rotación en x y en y, y canales de iluminación: los árboles usan su propia luz,
+        //y el sol y el fondo no se iluminan
+        scene.models =
+        {
+            //Arbol
+            { "../../shared/assets/Lowpoly_tree_sample.obj", 250.f, 150.f,   0.f, 0.1f,   3.f,  2.f,  -15.f, 0.f,   0.f, 2 },
+
+            //Conejo
+            { "../../shared/assets/stanford-bunny.obj",       15.f,   0.f,   0.f, 1.f,    0.f,  1.f,  -10.f, 0.f,   0.f, 1 },
+
+            //Arboles
+            { "../../shared/assets/Lowpoly_tree_sample.obj", 250.f, 150.f,   0.f, 0.1f,  -2.5f, 1.f,   -5.f, 0.f,   0.f, 2 },
+            { "../../shared/assets/Lowpoly_tree_sample.obj", 250.f, 150.f,   0.f, 0.075f, -1.f, 0.f,  -10.f, 0.f,   0.f, 2 },
+            { "../../shared/assets/Lowpoly_tree_sample.obj", 250.f, 150.f,   0.f, 0.05f,  10.f, 0.f,  -10.f, 0.f,   0.f, 2 },
+
+            //Montañas
+            { "../../shared/assets/mountain.obj",            125.f, 150.f,   0.f, 50.f,  -10.f, 0.f,  -30.f, 0.f, 270.f, 1 },
+            { "../../shared/assets/mountain.obj",            125.f, 150.f,   0.f, 60.f,   10.f, 0.f,  -30.f, 0.f, 270.f, 1 },
+            { "../../shared/assets/mountain.obj",            125.f, 150.f,   0.f, 60.f,    0.f, 0.f,  -25.f, 0.f, 180.f, 1 },
+            { "../../shared/assets/mountain.obj",            125.f, 150.f,   0.f, 60.f,   25.f, 0.f,  -40.f, 0.f, 270.f, 1 },
+            { "../../shared/assets/mountain.obj",            125.f, 150.f,   0.f, 60.f,  -25.f, 0.f,  -40.f, 0.f, 270.f, 1 },
+
+            //Sol
+            { "../../shared/assets/Sun.obj",                 141.f, 151.f,   0.f, 0.2f,   10.f, -3.f, -40.f, 0.f,   0.f, 0 },
+
+            //Fondo
+            { "../../shared/assets/floor.obj",               205.f, 100.f,  50.f, 0.01f,   1.f, 0.f, -100.f, 0.f,   0.f, 0 },
+        };
+
+        return scene;
+    }
+}
@@ -0,0 +1,60 @@
+/**
+* @file Scene_Description.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda la descripción de una escena (modelos, colores, transformaciones y luces) y la lee de un archivo de texto
+**/
+
+#ifndef SCENE_DESCRIPTION_HEADER
+#define SCENE_DESCRIPTION_HEADER
+
+    #include <string>
+    #include <vector>
+    #include "Light.hpp"
+
+    namespace Engine
+    {
+
+        ///Modelo de una escena, con los mismos parámetros que el constructor de Model
+        struct Model_Description
+        {
+            std::string path;
+            float       red, green, blue;
+            float       scale;
+            float       x, y, z;
+            float       rotation_x, rotation_y;
+            unsigned    light_channels = 1;
+            bool        active         = true;
+            int         animation      = 0;         ///< Animación que reproduce si el modelo tiene huesos
+            float       animation_time = 0.f;       ///< Segundo de la animación en el que empieza
+        };
+
+        ///Escena completa. El formato de texto tiene una entrada por línea ('#' para comentarios):
+        ///
+        ///    model <ruta> <rojo> <verde> <azul> <escala> <x> <y> <z> <rotación x> <rotación y> [canales] [animación] [segundo]
+        ///    directional <x> <y> <z> [canales] [intensidad]
+        ///    point <x> <y> <z> <radio> [rojo verde azul] [intensidad] [canales]
+        ///
+        ///Las rutas de los modelos son relativas al archivo de la escena.
+        struct Scene_Description
+        {
+            std::vector< Model_Description > models;
+            std::vector< Light >             lights;
+
+            ///Si es true la escena es la de la demo y el update mueve el sol y sus luces
+            bool                             animated = false;
+
+            ///Lee la escena de un archivo. Si falla devuelve false y deja en error el motivo.
+            bool load (const std::string & path, std::string & error);
+
+            ///Escena de la demo interactiva
+            static Scene_Description default_scene ();
+        };
+
+    }
+
+#endif
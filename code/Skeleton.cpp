@@ -0,0 +1,407 @@
+/**
+* @file Skeleton.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda el esqueleto y las animaciones de los modelos con huesos, calcula la pose de un instante y deforma
+* los vértices con skinning lineal (hasta cuatro huesos por vértice)
+**/
+
+#include "Skeleton.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <glm/gtc/quaternion.hpp>
+#include <assimp/scene.h>
+
+namespace Engine
+{
+    using std::string;
+    using std::vector;
+
+    namespace
+    {
+        ///Assimp guarda las matrices por filas y Matrix44 por columnas
+        Matrix44 to_matrix (const aiMatrix4x4 & m)
+        {
+            Matrix44 result;
+
+            result[0] = Vector4f(m.a1, m.b1, m.c1, m.d1);
+            result[1] = Vector4f(m.a2, m.b2, m.c2, m.d2);
+            result[2] = Vector4f(m.a3, m.b3, m.c3, m.d3);
+            result[3] = Vector4f(m.a4, m.b4, m.c4, m.d4);
+
+            return result;
+        }
+
+        ///Interpola las claves que rodean al instante dado. Si no hay claves devuelve el valor por defecto.
+        template< class VALUE, class MIX >
+        VALUE sample_keys (const vector< float > & times, const vector< VALUE > & values, float time, const VALUE & fallback, MIX mix)
+        {
+            if (values.empty ()) return fallback;
+
+            if (values.size () == 1 || time <= times.front ()) return values.front ();
+            if (time >= times.back ()) return values.back ();
+
+            size_t next  = size_t(std::upper_bound (times.begin (), times.end (), time) - times.begin ());
+            float  begin = times[next - 1];
+            float  span  = times[next] - begin;
+
+            return mix (values[next - 1], values[next], span > 0.f ? (time - begin) / span : 0.f);
+        }
+
+        Vector3f mix_vectors (const Vector3f & a, const Vector3f & b, float t)
+        {
+            return a + (b - a) * t;
+        }
+
+        Quaternion mix_rotations (const Quaternion & a, const Quaternion & b, float t)
+        {
+            return glm::slerp (a, b, t);
+        }
+
+        ///Deja el hueso y su peso entre los max_bones de mayor peso del vértice, ordenados de mayor a menor
+        void add_influence (Skin_Influences & influences, uint16_t bone, float weight)
+        {
+            int slot = Skin_Influences::max_bones;
+
+            while (slot > 0 && influences.weights[slot - 1] < weight) slot--;
+
+            if (slot == Skin_Influences::max_bones) return;
+
+            for (int index = Skin_Influences::max_bones - 1; index > slot; --index)
+            {
+                influences.bones  [index] = influences.bones  [index - 1];
+                influences.weights[index] = influences.weights[index - 1];
+            }
+
+            influences.bones  [slot] = bone;
+            influences.weights[slot] = weight;
+        }
+    }
+
+    ///Lee los huesos del mesh y las animaciones de la escena, y deja en influences los huesos y pesos de cada vértice.
+    ///Devuelve false si el mesh no tiene huesos.
+    bool Skeleton::import (const aiScene * scene, const aiMesh * mesh, vector< Skin_Influences > & influences)
+    {
+        if (!scene || !scene->mRootNode || !mesh || mesh->mNumBones == 0) return false;
+
+        nodes       .clear ();
+        bone_nodes  .clear ();
+        bone_offsets.clear ();
+        clips       .clear ();
+
+        // Se aplana la jerarquía de nodos en profundidad, de forma que cada padre quede antes que sus hijos:
+
+        std::map< string, int > node_index;
+
+        vector< std::pair< const aiNode *, int > > pending(1, { scene->mRootNode, -1 });
+
+        while (!pending.empty ())
+        {
+            const aiNode * node   = pending.back ().first;
+            int            parent = pending.back ().second;
+
+            pending.pop_back ();
+
+            int index = int(nodes.size ());
+
+            nodes.push_back ({ string(node->mName.C_Str ()), parent, to_matrix (node->mTransformation) });
+
+            node_index.emplace (nodes.back ().name, index);
+
+            for (unsigned child = node->mNumChildren; child > 0; --child)
+            {
+                pending.push_back ({ node->mChildren[child - 1], index });
+            }
+        }
+
+        global_inverse = inverse (nodes[0].local);
+
+        // Huesos del mesh y sus pesos. Si un vértice tiene más de max_bones se quedan los de más peso:
+
+        size_t number_of_bones = mesh->mNumBones;
+
+        Skin_Influences empty;
+
+        std::fill_n (empty.bones,   Skin_Influences::max_bones, uint16_t(number_of_bones));
+        std::fill_n (empty.weights, Skin_Influences::max_bones, 0.f);
+
+        influences.assign (mesh->mNumVertices, empty);
+
+        for (size_t bone = 0; bone < number_of_bones; ++bone)
+        {
+            const aiBone * source = mesh->mBones[bone];
+
+            auto node = node_index.find (string(source->mName.C_Str ()));
+
+            bone_nodes  .push_back (node != node_index.end () ? node->second : 0);
+            bone_offsets.push_back (to_matrix (source->mOffsetMatrix));
+
+            for (unsigned weight = 0; weight < source->mNumWeights; ++weight)
+            {
+                const aiVertexWeight & vertex_weight = source->mWeights[weight];
+
+                if (vertex_weight.mVertexId < mesh->mNumVertices && vertex_weight.mWeight > 0.f)
+                {
+                    add_influence (influences[vertex_weight.mVertexId], uint16_t(bone), vertex_weight.mWeight);
+                }
+            }
+        }
+
+        // Los pesos que quedan se normalizan. Los vértices sin pesos usan la identidad que va al final de la paleta:
+
+        for (Skin_Influences & vertex : influences)
+        {
+            float total = 0.f;
+
+            for (float weight : vertex.weights) total += weight;
+
+            if (total <= 0.f)
+            {
+                vertex.weights[0] = 1.f;
+                continue;
+            }
+
+            for (float & weight : vertex.weights) weight /= total;
+        }
+
+        // Animaciones. Los tiempos se pasan de ticks a segundos:
+
+        for (unsigned animation = 0; animation < scene->mNumAnimations; ++animation)
+        {
+            const aiAnimation * source = scene->mAnimations[animation];
+
+            float ticks_per_second = source->mTicksPerSecond > 0.0 ? float(source->mTicksPerSecond) : 25.f;
+
+            Animation_Clip clip;
+
+            clip.name     = source->mName.C_Str ();
+            clip.duration = float(source->mDuration) / ticks_per_second;
+
+            clip.node_channel.assign (nodes.size (), -1);
+
+            for (unsigned channel = 0; channel < source->mNumChannels; ++channel)
+            {
+                const aiNodeAnim * keys = source->mChannels[channel];
+
+                auto node = node_index.find (string(keys->mNodeName.C_Str ()));
+
+                if (node == node_index.end ()) continue;
+
+                Animation_Channel target;
+
+                target.node = node->second;
+
+                for (unsigned key = 0; key < keys->mNumPositionKeys; ++key)
+                {
+                    const aiVectorKey & value = keys->mPositionKeys[key];
+
+                    target.position_times.push_back (float(value.mTime) / ticks_per_second);
+                    target.positions     .push_back (Vector3f(value.mValue.x, value.mValue.y, value.mValue.z));
+                }
+
+                for (unsigned key = 0; key < keys->mNumRotationKeys; ++key)
+                {
+                    const aiQuatKey & value = keys->mRotationKeys[key];
+
+                    target.rotation_times.push_back (float(value.mTime) / ticks_per_second);
+                    target.rotations     .push_back (Quaternion(value.mValue.w, value.mValue.x, value.mValue.y, value.mValue.z));
+                }
+
+                for (unsigned key = 0; key < keys->mNumScalingKeys; ++key)
+                {
+                    const aiVectorKey & value = keys->mScalingKeys[key];
+
+                    target.scaling_times.push_back (float(value.mTime) / ticks_per_second);
+                    target.scalings     .push_back (Vector3f(value.mValue.x, value.mValue.y, value.mValue.z));
+                }
+
+                clip.node_channel[target.node] = int(clip.channels.size ());
+                clip.channels.push_back (std::move (target));
+            }
+
+            clips.push_back (std::move (clip));
+        }
+
+        return true;
+    }
+
+    ///Calcula la matriz de cada hueso en el instante dado de la animación, más una identidad al final para los vértices
+    ///que no tienen pesos
+    void Skeleton::pose (int clip_index, float time, vector< Matrix44 > & global, Skin_Matrix * palette) const
+    {
+        const Animation_Clip * clip = clip_index >= 0 && clip_index < int(clips.size ()) ? &clips[clip_index] : nullptr;
+
+        if (clip && clip->duration > 0.f)
+        {
+            time = std::fmod (time, clip->duration);
+
+            if (time < 0.f) time += clip->duration;
+        }
+
+        // Se recorre la jerarquía de los padres a los hijos acumulando las transformaciones:
+
+        global.resize (nodes.size ());
+
+        Matrix44 identity(1);
+
+        for (size_t index = 0, number_of_nodes = nodes.size (); index < number_of_nodes; ++index)
+        {
+            const Node & node    = nodes[index];
+            int          channel = clip ? clip->node_channel[index] : -1;
+
+            Matrix44 local = node.local;
+
+            if (channel >= 0)
+            {
+                const Animation_Channel & keys = clip->channels[channel];
+
+                Vector3f   position = sample_keys (keys.position_times, keys.positions, time, Vector3f(0.f, 0.f, 0.f), mix_vectors  );
+                Quaternion rotation = sample_keys (keys.rotation_times, keys.rotations, time, Quaternion(1.f, 0.f, 0.f, 0.f), mix_rotations);
+                Vector3f   scaling  = sample_keys (keys.scaling_times,  keys.scalings,  time, Vector3f(1.f, 1.f, 1.f), mix_vectors  );
+
+                local = translate (identity, position) * glm::mat4_cast (rotation) * scale (identity, scaling.x, scaling.y, scaling.z);
+            }
+
+            global[index] = node.parent < 0 ? local : global[node.parent] * local;
+        }
+
+        // Model guarda los vértices con la y invertida, así que cada matriz se pasa a ese espacio invirtiendo la fila
+        // y la columna de la y:
+
+        for (size_t bone = 0, number_of_bones = bone_nodes.size (); bone < number_of_bones; ++bone)
+        {
+            Matrix44 matrix = global_inverse * global[bone_nodes[bone]] * bone_offsets[bone];
+
+            for (int column = 0; column < 4; ++column)
+            {
+                for (int row = 0; row < 4; ++row)
+                {
+                    palette[bone].columns[column][row] = (row == 1) != (column == 1) ? -matrix[column][row] : matrix[column][row];
+                }
+            }
+        }
+
+        Skin_Matrix & last = palette[bone_nodes.size ()];
+
+        for (int column = 0; column < 4; ++column)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                last.columns[column][row] = row == column ? 1.f : 0.f;
+            }
+        }
+    }
+
+    ///Deforma count vértices con skinning lineal. Las normales se guardan sin invertir la y, como en Model.
+    void skin_vertices
+    (
+        const Skin_Matrix     * palette,
+        const Skin_Influences * influences,
+        const Point4f         * positions,
+        const Point4f         * normals,
+        Point4f               * skinned_positions,
+        Point4f               * skinned_normals,
+        size_t                  count
+    )
+    {
+        // Las matrices de los huesos de cada vértice se mezclan por pesos y el vértice se transforma una sola vez con
+        // el resultado. Los pesos están ordenados, así que se para en el primero que vale 0:
+
+    #ifdef SKELETON_SSE2
+
+        //La normal se pasa al espacio de las matrices (con la y invertida) y se devuelve al suyo con el mismo signo
+        const __m128 flip_y = _mm_set_ps (0.f, 1.f, -1.f, 1.f);
+
+        for (size_t index = 0; index < count; ++index)
+        {
+            const Skin_Influences & vertex = influences[index];
+
+            const Skin_Matrix & first  = palette[vertex.bones[0]];
+            __m128              weight = _mm_set1_ps (vertex.weights[0]);
+
+            __m128 column0 = _mm_mul_ps (weight, _mm_load_ps (first.columns[0]));
+            __m128 column1 = _mm_mul_ps (weight, _mm_load_ps (first.columns[1]));
+            __m128 column2 = _mm_mul_ps (weight, _mm_load_ps (first.columns[2]));
+            __m128 column3 = _mm_mul_ps (weight, _mm_load_ps (first.columns[3]));
+
+            for (int influence = 1; influence < Skin_Influences::max_bones && vertex.weights[influence] > 0.f; ++influence)
+            {
+                const Skin_Matrix & matrix = palette[vertex.bones[influence]];
+
+                weight = _mm_set1_ps (vertex.weights[influence]);
+
+                column0 = _mm_add_ps (column0, _mm_mul_ps (weight, _mm_load_ps (matrix.columns[0])));
+                column1 = _mm_add_ps (column1, _mm_mul_ps (weight, _mm_load_ps (matrix.columns[1])));
+                column2 = _mm_add_ps (column2, _mm_mul_ps (weight, _mm_load_ps (matrix.columns[2])));
+                column3 = _mm_add_ps (column3, _mm_mul_ps (weight, _mm_load_ps (matrix.columns[3])));
+            }
+
+            const Point4f & position = positions[index];
+            const Point4f & normal   = normals  [index];
+
+            __m128 skinned_position = _mm_add_ps
+            (
+                _mm_add_ps (_mm_mul_ps (column0, _mm_set1_ps (position.x)), _mm_mul_ps (column1, _mm_set1_ps (position.y))),
+                _mm_add_ps (_mm_mul_ps (column2, _mm_set1_ps (position.z)), column3)
+            );
+
+            __m128 skinned_normal = _mm_add_ps
+            (
+                _mm_add_ps (_mm_mul_ps (column0, _mm_set1_ps (normal.x)), _mm_mul_ps (column1, _mm_set1_ps (-normal.y))),
+                _mm_mul_ps (column2, _mm_set1_ps (normal.z))
+            );
+
+            _mm_storeu_ps (&skinned_positions[index].x, skinned_position);
+            _mm_storeu_ps (&skinned_normals  [index].x, _mm_mul_ps (skinned_normal, flip_y));
+
+            //Los pesos pueden no sumar exactamente 1
+            skinned_positions[index].w = 1.f;
+        }
+
+    #else
+
+        for (size_t index = 0; index < count; ++index)
+        {
+            const Skin_Influences & vertex = influences[index];
+
+            float blended[4][4] = {};
+
+            for (int influence = 0; influence < Skin_Influences::max_bones && (influence == 0 || vertex.weights[influence] > 0.f); ++influence)
+            {
+                const Skin_Matrix & matrix = palette[vertex.bones[influence]];
+                float               weight = vertex.weights[influence];
+
+                for (int column = 0; column < 4; ++column)
+                {
+                    for (int row = 0; row < 3; ++row)
+                    {
+                        blended[column][row] += weight * matrix.columns[column][row];
+                    }
+                }
+            }
+
+            const Point4f & position = positions[index];
+            const Point4f & normal   = normals  [index];
+
+            Point4f & skinned_position = skinned_positions[index];
+            Point4f & skinned_normal   = skinned_normals  [index];
+
+            for (int row = 0; row < 3; ++row)
+            {
+                skinned_position[row] = blended[0][row] * position.x + blended[1][row] * position.y + blended[2][row] * position.z + blended[3][row];
+                skinned_normal  [row] = blended[0][row] * normal.x   - blended[1][row] * normal.y   + blended[2][row] * normal.z;
+            }
+
+            skinned_position.w = 1.f;
+            skinned_normal.y   = -skinned_normal.y;
+            skinned_normal.w   = 0.f;
+        }
+
+    #endif
+    }
+}
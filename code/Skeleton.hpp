@@ -0,0 +1,122 @@
+/**
+* @file Skeleton.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda el esqueleto y las animaciones de los modelos con huesos, calcula la pose de un instante y deforma
+* los vértices con skinning lineal (hasta cuatro huesos por vértice)
+**/
+
+#ifndef SKELETON_HEADER
+#define SKELETON_HEADER
+
+    #include <cstdint>
+    #include <string>
+    #include <vector>
+    #include "math.hpp"
+
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #include <emmintrin.h>
+        #define SKELETON_SSE2
+    #endif
+
+    struct aiScene;
+    struct aiMesh;
+
+    namespace Engine
+    {
+
+        ///Huesos que mueven un vértice y su peso, de mayor a menor. Los pesos suman 1 y los que sobran valen 0.
+        struct Skin_Influences
+        {
+            static constexpr int max_bones = 4;
+
+            uint16_t bones  [max_bones];
+            float    weights[max_bones];
+        };
+
+        ///Matriz de un hueso en la pose actual, por columnas como Matrix44, alineada para cargar cada columna de una vez
+        struct alignas(16) Skin_Matrix
+        {
+            float columns[4][4];
+        };
+
+        ///Claves de un nodo en una animación. Los tiempos están en segundos.
+        struct Animation_Channel
+        {
+            int                       node;
+
+            std::vector< float      > position_times;
+            std::vector< Vector3f   > positions;
+            std::vector< float      > rotation_times;
+            std::vector< Quaternion > rotations;
+            std::vector< float      > scaling_times;
+            std::vector< Vector3f   > scalings;
+        };
+
+        ///Animación del esqueleto. Se repite en bucle.
+        struct Animation_Clip
+        {
+            std::string                      name;
+            float                            duration;       ///< Segundos
+            std::vector< Animation_Channel > channels;
+            std::vector< int >               node_channel;   ///< Canal de cada nodo, o -1 si el nodo no se anima
+        };
+
+        ///Jerarquía de nodos de la escena importada, huesos que deforman el mesh y animaciones. Es de solo lectura una
+        ///vez importado, por lo que varios modelos (y varios hilos) pueden compartirlo.
+        class Skeleton
+        {
+        public:
+
+            struct Node
+            {
+                std::string name;
+                int         parent;                         ///< Los padres van siempre antes que sus hijos
+                Matrix44    local;                          ///< Transformación respecto al padre fuera de la animación
+            };
+
+        private:
+
+            std::vector< Node           > nodes;
+            std::vector< int            > bone_nodes;       ///< Nodo de cada hueso
+            std::vector< Matrix44       > bone_offsets;     ///< Del espacio del mesh al del hueso en la pose de reposo
+            std::vector< Animation_Clip > clips;
+            Matrix44                      global_inverse;
+
+        public:
+
+            ///Lee los huesos del mesh y las animaciones de la escena, y deja en influences los huesos y pesos de cada
+            ///vértice. Devuelve false si el mesh no tiene huesos.
+            bool import (const aiScene * scene, const aiMesh * mesh, std::vector< Skin_Influences > & influences);
+
+            ///Calcula la matriz de cada hueso en el instante dado de la animación, más una identidad al final para los
+            ///vértices que no tienen pesos. Las matrices pasan del espacio del modelo en reposo (con la y invertida,
+            ///como lo guarda Model) al deformado. En global se dejan las transformaciones de los nodos.
+            void pose (int clip, float time, std::vector< Matrix44 > & global, Skin_Matrix * palette) const;
+
+            ///Número de matrices que escribe pose
+            size_t palette_size () const { return bone_nodes.size () + 1; }
+
+            const std::vector< Animation_Clip > & get_clips () const { return clips; }
+        };
+
+        ///Deforma count vértices con skinning lineal. Las normales se guardan sin invertir la y, como en Model, y no se
+        ///normalizan. Con SSE2 cada columna de la matriz mezclada se calcula en una sola operación.
+        void skin_vertices
+        (
+            const Skin_Matrix     * palette,
+            const Skin_Influences * influences,
+            const Point4f         * positions,
+            const Point4f         * normals,
+            Point4f               * skinned_positions,
+            Point4f               * skinned_normals,
+            size_t                  count
+        );
+
+    }
+
+#endif
@@ -0,0 +1,260 @@
+/**
+* @file Stats.cpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda las estadísticas de cada frame: contadores del pipeline y tiempos por modelo y por etapa.
+**/
+
+#include "Stats.hpp"
+#include "Memory_Tracker.hpp"
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+namespace Engine
+{
+    namespace
+    {
+        ///Cada hilo recibe un número pequeño y estable para la traza
+        unsigned current_thread_index ()
+        {
+            static std::atomic< unsigned > next_index{ 0 };
+            thread_local unsigned index = next_index++;
+
+            return index;
+        }
+
+        uint64_t take (std::atomic< uint64_t > & counter)
+        {
+            return counter.exchange (0, std::memory_order_relaxed);
+        }
+
+        int64_t sum_time (const std::vector< Timer_Sample > & timers, const char * name, int model)
+        {
+            int64_t total = 0;
+
+            for (const Timer_Sample & sample : timers)
+            {
+                if (std::strcmp (sample.name, name) == 0 && (model < 0 || sample.model == model))
+                {
+                    total += sample.duration;
+                }
+            }
+
+            return total;
+        }
+    }
+
+    Stats & Stats::instance ()
+    {
+        static Stats stats;
+
+        return stats;
+    }
+
+    Stats::Stats()
+    :
+        start       (Clock::now ()),
+        frame_number(0),
+        frame_begin (0)
+    {
+    }
+
+    ///Marca el inicio de un frame
+    void Stats::begin_frame ()
+    {
+        frame_begin = now ();
+    }
+
+    ///Cierra el frame: guarda los contadores y los tiempos y los pone a cero
+    void Stats::end_frame ()
+    {
+        Frame_Stats frame;
+
+        frame.triangles_in         = take (counters.triangles_in        );
+        frame.triangles_culled     = take (counters.triangles_culled    );
+        frame.triangles_clipped    = take (counters.triangles_clipped   );
+        frame.triangles_rasterized = take (counters.triangles_rasterized);
+        frame.triangles_small      = take (counters.triangles_small     );
+        frame.pixels_tested        = take (counters.pixels_tested       );
+        frame.pixels_passed        = take (counters.pixels_passed       );
+        frame.pixels_overdrawn     = take (counters.pixels_overdrawn    );
+        frame.pixels_resolved      = take (counters.pixels_resolved     );
+        frame.vertices_skinned     = take (counters.vertices_skinned    );
+        frame.draw_commands        = take (counters.draw_commands       );
+
+        std::lock_guard< std::mutex > lock(mutex);
+
+        last_frame_stats = frame;
+        last_frame_timers.swap (current_timers);
+        current_timers.clear ();
+
+        //Se guarda el historial para la traza, descartando los frames más antiguos
+        if (frame_history.size () == history_size)
+        {
+            frame_history      .erase (frame_history      .begin ());
+            timer_history      .erase (timer_history      .begin ());
+            frame_begin_history.erase (frame_begin_history.begin ());
+        }
+
+        frame_history      .push_back (frame);
+        timer_history      .push_back (last_frame_timers);
+        frame_begin_history.push_back (frame_begin);
+
+        frame_number++;
+    }
+
+    void Stats::add_timer (const Timer_Sample & sample)
+    {
+        std::lock_guard< std::mutex > lock(mutex);
+
+        current_timers.push_back (sample);
+    }
+
+    unsigned Stats::get_frame_number () const
+    {
+        std::lock_guard< std::mutex > lock(mutex);
+
+        return frame_number;
+    }
+
+    Frame_Stats Stats::last_frame () const
+    {
+        std::lock_guard< std::mutex > lock(mutex);
+
+        return last_frame_stats;
+    }
+
+    std::vector< Timer_Sample > Stats::last_timers () const
+    {
+        std::lock_guard< std::mutex > lock(mutex);
+
+        return last_frame_timers;
+    }
+
+    ///Suma los microsegundos del último frame de una etapa, para un modelo o para todos (-1)
+    int64_t Stats::total_time (const char * name, int model) const
+    {
+        std::lock_guard< std::mutex > lock(mutex);
+
+        return sum_time (last_frame_timers, name, model);
+    }
+
+    ///Escribe un resumen legible del último frame
+    void Stats::print (std::ostream & out) const
+    {
+        // Se copia lo que hace falta del último frame y se escribe sin bloquear a quien cierra el siguiente:
+
+        Frame_Stats frame;
+        unsigned    number;
+        int64_t     update_time;
+        int64_t     render_time;
+
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+
+            frame       = last_frame_stats;
+            number      = frame_number;
+            update_time = sum_time (last_frame_timers, "update", -1);
+            render_time = sum_time (last_frame_timers, "render", -1);
+        }
+
+        out << "frame "                  << number
+            << " | triangles in "        << frame.triangles_in
+            << " culled "                << frame.triangles_culled
+            << " clipped "               << frame.triangles_clipped
+            << " rasterized "            << frame.triangles_rasterized
+            << " small "                 << frame.triangles_small
+            << " | pixels tested "       << frame.pixels_tested
+            << " passed "                << frame.pixels_passed
+            << " overdrawn "             << frame.pixels_overdrawn
+            << " resolved "              << frame.pixels_resolved
+            << " | vertices skinned "    << frame.vertices_skinned
+            << " | draw commands "       << frame.draw_commands
+            << " | update "              << update_time
+            << "us render "              << render_time
+            << "us\n";
+
+        Memory_Tracker::instance ().print (out);
+    }
+
+    ///Exporta los frames guardados en formato JSON de Chrome trace (chrome://tracing, Perfetto)
+    bool Stats::write_chrome_trace (const char * path) const
+    {
+        FILE * file = std::fopen (path, "w");
+
+        if (!file) return false;
+
+        std::lock_guard< std::mutex > lock(mutex);
+
+        std::fprintf (file, "{\"traceEvents\":[\n");
+
+        bool first = true;
+
+        for (size_t frame = 0; frame < frame_history.size (); ++frame)
+        {
+            for (const Timer_Sample & sample : timer_history[frame])
+            {
+                std::fprintf
+                (
+                    file, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%lld,\"dur\":%lld,\"args\":{\"model\":%d}}",
+                    first ? "" : ",\n",
+                    sample.name,
+                    sample.model < 0 ? "stage" : "model",
+                    sample.thread,
+                    (long long)sample.begin,
+                    (long long)sample.duration,
+                    sample.model
+                );
+
+                first = false;
+            }
+
+            //Los contadores se exportan como eventos de tipo contador al inicio de cada frame
+            const Frame_Stats & counters = frame_history[frame];
+
+            std::fprintf
+            (
+                file, "%s{\"name\":\"triangles\",\"ph\":\"C\",\"pid\":0,\"ts\":%lld,\"args\":{\"in\":%llu,\"culled\":%llu,\"clipped\":%llu,\"rasterized\":%llu,\"small\":%llu}},\n"
+                "{\"name\":\"pixels\",\"ph\":\"C\",\"pid\":0,\"ts\":%lld,\"args\":{\"tested\":%llu,\"passed\":%llu,\"overdrawn\":%llu,\"resolved\":%llu}},\n"
+                "{\"name\":\"vertices\",\"ph\":\"C\",\"pid\":0,\"ts\":%lld,\"args\":{\"skinned\":%llu}},\n"
+                "{\"name\":\"draws\",\"ph\":\"C\",\"pid\":0,\"ts\":%lld,\"args\":{\"commands\":%llu}}",
+                first ? "" : ",\n",
+                (long long)frame_begin_history[frame],
+                (unsigned long long)counters.triangles_in,
+                (unsigned long long)counters.triangles_culled,
+                (unsigned long long)counters.triangles_clipped,
+                (unsigned long long)counters.triangles_rasterized,
+                (unsigned long long)counters.triangles_small,
+                (long long)frame_begin_history[frame],
+                (unsigned long long)counters.pixels_tested,
+                (unsigned long long)counters.pixels_passed,
+                (unsigned long long)counters.pixels_overdrawn,
+                (unsigned long long)counters.pixels_resolved,
+                (long long)frame_begin_history[frame],
+                (unsigned long long)counters.vertices_skinned,
+                (long long)frame_begin_history[frame],
+                (unsigned long long)counters.draw_commands
+            );
+
+            first = false;
+        }
+
+        std::fprintf (file, "\n]}\n");
+
+        return std::fclose (file) == 0;
+    }
+
+    Scoped_Timer::~Scoped_Timer()
+    {
+        Stats & stats = Stats::instance ();
+
+        int64_t end = stats.now ();
+
+        stats.add_timer ({ name, model, current_thread_index (), begin, end - begin });
+    }
+}
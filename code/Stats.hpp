@@ -0,0 +1,171 @@
+/**
+* @file Stats.hpp
+* Copyright (c) David Martín
+* @author David Martín Almazán
+* @date 19 de Octubre de 2026
+* @section LICENSE
+* Licencia MIT
+* @section DESCRIPTION
+* Script que guarda las estadísticas de cada frame: contadores del pipeline y tiempos por modelo y por etapa.
+* Los contadores y timers solo se compilan si se define MESH_LOADER_STATS; si no, las macros no generan código.
+**/
+
+#ifndef STATS_HEADER
+#define STATS_HEADER
+
+    #include <atomic>
+    #include <chrono>
+    #include <cstdint>
+    #include <mutex>
+    #include <ostream>
+    #include <vector>
+
+    namespace Engine
+    {
+
+        ///Contadores de un frame ya cerrado
+        struct Frame_Stats
+        {
+            uint64_t triangles_in         = 0;          ///< Triángulos enviados a Render
+            uint64_t triangles_culled     = 0;          ///< Descartados por backface culling o por clusters
+            uint64_t triangles_clipped    = 0;          ///< Descartados por quedar fuera de la pantalla
+            uint64_t triangles_rasterized = 0;          ///< Triángulos que llegan al rasterizer
+            uint64_t triangles_small      = 0;          ///< Resueltos sin recorrer los lados: sin píxeles o de una scanline
+            uint64_t pixels_tested        = 0;          ///< Fragmentos que pasan por el test de profundidad
+            uint64_t pixels_passed        = 0;          ///< Fragmentos que pasan el test y se escriben
+            uint64_t pixels_overdrawn     = 0;          ///< Fragmentos escritos sobre un píxel ya escrito en el frame
+            uint64_t pixels_resolved      = 0;          ///< Píxeles sombreados por el resolve del buffer de visibilidad
+            uint64_t vertices_skinned     = 0;          ///< Vértices deformados por los esqueletos
+            uint64_t draw_commands        = 0;          ///< Rangos de triángulos que ejecuta la cola de render
+        };
+
+        ///Intervalo de tiempo medido por un Scoped_Timer
+        struct Timer_Sample
+        {
+            const char * name;                          ///< Etapa ("update", "render", ...)
+            int          model;                         ///< Índice del modelo o -1 si es una etapa completa
+            unsigned     thread;
+            int64_t      begin;                         ///< Microsegundos desde el arranque
+            int64_t      duration;
+        };
+
+        class Stats
+        {
+        public:
+
+            typedef std::chrono::steady_clock Clock;
+
+            ///Contadores del frame en curso. Se incrementan desde cualquier hilo.
+            struct Counters
+            {
+                std::atomic< uint64_t > triangles_in        { 0 };
+                std::atomic< uint64_t > triangles_culled    { 0 };
+                std::atomic< uint64_t > triangles_clipped   { 0 };
+                std::atomic< uint64_t > triangles_rasterized{ 0 };
+                std::atomic< uint64_t > triangles_small     { 0 };
+                std::atomic< uint64_t > pixels_tested       { 0 };
+                std::atomic< uint64_t > pixels_passed       { 0 };
+                std::atomic< uint64_t > pixels_overdrawn    { 0 };
+                std::atomic< uint64_t > pixels_resolved     { 0 };
+                std::atomic< uint64_t > vertices_skinned    { 0 };
+                std::atomic< uint64_t > draw_commands       { 0 };
+            };
+
+            Counters counters;
+
+        private:
+
+            ///Número de frames que se guardan para exportar la traza
+            static constexpr size_t history_size = 600;
+
+            Clock::time_point            start;
+            mutable std::mutex           mutex;         ///< Protege lo que se cierra en end_frame, que se puede leer desde otro hilo
+
+            unsigned                     frame_number;
+            Frame_Stats                  last_frame_stats;
+            std::vector< Timer_Sample >  current_timers;
+            std::vector< Timer_Sample >  last_frame_timers;
+
+            std::vector< Frame_Stats >                  frame_history;
+            std::vector< std::vector< Timer_Sample > >  timer_history;
+            std::vector< int64_t >                      frame_begin_history;
+            int64_t                                     frame_begin;
+
+        public:
+
+            static Stats & instance ();
+
+            Stats();
+
+            ///Marca el inicio de un frame
+            void begin_frame ();
+            ///Cierra el frame: guarda los contadores y los tiempos y los pone a cero
+            void end_frame   ();
+
+            ///Devuelve los microsegundos pasados desde que se creó el objeto
+            int64_t now () const
+            {
+                return std::chrono::duration_cast< std::chrono::microseconds >(Clock::now () - start).count ();
+            }
+
+            void add_timer (const Timer_Sample &);
+
+            ///Copias del último frame cerrado, que se pueden pedir mientras otro hilo cierra el siguiente
+            unsigned                    get_frame_number () const;
+            Frame_Stats                 last_frame       () const;
+            std::vector< Timer_Sample > last_timers      () const;
+
+            ///Suma los microsegundos del último frame de una etapa, para un modelo o para todos (-1)
+            int64_t total_time (const char * name, int model = -1) const;
+
+            ///Escribe un resumen legible del último frame
+            void print (std::ostream &) const;
+
+            ///Exporta los frames guardados en formato JSON de Chrome trace (chrome://tracing, Perfetto)
+            bool write_chrome_trace (const char * path) const;
+        };
+
+        ///Mide el tiempo entre su construcción y su destrucción y lo guarda en las estadísticas
+        class Scoped_Timer
+        {
+            const char * name;
+            int          model;
+            int64_t      begin;
+
+        public:
+
+            Scoped_Timer(const char * name, int model = -1)
+            :
+                name (name ),
+                model(model),
+                begin(Stats::instance ().now ())
+            {
+            }
+
+           ~Scoped_Timer();
+        };
+
+    }
+
+    #ifdef MESH_LOADER_STATS
+
+        #define ENGINE_STATS_CONCAT_(a, b)           a##b
+        #define ENGINE_STATS_CONCAT(a, b)            ENGINE_STATS_CONCAT_(a, b)
+
+        #define ENGINE_STATS_ADD(counter, value)     Engine::Stats::instance ().counters.counter.fetch_add (uint64_t(value), std::memory_order_relaxed)
+        #define ENGINE_STATS_SCOPE(name, model)      Engine::Scoped_Timer ENGINE_STATS_CONCAT(stats_scope_, __LINE__) (name, model)
+        #define ENGINE_STATS_LOCAL(declaration)      declaration
+        #define ENGINE_STATS_BEGIN_FRAME()           Engine::Stats::instance ().begin_frame ()
+        #define ENGINE_STATS_END_FRAME()             Engine::Stats::instance ().end_frame ()
+
+    #else
+
+        #define ENGINE_STATS_ADD(counter, value)     ((void)0)
+        #define ENGINE_STATS_SCOPE(name, model)      ((void)0)
+        #define ENGINE_STATS_LOCAL(declaration)
+        #define ENGINE_STATS_BEGIN_FRAME()           ((void)0)
+        #define ENGINE_STATS_END_FRAME()             ((void)0)
+
+    #endif
+
+#endif
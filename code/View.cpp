@@ -9,10 +9,17 @@
 * Script que guarda todos los objetos, y llama a su propio update, render y post render
 **/
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <iostream>
+#include <limits>
 #include "math.hpp"
 #include "View.hpp"
+#include "Asset_Cache.hpp"
+#include "Parallel.hpp"
+#include "Stats.hpp"
+#include "Memory_Tracker.hpp"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -20,66 +27,188 @@
 
 namespace Engine
 {
-    ///Constructor por defecto
-    View::View(unsigned width, unsigned height)
+    bool View::use_visibility_buffer = false;
+    bool View::draw_front_to_back    = false;
+
+    ///Constructor por defecto: crea la escena de la demo
+    View::View(unsigned width, unsigned height) : View(width, height, Scene_Description::default_scene())
+    {
+    }
+
+    ///Constructor que crea la escena descrita. Con una caché los modelos ya cargados no se vuelven a leer.
+    View::View(unsigned width, unsigned height, const Scene_Description & given_description, Asset_Cache * cache)
     :
+        description (given_description),
         width       (width ),
         height      (height),
         color_buffer(width, height),
         rasterizer  (color_buffer )
     {
         //Inicializamos la matriz de proyección
-        projection = perspective(20, 1, 15, float(width) / height);
+        projection  = projection_for(width, height);
+        frustum     = Frustum::from_projection(projection);
+        depth_range = Depth_Range::from_projection(projection);
+
+        screen_transformation = screen_transformation_for(width, height);
+
+        updated_width  = rendered_width  = width;
+        updated_height = rendered_height = height;
+
+        //Luces de la escena
+        for (const Light & light : description.lights)
+        {
+            add_light(light);
+        }
+
+        //Creacion de modelos, cada uno en un hilo. Model guarda el puntero a la ruta, que es la de la copia de la descripción.
+        total_models.resize(description.models.size(), nullptr);
+
+        parallel_for(description.models.size(), [&] (size_t index)
+        {
+            const Model_Description & model = description.models[index];
+
+            Model * instance = cache
+                ? cache->instantiate(model, this)
+                : new Model(const_cast< char * >(model.path.c_str()), this, model.red, model.green, model.blue, model.scale, model.x, model.y, model.z, model.rotation_x, model.rotation_y, model.active);
+
+            //Si la caché no puede cargar el modelo se deja uno vacío para que los índices sigan coincidiendo con la descripción
+            if (!instance)
+            {
+                instance = new Model(const_cast< char * >(model.path.c_str()), this, model.red, model.green, model.blue, model.scale, model.x, model.y, model.z, model.rotation_x, model.rotation_y, model.active);
+            }
+
+            instance->light_channels = model.light_channels;
+            instance->scene_index    = unsigned(index);
+            instance->animation_clip = model.animation;
+            instance->animation_time = model.animation_time;
+
+            total_models[index] = instance;
+        });
+
+        // El índice del modelo y el del triángulo tienen que caber en los píxeles del buffer de visibilidad. Si no caben,
+        // esta escena se pinta sin él en lugar de leer después modelos que no existen:
+
+        visibility_buffer = use_visibility_buffer;
+
+        if (visibility_buffer && total_models.size() > visibility_model_limit)
+        {
+            std::cerr << "La escena tiene " << total_models.size() << " modelos y el buffer de visibilidad admite " << visibility_model_limit << ": se pinta sin él" << std::endl;
+
+            visibility_buffer = false;
+        }
 
-        //Creacion de modelos
-        //char* path, View* given_view, float a, float g, float b, float given_scale, float x, float y, float z, float angle_rotation_x, float angle_rotation_y
-        //Arbol
-        total_models[0] = new Model("../../shared/assets/Lowpoly_tree_sample.obj", this, 250.f, 150.f, 0.f, 0.1f, 3.f, 2.f, -15.f, 0.f, 0.f, true);
+        for (size_t index = 0; visibility_buffer && index < total_models.size(); ++index)
+        {
+            if (!fits_visibility_buffer(*total_models[index]))
+            {
+                std::cerr << "El modelo " << description.models[index].path << " tiene demasiados triángulos para el buffer de visibilidad: la escena se pinta sin él" << std::endl;
 
-        //Conejo
-        total_models[1] = new Model("../../shared/assets/stanford-bunny.obj", this, 15.f, 0.f, 0.f, 1.f, 0.f, 1.f, -10.f, 0.f, 0.f, true);
+                visibility_buffer = false;
+            }
+        }
 
-        //Arboles
-        total_models[2] = new Model("../../shared/assets/Lowpoly_tree_sample.obj", this, 250.f, 150.f, 0.f, 0.1f, -2.5f, 1.f, -5.f, 0.f, 0.f, true);
-        total_models[3] = new Model("../../shared/assets/Lowpoly_tree_sample.obj", this, 250.f, 150.f, 0.f, 0.075f, -1.f, 0.f, -10.f, 0.f, 0.f, true);
-        total_models[4] = new Model("../../shared/assets/Lowpoly_tree_sample.obj", this, 250.f, 150.f, 0.f, 0.05f, 10.f, 0.f, -10.f, 0.f, 0.f, true);
+        if (visibility_buffer)
+        {
+            rasterizer.enable_visibility_buffer();
+        }
 
-        //Montañas
-        total_models[5] = new Model("../../shared/assets/mountain.obj", this, 125.f, 150.f, 0.f, 50.f, -10.f, 0.f, -30.f, 0.f, 270.f, true);
-        total_models[6] = new Model("../../shared/assets/mountain.obj", this, 125.f, 150.f, 0.f, 60.f, 10.f, 0.f, -30.f, 0.f, 270.f, true);
-        total_models[7] = new Model("../../shared/assets/mountain.obj", this, 125.f, 150.f, 0.f, 60.f, 0.f, 0.f, -25.f, 0.f, 180.f, true);
-        total_models[8] = new Model("../../shared/assets/mountain.obj", this, 125.f, 150.f, 0.f, 60.f, 25.f, 0.f, -40.f, 0.f, 270.f, true);
-        total_models[9] = new Model("../../shared/assets/mountain.obj", this, 125.f, 150.f, 0.f, 60.f, -25.f, 0.f, -40.f, 0.f, 270.f, true);
+        framebuffer_bytes = color_buffer.bytes() + rasterizer.bytes();
 
-        //Sol
-        total_models[10] = new Model("../../shared/assets/Sun.obj", this, 141.f, 151.f, 0.f, 0.2f, 10.f, -3.f, -40.f, 0.f, 0.f, true);
+        Memory_Tracker::instance().add(Memory_Tracker::FRAMEBUFFERS, framebuffer_bytes);
 
-        //Fondo
-        total_models[11] = new Model("../../shared/assets/floor.obj", this, 205.f, 100.f, 50.f, 0.01f, 1.f, 0.f, -100.f, 0.f, 0.f, true);
+        build_scene_bvh();
+    }
 
+    ///Destructor que libera los modelos
+    View::~View()
+    {
+        Memory_Tracker::instance().remove(Memory_Tracker::FRAMEBUFFERS, framebuffer_bytes);
 
+        for (Model * model : total_models)
+        {
+            delete model;
+        }
     }
 
-    ///Función que ejecuta el update de todos los objetos
+    ///Función que devuelve la proyección de la escena para una imagen de las medidas dadas
+    Matrix44 View::projection_for (unsigned width, unsigned height)
+    {
+        return perspective(20, 1, 15, float(width) / height);
+    }
+
+    ///Función que devuelve la matriz que lleva las x e y ya divididas por w a los píxeles de una imagen de las medidas dadas
+    Matrix44 View::screen_transformation_for (unsigned width, unsigned height)
+    {
+        Matrix44 identity(1);
+
+        return translate(identity, Vector3f{ float(width / 2), float(height / 2), 0.f }) * scale(identity, float(width / 2), float(height / 2), 1.f);
+    }
+
+    ///Función que pide pintar a una fracción de la resolución de la pantalla. Se aplica en el siguiente swap_frames.
+    void View::set_render_scale (float given_scale)
+    {
+        render_scale = std::min(std::max(given_scale, 0.f), 1.f);
+    }
+
+    ///Función que ejecuta el update de todos los objetos con la posición actual de la cámara
     void View::update ()
     {
-        //Hacemos el update de todos los elementos. Le pasamos el vector de luz, y si le afecta o no esta. 
-        total_models[0]->Update(light_vector_tree, true);
-        total_models[1]->Update(light_vector, true);
-        total_models[2]->Update(light_vector_tree, true);
-        total_models[3]->Update(light_vector_tree, true);
-        total_models[4]->Update(light_vector_tree, true);
-        total_models[5]->Update(light_vector, true);
-        total_models[6]->Update(light_vector, true);
-        total_models[7]->Update(light_vector, true);
-        total_models[8]->Update(light_vector, true);
-        total_models[9]->Update(light_vector, true);
-        total_models[10]->Update(light_vector, false);
-        total_models[11]->Update(light_vector, false);
-
-        //El vector de luz cambiará mediante el movimiento del sol
-        light_vector = { light_vector.x + cos((angle * PI) / 180) , light_vector.y, light_vector.z + sin(((angle * PI) / 180)), 0 };
-        light_vector_tree = { light_vector_tree.x + cos((angle * PI) / 180) , light_vector_tree.y, light_vector_tree.z + sin(((angle * PI) / 180)), 0 };
+        update (camera->transformation);
+    }
+
+    ///Función que ejecuta el update de todos los objetos con la transformación de cámara dada
+    void View::update (const Matrix44 & given_camera_transformation)
+    {
+        ENGINE_STATS_SCOPE("update", -1);
+
+        camera_transformation = given_camera_transformation;
+
+        //Las animaciones se avanzan antes de buscar los modelos visibles, ya que cambian sus cajas
+        animate(frame_time);
+
+        //Se buscan en la BVH de la escena los modelos que pueden verse. El resto no se transforma ni se ilumina.
+        visible_models.clear();
+
+        query_frustum(camera_transformation, visible_models);
+
+        vector< bool > visible(total_models.size(), false);
+
+        for (int i : visible_models) visible[i] = true;
+
+        //Hacemos el update de todos los elementos en paralelo. Cada modelo elige las luces que le afectan, y los que no tienen canales de luz no se iluminan.
+        parallel_for(total_models.size(), [&] (size_t index)
+        {
+            int i = int(index);
+
+            ENGINE_STATS_SCOPE("model.update", i);
+
+            if (!visible[i])
+            {
+                total_models[i]->Skip_Update();
+                return;
+            }
+
+            total_models[i]->Select_Lights(lights);
+            total_models[i]->Update(lights, total_models[i]->light_channels != 0);
+        });
+
+        //El resolve del buffer de visibilidad necesita las luces tal y como estaban en este update
+        if (visibility_buffer)
+        {
+            updated_lights = lights;
+        }
+
+        //Solo la escena de la demo se mueve
+        if (!description.animated) return;
+
+        //Los vectores de las luces direccionales cambiarán mediante el movimiento del sol
+        for (Light & light : lights)
+        {
+            if (light.type == Light::DIRECTIONAL)
+            {
+                light.vector = { light.vector.x + cos((angle * PI) / 180) , light.vector.y, light.vector.z + sin(((angle * PI) / 180)), 0 };
+            }
+        }
 
         //Updateamos la posición del sol, para que vaya orbitando alrededor de la montaña
         total_models[10]->translation = translate(total_models[10]->translation, { cos(((angle * PI) / 180)), 0, sin(((angle*PI)/180)) });
@@ -87,31 +216,274 @@ namespace Engine
         //Vamos bajando el angle
         angle -= 45;
 
+        //La BVH se ajusta a la nueva posición del sol para el próximo update
+        refit_scene_bvh();
+
+    }
+
+    ///Función que avanza las animaciones de los modelos con huesos, repartiendo los modelos entre los núcleos, y
+    ///ajusta la BVH a sus nuevas cajas
+    void View::animate (float seconds)
+    {
+        vector< Model * > skinned_models;
+
+        for (Model * model : total_models)
+        {
+            if (model->skeleton) skinned_models.push_back(model);
+        }
+
+        if (skinned_models.empty()) return;
+
+        ENGINE_STATS_SCOPE("skinning", -1);
+
+        parallel_for(skinned_models.size(), [&] (size_t index)
+        {
+            ENGINE_STATS_SCOPE("model.skinning", int(skinned_models[index]->scene_index));
+
+            skinned_models[index]->Animate(seconds);
+        });
+
+        refit_scene_bvh();
+    }
+
+    ///Función que indica si los triángulos de un modelo caben en los identificadores del buffer de visibilidad
+    bool View::fits_visibility_buffer (const Model & model)
+    {
+        return model.original_indices.size() / 3 <= visibility_triangle_mask;
+    }
+
+    ///Función que cambia un modelo por otro cargado del mismo archivo, que ocupa su lugar en la escena y se pone
+    ///al día con el último update. Devuelve el modelo sustituido. Solo se puede llamar entre dos frames.
+    Model * View::replace_model (int index, Model * replacement)
+    {
+        Model * replaced = total_models[index];
+
+        replacement->Take_Placement (*replaced);
+
+        //La pose se calcula en el instante en el que iba la animación del modelo sustituido
+        replacement->Animate (0.f);
+
+        total_models[index] = replacement;
+
+        //La caja del archivo nuevo puede ser distinta, pero solo cambia su hoja de la BVH
+        Aabb bounds = replacement->world_bounds ();
+
+        scene_bvh.refit (index, bounds);
+
+        // El update de este frame ya terminó, así que el modelo nuevo se transforma aquí con la misma cámara para
+        // que el render no lo pinte vacío:
+
+        if (frustum.transformed (inverse (camera_transformation)).intersects_box (bounds.min_corner, bounds.max_corner))
+        {
+            replacement->Select_Lights (lights);
+            replacement->Update (lights, replacement->light_channels != 0);
+        }
+        else
+        {
+            replacement->Skip_Update ();
+        }
+
+        return replaced;
+    }
+
+    ///Función que pasa el último update al render en todos los objetos
+    void View::swap_frames ()
+    {
+        for (int i = 0, number_of_models = int(total_models.size()); i < number_of_models; ++i)
+        {
+            total_models[i]->Swap_Frame();
+        }
+
+        updated_lights.swap(rendered_lights);
+
+        // El frame que pasa al render se pinta a la resolución con la que se transformó, y el update siguiente se
+        // hace ya a la escala pedida. La proyección no cambia, así que se ve lo mismo con menos píxeles:
+
+        rendered_width  = updated_width;
+        rendered_height = updated_height;
+
+        updated_width  = std::max(2u, unsigned(float(width ) * render_scale + .5f));
+        updated_height = std::max(2u, unsigned(float(height) * render_scale + .5f));
+
+        if (updated_width != rendered_width || updated_height != rendered_height)
+        {
+            screen_transformation = screen_transformation_for(updated_width, updated_height);
+        }
+    }
+
+    ///Función que añade una luz a la escena y devuelve su índice
+    int View::add_light(const Light & light)
+    {
+        lights.push_back(light);
+
+        return int(lights.size()) - 1;
+    }
+
+    ///Función que construye la BVH de la escena con las cajas actuales de los modelos
+    void View::build_scene_bvh ()
+    {
+        vector< Aabb > bounds(total_models.size());
+
+        for (int i = 0, number_of_models = int(total_models.size()); i < number_of_models; ++i)
+        {
+            bounds[i] = total_models[i]->world_bounds();
+        }
+
+        scene_bvh.build(bounds, 1);
+    }
+
+    ///Función que ajusta la BVH de la escena a los modelos que se han movido desde la última vez
+    void View::refit_scene_bvh ()
+    {
+        for (int i = 0, number_of_models = int(total_models.size()); i < number_of_models; ++i)
+        {
+            Aabb bounds = total_models[i]->world_bounds();
+
+            if (!(bounds == scene_bvh.get_primitive_bounds(i)))
+            {
+                scene_bvh.refit(i, bounds);
+            }
+        }
+    }
+
+    ///Función que añade los modelos cuya caja toca el volumen de visión de la cámara dada
+    void View::query_frustum (const Matrix44 & given_camera_transformation, vector< int > & models) const
+    {
+        //El volumen de visión está en espacio de cámara, y se pasa al del mundo con la matriz de vista
+        scene_bvh.query_frustum(frustum.transformed(inverse(given_camera_transformation)), models);
+    }
+
+    ///Función que busca el triángulo más cercano de la escena que corta un rayo en coordenadas del mundo
+    bool View::ray_cast (const Ray & ray, Ray_Hit & hit) const
+    {
+        hit = Ray_Hit();
+
+        scene_bvh.ray_cast(ray, std::numeric_limits< float >::max(), [&] (int model, float & closest)
+        {
+            float distance;
+            int   triangle;
+
+            if (total_models[model]->Ray_Cast(ray, closest, distance, triangle))
+            {
+                closest      = distance;
+                hit.model    = model;
+                hit.triangle = triangle;
+                hit.distance = distance;
+            }
+        });
+
+        return hit.model >= 0;
     }
 
     void View::Scale(bool _isActive)
     {
         //total_models[11]->translation = translate(total_models[11]->translation, { 205.f, 100.f, 50.f });
-        total_models[11]->isActive = _isActive;
+        if (description.animated) total_models[11]->isActive = _isActive;
     }
 
-    ///Función que llama al render y post render de todos los objetos
+    ///Función que activa el fondo solo en las posiciones de cámara en las que no se sale de la pantalla
+    void View::update_background(float cx, float cy, float cz)
+    {
+        //Esto es debido a que se deformaba, y solia salirse de la escena. Al no estar implementado el algorimto de recorte se peta la aplicación.
+        if (((cx >= 9.f && cx <= 11.f) && (cy >= -0.5 && cy <= 0.5)))
+            Scale(true);
+        else
+        {
+            if(cz>=20)
+                Scale(true);
+            else
+                Scale(false);
+        }
+    }
+
+    ///Función que llama al render de todos los objetos
     void View::render()
     {
-        //Se recorre un bucle que realiza el Post_Render de cada elemento
-        for (int i = 0; i < 12; ++i)
+        ENGINE_STATS_SCOPE("render", -1);
+
+        //La grabación de los comandos de dibujo de cada elemento solo toca sus propios buffers, así que se hace en paralelo
+        render_queue.begin(total_models.size());
+        render_queue.order = draw_front_to_back ? Render_Queue::FRONT_TO_BACK : Render_Queue::SUBMISSION_ORDER;
+
+        parallel_for(total_models.size(), [&] (size_t index)
+        {
+            ENGINE_STATS_SCOPE("model.render", int(index));
+
+            total_models[index]->Render(total_models[index]->isActive, render_queue);
+        });
+
+        //Con resolución dinámica los buffers toman las medidas del frame, que caben siempre en lo ya reservado
+        if (color_buffer.get_width() != rendered_width || color_buffer.get_height() != rendered_height)
         {
-            total_models[i]->Post_Render(width, height);
+            color_buffer.resize(rendered_width, rendered_height);
+            rasterizer.resize();
         }
 
-        // Se borra el framebúffer y se dibujan los triángulos:
+        // Se borra el framebúffer y se ejecutan los comandos. Esto sigue en un solo hilo porque todos comparten el z-buffer:
         rasterizer.clear();
 
-        //Se recorre un bucle que realiza el render de cada elemento.
-        for (int i = 0; i < 12; ++i)
         {
-            total_models[i]->Render(total_models[i]->isActive);
+            ENGINE_STATS_SCOPE("draw", -1);
+
+            render_queue.execute(rasterizer, visibility_buffer);
+        }
+
+        if (visibility_buffer)
+        {
+            resolve_visibility();
         }
+
+        if (!headless)
+        {
+            color_buffer.blit_to_window(float(width) / float(rendered_width), float(height) / float(rendered_height));
+        }
+    }
+
+    ///Función que sombrea en paralelo los píxeles del buffer de visibilidad y los escribe en el framebúffer
+    void View::resolve_visibility ()
+    {
+        ENGINE_STATS_SCOPE("resolve", -1);
+
+        typedef Rasterizer< Color_Buffer > Target;
+
+        const uint32_t * ids    = rasterizer.get_id_buffer();
+        Color          * pixels = color_buffer.colors();
+
+        //La pantalla se reparte en bandas de filas. Los píxeles vecinos suelen ser del mismo triángulo, por lo que
+        //se guarda el último color calculado y solo se vuelve a sombrear cuando cambia el identificador
+        const unsigned rows_per_band = 16;
+
+        size_t bands = (rendered_height + rows_per_band - 1) / rows_per_band;
+
+        parallel_for(bands, [&] (size_t band)
+        {
+            size_t begin = band * rows_per_band * rendered_width;
+            size_t end   = std::min< size_t >(begin + size_t(rows_per_band) * rendered_width, size_t(rendered_width) * rendered_height);
+
+            uint32_t last_id    = Target::empty_id;
+            Color    last_color;
+
+            ENGINE_STATS_LOCAL(uint64_t pixels_resolved = 0;)
+
+            for (size_t offset = begin; offset < end; ++offset)
+            {
+                uint32_t id = ids[offset];
+
+                if (id == Target::empty_id) continue;
+
+                if (id != last_id)
+                {
+                    last_id    = id;
+                    last_color = total_models[id >> visibility_triangle_bits]->Shade_Triangle(int(id & visibility_triangle_mask), rendered_lights);
+                }
+
+                pixels[offset] = last_color;
+
+                ENGINE_STATS_LOCAL(pixels_resolved++;)
+            }
+
+            ENGINE_STATS_ADD(pixels_resolved, pixels_resolved);
+        });
     }
 
 }
@@ -13,69 +13,183 @@
 #ifndef VIEW_HEADER
 #define VIEW_HEADER
 
-#include <Color_Buffer.hpp>
+#include "Packed_Color_Buffer.hpp"
 #include <cstdlib>
 #include "math.hpp"
 #include "Rasterizer.hpp"
+#include "Render_Queue.hpp"
 #include <vector>
 #include "Convert_Function.hpp"
 #include "Model.h"
 #include "Camera.hpp"
+#include "Light.hpp"
+#include "Frustum.hpp"
+#include "Bvh.hpp"
+#include "Scene_Description.hpp"
 
 namespace Engine
 {
     //Declaraciones adelantadas
     using  std::vector;
-    using argb::Rgb888;
-    using argb::Color_Buffer;
 
     class Model;
+    class Asset_Cache;
 
     class View
     {
     private:
 
-        typedef Rgb888                Color;
-        typedef Color_Buffer< Color > Color_Buffer;
+        typedef Packed_Color          Color;
+        typedef Packed_Color_Buffer   Color_Buffer;
         typedef Point4f               Vertex;
 
     public:
         Matrix44 projection;
 
+        ///Planos del volumen de visión, en espacio de cámara, para descartar modelos y meshlets
+        Frustum frustum;
+
+        ///Planos near y far de la proyección, con los que se codifica la profundidad en el z-buffer
+        Depth_Range depth_range;
+
+        ///Lleva las x e y ya divididas por w a píxeles. La usa el update de cada modelo al transformar sus vértices.
+        Matrix44 screen_transformation;
+
         Color_Buffer               color_buffer;
         Rasterizer< Color_Buffer > rasterizer;
 
-        ///Array que recoge los modelos que aparecen en la escena
-        Model * total_models[12];
+        ///Comandos de dibujo que graban los modelos en cada render y que después se ejecutan sobre el rasterizer
+        Render_Queue render_queue;
+
+        ///Descripción de la que se ha creado la escena y modelos que aparecen en ella, en el mismo orden. La escena es su dueña.
+        Scene_Description description;
+        vector< Model * > total_models;
+
+        ///BVH de la escena sobre las cajas de los modelos en coordenadas del mundo, y modelos que tocó el volumen
+        ///de visión en el último update
+        Bvh scene_bvh;
+        vector< int > visible_models;
+
+        ///Resultado de lanzar un rayo contra la escena
+        struct Ray_Hit
+        {
+            int   model    = -1;
+            int   triangle = -1;
+            float distance = 0.f;
+        };
 
         //Medidas de la pantalla
         unsigned width;
         unsigned height;
 
+        ///Resolución interna con la que se transforma el update en curso y con la que se pinta el frame actual. Con
+        ///resolución dinámica son menores que la pantalla y la imagen se amplía al copiarla a la ventana. Los buffers
+        ///se reservan a la resolución de la pantalla y solo cambian de medidas, sin volver a reservarse.
+        unsigned updated_width;
+        unsigned updated_height;
+        unsigned rendered_width;
+        unsigned rendered_height;
+
+        ///Fracción de la pantalla, en cada eje, a la que se harán los siguientes updates
+        float render_scale = 1.f;
+
         //Referencia a la camara
         Camera * camera;
 
-        ///Vectores de luz
-        Vector4f light_vector {80, 70, -30, 0};
-        Vector4f light_vector_tree{ 5, 50, -20, 0};
+        //Copia de la transformación de la cámara con la que se hace el update en curso
+        Matrix44 camera_transformation;
+
+        ///Luces de la escena. Cada modelo elige en el update las que le afectan
+        vector< Light > lights;
 
         //Angulo con el que gira el sol
         float angle = 0;
 
+        ///Segundos que avanzan las animaciones de los modelos con huesos en cada update
+        float frame_time = 1.f / 60.f;
+
         //Constante de PI
         const float PI = 3'1416;
 
         bool reduceBg = false;
 
+        //Si es true no se copia el framebúffer a la ventana (pruebas y render sin ventana)
+        bool headless = false;
+
+        ///Si es true el render solo guarda la profundidad y el triángulo visible de cada píxel, y después un resolve
+        ///en paralelo sombrea únicamente los píxeles que se ven. Debe fijarse antes de crear la escena.
+        static bool use_visibility_buffer;
+
+        ///Si es true los comandos de dibujo se pintan de delante hacia atrás en lugar de en el orden de los modelos,
+        ///para que el test de profundidad descarte antes los píxeles tapados
+        static bool draw_front_to_back;
+
+        ///Cada píxel del buffer de visibilidad guarda el índice del modelo en los bits altos y el del triángulo en los bajos
+        static constexpr int      visibility_triangle_bits = 24;
+        static constexpr uint32_t visibility_triangle_mask = (1u << visibility_triangle_bits) - 1;
+        static constexpr size_t   visibility_model_limit   = size_t(1) << (32 - visibility_triangle_bits);
+
+        ///Si esta escena se pinta con buffer de visibilidad. Se decide al crearla: aunque use_visibility_buffer esté
+        ///activo, la escena se pinta sin él si sus modelos o sus triángulos no caben en los identificadores.
+        bool visibility_buffer = false;
+
+        ///Luces con las que se hizo el último update y las del frame que se está pintando, para el resolve
+        vector< Light > updated_lights;
+        vector< Light > rendered_lights;
+
+        ///Bytes de los buffers de color, profundidad y visibilidad apuntados en el Memory_Tracker
+        size_t framebuffer_bytes = 0;
+
     public:
-        ///Constructor por defecto
+        ///Constructor por defecto: crea la escena de la demo
         View(unsigned, unsigned);
-        ///Función que ejecuta el update de todos los objetos
+        ///Constructor que crea la escena descrita. Con una caché los modelos ya cargados no se vuelven a leer.
+        View(unsigned, unsigned, const Scene_Description &, Asset_Cache * = nullptr);
+        ///Destructor que libera los modelos
+        ~View();
+
+        View(const View &) = delete;
+        View & operator = (const View &) = delete;
+
+        ///Función que devuelve la proyección de la escena para una imagen de las medidas dadas
+        static Matrix44 projection_for (unsigned, unsigned);
+        ///Función que devuelve la matriz que lleva las x e y ya divididas por w a los píxeles de una imagen de las medidas dadas
+        static Matrix44 screen_transformation_for (unsigned, unsigned);
+        ///Función que pide pintar a una fracción de la resolución de la pantalla. Se aplica en el siguiente swap_frames.
+        void set_render_scale (float);
+        ///Función que ejecuta el update de todos los objetos con la posición actual de la cámara
         void update ();
+        ///Función que ejecuta el update de todos los objetos con la transformación de cámara dada
+        void update (const Matrix44 &);
+        ///Función que avanza las animaciones de los modelos con huesos, repartiendo los modelos entre los núcleos, y
+        ///ajusta la BVH a sus nuevas cajas
+        void animate (float);
+        ///Función que cambia un modelo por otro cargado del mismo archivo, que ocupa su lugar en la escena y se pone
+        ///al día con el último update. Devuelve el modelo sustituido. Solo se puede llamar entre dos frames.
+        Model * replace_model (int, Model *);
+        ///Función que indica si los triángulos de un modelo caben en los identificadores del buffer de visibilidad
+        static bool fits_visibility_buffer (const Model &);
+        ///Función que pasa el último update al render en todos los objetos
+        void swap_frames ();
         ///Función que llama al render y post render de todos los objetos
         void render ();
+        ///Función que sombrea en paralelo los píxeles del buffer de visibilidad y los escribe en el framebúffer
+        void resolve_visibility ();
+        ///Función que añade una luz a la escena y devuelve su índice
+        int add_light (const Light &);
+        ///Función que construye la BVH de la escena con las cajas actuales de los modelos
+        void build_scene_bvh ();
+        ///Función que ajusta la BVH de la escena a los modelos que se han movido desde la última vez
+        void refit_scene_bvh ();
+        ///Función que añade los modelos cuya caja toca el volumen de visión de la cámara dada
+        void query_frustum (const Matrix44 &, vector< int > &) const;
+        ///Función que busca el triángulo más cercano de la escena que corta un rayo en coordenadas del mundo.
+        ///No debe llamarse mientras se ejecuta el update, que mueve los modelos.
+        bool ray_cast (const Ray &, Ray_Hit &) const;
 
         void Scale(bool);
+        ///Función que activa el fondo solo en las posiciones de cámara en las que no se sale de la pantalla
+        void update_background(float, float, float);
     };
 
 }
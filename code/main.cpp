@@ -11,13 +11,150 @@
 
 
 #include "View.hpp"
+#include "Frame_Pipeline.hpp"
+#include "Stats.hpp"
+#include "Golden_Check.hpp"
+#include "Convert_Function.hpp"
+#include "Asset_Pack.hpp"
+#include "Parallel.hpp"
+#include "Render_Server.hpp"
+#include "Hot_Reload.hpp"
+#include "Memory_Tracker.hpp"
+#include "Resolution_Controller.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
 #include <SFML/Window.hpp>
 
 using namespace sf;
 using namespace Engine;
 
-int main ()
+int main (int argc, char * argv[])
 {
+    //Los modificadores van al final de cualquier línea de comandos: con --compact-vertices los modelos guardan sus
+    //vértices comprimidos, con --visibility-buffer la escena se pinta con buffer de visibilidad y resolve, y con
+    //--front-to-back los comandos de dibujo se ordenan de delante hacia atrás. Con --asset-pack <paquete> los modelos de
+    //la carpeta del paquete se leen de él en lugar de sus archivos, y se puede repetir para montar varios paquetes.
+    //Con --hot-reload los modelos de la ventana se vuelven a cargar en cuanto cambian sus archivos, y con
+    //--memory-budget <categoría> <MB> se limita la memoria de una categoría del Memory_Tracker (geometry, instances...).
+    //Con --dynamic-resolution <ms> la ventana baja la resolución interna cuando el render tarda más de esos milisegundos
+    bool  hot_reload_enabled         = false;
+    float render_target_milliseconds = 0.f;
+
+    for ( ; argc > 1; argc--)
+    {
+        if (argc > 3 && std::strcmp (argv[argc - 3], "--memory-budget") == 0)
+        {
+            Memory_Tracker::Category category;
+
+            if (!Memory_Tracker::category_from (argv[argc - 2], category) || std::atof (argv[argc - 1]) <= 0.0)
+            {
+                std::cerr << "Límite de memoria no válido: " << argv[argc - 2] << ' ' << argv[argc - 1] << std::endl;
+                return 1;
+            }
+
+            Memory_Tracker::instance ().set_budget (category, size_t(std::atof (argv[argc - 1]) * 1024. * 1024.));
+
+            argc -= 2;
+        }
+        else
+        if (argc > 2 && std::strcmp (argv[argc - 2], "--dynamic-resolution") == 0)
+        {
+            render_target_milliseconds = float(std::atof (argv[argc - 1]));
+
+            if (render_target_milliseconds <= 0.f)
+            {
+                std::cerr << "Tiempo de render no válido: " << argv[argc - 1] << std::endl;
+                return 1;
+            }
+
+            argc--;
+        }
+        else
+        if (argc > 2 && std::strcmp (argv[argc - 2], "--asset-pack") == 0)
+        {
+            if (!Asset_Pack::mount (argv[argc - 1]))
+            {
+                std::cerr << "No se puede abrir el paquete " << argv[argc - 1] << std::endl;
+                return 1;
+            }
+
+            argc--;
+        }
+        else
+        if (std::strcmp (argv[argc - 1], "--compact-vertices") == 0)
+        {
+            Model::use_compact_vertices = true;
+        }
+        else
+        if (std::strcmp (argv[argc - 1], "--visibility-buffer") == 0)
+        {
+            View::use_visibility_buffer = true;
+        }
+        else
+        if (std::strcmp (argv[argc - 1], "--front-to-back") == 0)
+        {
+            View::draw_front_to_back = true;
+        }
+        else
+        if (std::strcmp (argv[argc - 1], "--hot-reload") == 0)
+        {
+            hot_reload_enabled = true;
+        }
+        else
+            break;
+    }
+
+    //Con --convert <carpeta o manifiesto> <carpeta de salida> se convierten los modelos a .mesh sin abrir ventana
+    if (argc == 4 && std::strcmp (argv[1], "--convert") == 0)
+    {
+        return run_batch_conversion (argv[2], argv[3]) == 0 ? 0 : 1;
+    }
+
+    //Con --pack <carpeta o manifiesto> <paquete> se preparan los modelos y se guardan comprimidos en un paquete de assets
+    if (argc == 4 && std::strcmp (argv[1], "--pack") == 0)
+    {
+        return build_asset_pack (argv[2], argv[3]) == 0 ? 0 : 1;
+    }
+
+    //Con --golden <carpeta> se comprueba la escena contra las imágenes de referencia sin abrir ventana,
+    //y con --golden-record <carpeta> se vuelven a generar las referencias
+    if (argc == 3 && (std::strcmp (argv[1], "--golden") == 0 || std::strcmp (argv[1], "--golden-record") == 0))
+    {
+        Golden_Settings settings;
+
+        settings.directory = argv[2];
+        settings.record    = std::strcmp (argv[1], "--golden-record") == 0;
+
+        return run_golden_check (settings);
+    }
+
+    //Con --serve [socket|-] [trabajos] se atienden trabajos de render sin ventana, por un socket Unix o (con - o sin
+    //socket) por la entrada estándar. Por defecto se pintan a la vez tantos trabajos como la mitad de los hilos
+    if (argc >= 2 && argc <= 4 && std::strcmp (argv[1], "--serve") == 0)
+    {
+        unsigned jobs = argc == 4 ? unsigned(std::atoi (argv[3])) : std::max (1u, worker_count () / 2);
+
+        Render_Server server(jobs);
+
+        if (argc >= 3 && std::strcmp (argv[2], "-") != 0)
+        {
+            if (!server.serve_socket (argv[2]))
+            {
+                std::cerr << "No se puede abrir el socket " << argv[2] << std::endl;
+                return 1;
+            }
+
+            std::cout << server.metrics () << std::endl;
+        }
+        else
+            server.serve_stream (std::cin, std::cout);
+
+        return 0;
+    }
+
     //Medidas de la ventana
 
     constexpr auto window_width  = 800u;
@@ -40,6 +177,19 @@ int main ()
 
     window.setVerticalSyncEnabled (true);
 
+    //Los archivos de la escena se vigilan desde otro hilo, y los modelos que cambian se sustituyen entre dos frames
+    std::unique_ptr< Hot_Reload > hot_reload;
+
+    if (hot_reload_enabled) hot_reload.reset (new Hot_Reload(view));
+
+    //La resolución interna se ajusta en cada frame para no pasarse del tiempo de render pedido
+    std::unique_ptr< Resolution_Controller > resolution;
+
+    if (render_target_milliseconds > 0.f) resolution.reset (new Resolution_Controller(render_target_milliseconds));
+
+    //El update del frame siguiente se hace en otro hilo mientras se pinta el actual
+    Frame_Pipeline pipeline(view, hot_reload.get (), resolution.get ());
+
     //El bucle del juego
 
     bool exit = false;
@@ -136,6 +286,18 @@ int main ()
                 case Keyboard::I:
                     cy += 2;
 
+                    break;
+                    //Si se pulsa la P, se muestran las estadísticas del último frame
+                case Keyboard::P:
+
+                    Stats::instance().print(std::cout);
+
+                    break;
+                    //Si se pulsa la T, se exportan los últimos frames como traza de Chrome
+                case Keyboard::T:
+
+                    Stats::instance().write_chrome_trace("frame_trace.json");
+
                     break;
                 }
 
@@ -145,23 +307,12 @@ int main ()
         }
 
         //Para la visibilidad del fondo, solo se renderizara, si esta en cierta perspectiva, o si la camara esta alejado. 
-        //Esto es debido a que se deformaba, y solia salirse de la escena. Al no estar implementado el algorimto de recorte se peta la aplicación.
-        if (((cx >= 9.f && cx <= 11.f) && (cy >= -0.5 && cy <= 0.5)))
-            view.Scale(true);
-        else
-        {
-            if(cz>=20)
-                view.Scale(true);
-            else
-                view.Scale(false);
-        }
-
+        view.update_background(cx, cy, cz);
 
-        //Se llama al update de la escena
-        view.update();
 
-        //Se llama al render de la escena
-        view.render ();
+        //Se llama al render de la escena mientras se hace el update del frame siguiente. Los frames de estadísticas
+        //los cierra el propio pipeline.
+        pipeline.run_frame ();
         //Se pinta por pantalla
         window.display ();
     }